@@ -17,6 +17,8 @@ const float maxY = 1.25;
 // X scaled to [-2.5, 1.0]
 const float minX = -2.5;
 const float maxX = 1.0;
+// Periodicity tolerance relative to the pixel width
+const float periodScale = 0.0009765625;
 
 void main() {
 
@@ -25,17 +27,39 @@ void main() {
       mix(minX, maxX, fragTexCoord.x),
       mix(minY, maxY, fragTexCoord.y)
     );
+  // Periodicity tolerance, a fraction of the pixel width
+  // NOTE: Derivatives must be computed outside of non-uniform control flow
+  float periodTolerance = fwidth(c.x) * periodScale;
+
+  // Main cardioid and period-2 bulb never escape
+  float x = c.x - 0.25;
+  float y2 = c.y * c.y;
+  float q = x * x + y2;
+  bool interior = q * (q + x) <= 0.25 * y2 ||
+                  (c.x + 1.0) * (c.x + 1.0) + y2 <= 0.0625;
+
   vec2 z = vec2(0.0);
   vec2 z2 = vec2(0.0);
+  // Orbit value compared against, saved at iterations 1, 2, 4, 8, ...
+  vec2 saved = vec2(0.0);
+  int nextSave = 1;
 
   // Optimized escape algorithm
   int iter = 0;
-  while (z2.x + z2.y <= escapeVal && iter < maxIter) {
+  while (!interior && z2.x + z2.y <= escapeVal && iter < maxIter) {
     z2.x = z.x * z.x;
     z2.y = z.y * z.y;
     z.y = 2.0 * z.x * z.y + c.y;
     z.x = z2.x - z2.y + c.x;
     iter++;
+
+    // Orbit returned to a saved value, it is periodic and never escapes
+    vec2 d = abs(z - saved);
+    interior = d.x < periodTolerance && d.y < periodTolerance;
+    if (iter == nextSave) {
+      saved = z;
+      nextSave *= 2;
+    }
   }
 
   // Linear interpolation
@@ -43,7 +67,7 @@ void main() {
   float nu = log(logZn / log(2.0)) / log(2.0);
   float smoothIter = float(iter) + 1.0 - nu;
   float t = smoothIter / float(maxIter);
-  t = clamp(t, 0.0, 1.0);
+  t = interior ? 1.0 : clamp(t, 0.0, 1.0);
 
   vec3 color = texture(uColorPalette, vec2(t, 0.5)).rgb;
   fragColor = vec4(color, 1.0);
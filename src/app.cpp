@@ -1,13 +1,34 @@
 #include "app.hpp"
 
+#include <cmath>
+#include <cstddef>
 #include <string_view>
+#include <utility>
 
 #include "raylib-cpp.hpp"
 
 #include "RenderTexture.hpp"
 #include "Window.hpp"
 #include "config.hpp"
+#include "engine.hpp"
 #include "mandelbrot_error.hpp"
+#include "render_thread.hpp"
+#include "tile_cache.hpp"
+#include "viewport.hpp"
+
+namespace {
+// View moved onto the tile pyramid grid while it is in double precision, so
+// its frames can be assembled from cached tiles
+// NOTE: Deeper views keep their exact center
+DeepViewport AlignView(const DeepViewport &view) {
+    const auto double_view = view.ToViewport();
+    if (view.PixelWidth() < DOUBLE_MIN_SPACING ||
+        PlaceInPyramid(double_view).has_value()) {
+        return view;
+    }
+    return DeepViewport::FromViewport(SnapToPyramid(double_view));
+}
+}  // namespace
 
 std::expected<App *, MandelbrotError>
 App::Instance(const std::string &title, std::string_view config_file) {
@@ -47,7 +68,20 @@ App::App(const std::string &title, const Config &config)
              config.GetWindowValue(Config::WindowOption::Height),
              title),  // NOTE: Raylib window requires title as string
       shader(config.GetShaderPath(Config::ShaderType::Vertex),
-             config.GetShaderPath(Config::ShaderType::Fragment)) {
+             config.GetShaderPath(Config::ShaderType::Fragment)),
+      view{.width = window.GetWidth(), .height = window.GetHeight()},
+      render_thread(RenderThreadSettings{
+          .engine = {.max_iter = config.GetRenderSettings().max_iter,
+                     .fractal = config.GetFractalSettings()},
+          .governor = {.fps = fps},
+          .palette = config.GetPaletteSettings(),
+          .tile_cache_bytes =
+              static_cast<std::size_t>(config.GetRenderSettings().tile_cache)
+              << 20U,
+          .tile_store = config.GetRenderSettings().tile_store,
+          .tile_store_bytes = static_cast<std::size_t>(
+                                  config.GetRenderSettings().tile_store_size)
+                              << 20U}) {
     window.SetTargetFPS(fps);
     // Create a texture to be used for render
     // NOTE: "Rectangle uses font white character texture coordinates,
@@ -60,20 +94,25 @@ App::App(const std::string &title, const Config &config)
     texture = render_texture.GetTexture();
 
     // Prepare color palette
-    for (size_t i = 0; i < PALETTE_SIZE; ++i) {
-        color_palette.at(i) = Color{
-            static_cast<unsigned char>(HSV_PALETTE.at(i).r * 255.0F),
-            static_cast<unsigned char>(HSV_PALETTE.at(i).g * 255.0F),
-            static_cast<unsigned char>(HSV_PALETTE.at(i).b * 255.0F), 255};
-    }
-    Image palette_image(color_palette.data(), static_cast<int>(PALETTE_SIZE), 1,
-                        1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    // NOTE: Packed colors have the memory layout of the texture format
+    const auto palette = config.GetPaletteSettings().Generate();
+    color_palette.assign(palette.GetColors().begin(),
+                         palette.GetColors().end());
+    Image palette_image(color_palette.data(),
+                        static_cast<int>(color_palette.size()), 1, 1,
+                        PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
     palette_texture = raylib::Texture(palette_image);
+
+    view = AlignView(view);
+    render_thread.SetView(view);
 }
 
 void App::Run() {
     // Main loop
+    // NOTE: Frames are rendered by the render thread, the loop only handles
+    // input and draws the newest finished frame, so it keeps the target fps
     while (!window.ShouldClose()) {  // Detect window close button or ESC key
+        HandleInput();
         PrepareTexture();
         Draw();
     }
@@ -90,14 +129,71 @@ void App::PrepareTexture() {
     render_texture.EndMode();
 }
 
-// Draw the saved texture and render shaders
+// Zoom with the mouse wheel and pan by dragging, the render thread picks up
+// the new view after its current frame
+void App::HandleInput() {
+    const raylib::Vector2 mouse = GetMousePosition();
+    auto next = view;
+
+    // NOTE: One step per wheel event, fractional wheel moves would zoom by
+    // factors whose pixels share no samples. Zooming in keeps the view on the
+    // pyramid grid, zooming out may leave it
+    const float wheel = GetMouseWheelMove();
+    if (wheel != 0.0F) {
+        next = AlignView(
+            next.ZoomAt(static_cast<int>(mouse.x), static_cast<int>(mouse.y),
+                        wheel > 0.0F ? ZOOM_STEP : 1.0 / ZOOM_STEP));
+    }
+    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
+        const raylib::Vector2 delta = GetMouseDelta();
+        const auto dx = static_cast<int>(std::lround(delta.x));
+        const auto dy = static_cast<int>(std::lround(delta.y));
+        if (dx != 0 || dy != 0) {
+            next = next.MovedBy(-dx, -dy);
+        }
+    }
+
+    if (wheel != 0.0F || next.center_x != view.center_x ||
+        next.center_y != view.center_y) {
+        view = std::move(next);
+        render_thread.SetView(view);
+    }
+}
+
+// Upload the newest frame and draw it, or the shader preview before the first
+// frame
 void App::Draw() {
+    if (const auto *frame = render_thread.AcquireFrame()) {
+        // NOTE: Frames are smaller than the window while the governor lowers
+        // the resolution, the texture follows their size
+        if (frame_texture.width != frame->width ||
+            frame_texture.height != frame->height) {
+            Image frame_image(const_cast<PackedColor *>(frame->pixels.data()),
+                              frame->width, frame->height, 1,
+                              PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+            frame_texture = raylib::Texture(frame_image);
+            frame_texture.SetFilter(TEXTURE_FILTER_BILINEAR);
+        } else {
+            frame_texture.Update(frame->pixels.data());
+        }
+    }
+
     window.BeginDrawing();
     window.ClearBackground(BLACK);
-    shader.BeginMode();
-    shader.SetValue(shader.GetLocation("uColorPalette"), palette_texture);
-    static const raylib::Vector2 pos{0.0, 0.0};
-    texture.Draw(pos);
-    shader.EndMode();
+    if (frame_texture.id != 0) {
+        const raylib::Rectangle source(
+            0, 0, static_cast<float>(frame_texture.width),
+            static_cast<float>(frame_texture.height));
+        const raylib::Rectangle destination(
+            0, 0, static_cast<float>(window.GetWidth()),
+            static_cast<float>(window.GetHeight()));
+        frame_texture.Draw(source, destination);
+    } else {
+        shader.BeginMode();
+        shader.SetValue(shader.GetLocation("uColorPalette"), palette_texture);
+        static const raylib::Vector2 pos{0.0, 0.0};
+        texture.Draw(pos);
+        shader.EndMode();
+    }
     window.EndDrawing();
 }
@@ -1,12 +1,15 @@
 #pragma once
 
 #include <string_view>
+#include <vector>
 
 #include "raylib-cpp.hpp"
 
 #include "config.hpp"
 #include "mandelbrot_error.hpp"
-#include "rgb.hpp"
+#include "palette.hpp"
+#include "render_thread.hpp"
+#include "viewport.hpp"
 
 class App {
   public:
@@ -39,11 +42,23 @@ class App {
     raylib::Texture texture;
 
     void PrepareTexture();
+    void HandleInput();
     void Draw();
 
-    // Color palette
-    static constexpr std::size_t PALETTE_SIZE = 1024;
-    static constexpr auto HSV_PALETTE = RGB::GenPaletteHSV<PALETTE_SIZE>();
-    std::array<raylib::Color, PALETTE_SIZE> color_palette;
+    // Color palette, generated from the config file
+    std::vector<PackedColor> color_palette;
     raylib::Texture palette_texture;
+
+    // View rendered by the CPU engine, changed by the mouse
+    DeepViewport view;
+    // Newest frame of the render thread, scaled to the window when drawn
+    // NOTE: The shader preview is drawn until the first frame arrives
+    raylib::Texture frame_texture;
+    // NOTE: Declared last, so the thread stops before the window closes
+    RenderThread render_thread;
+
+    // Magnification of one mouse wheel step
+    // NOTE: Zooming by 2 around a pixel keeps every other row and column of
+    // the last frame, the render thread only renders the others
+    static constexpr double ZOOM_STEP = 2.0;
 };
@@ -0,0 +1,428 @@
+#include "batch_job.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include "raylib-cpp.hpp"
+#include "toml.hpp"
+
+#include "big_fixed.hpp"
+#include "config.hpp"
+#include "mandelbrot_error.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Fraction limbs of the centers of a frame with the zoom and width
+std::size_t ZoomLimbs(double zoom, int width) {
+    return std::max(
+        BigFixed::LimbsForResolution(Viewport::DEFAULT_SPAN_X / zoom /
+                                     static_cast<double>(width)),
+        BigFixed::DEFAULT_FRACTION_LIMBS);
+}
+}  // namespace
+
+// Loads the job file
+std::expected<BatchJob, MandelbrotError>
+BatchJob::Load(const std::filesystem::path &job_file) {
+    // Validate job path
+    if (!std::filesystem::exists(job_file)) {
+        auto error_msg =
+            std::format("Job file does not exist -> {}", job_file.string());
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::FileNotFound, error_msg));
+    }
+
+    // Parse job file
+    auto parse_result = toml::try_parse(job_file);
+
+    // Check if parsing succeeded
+    if (!parse_result.is_ok()) {
+        const auto &errors = parse_result.unwrap_err();
+        // Use the first error and convert it to string
+        std::string first_msg = format_error(errors.at(0));
+        auto error_msg =
+            std::format("Failed to parse job file -> {}", first_msg);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::ParseError, error_msg));
+    }
+
+    // Extract the root TOML value
+    const auto &root = parse_result.unwrap();
+
+    // Check if output table exists
+    if (!Config::HasTable(root, OUTPUT_TABLE_NAME)) {
+        auto error_msg = std::format("Job file must contain a table [{}]",
+                                     OUTPUT_TABLE_NAME);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::ParseError, error_msg));
+    }
+
+    // Create an empty job object
+    BatchJob job{};
+
+    // Load output related configuration
+    auto output_res = job.LoadOutputConfig(root, job_file.parent_path());
+    if (!output_res) {
+        return std::unexpected(output_res.error());
+    }
+
+    // Load the zoom path
+    auto keyframes_res = job.LoadKeyframes(root);
+    if (!keyframes_res) {
+        return std::unexpected(keyframes_res.error());
+    }
+
+    // Load fractal and palette tables like the config file
+    auto fractal_res = job.settings.LoadFractalConfig(root);
+    if (!fractal_res) {
+        return std::unexpected(fractal_res.error());
+    }
+    auto palette_res = job.settings.LoadPaletteConfig(root);
+    if (!palette_res) {
+        return std::unexpected(palette_res.error());
+    }
+
+    // The exponential map zooms into a single center of the plain set
+    if (job.exp_map) {
+        auto exp_map_res = job.ValidateExpMap();
+        if (!exp_map_res) {
+            return std::unexpected(exp_map_res.error());
+        }
+    }
+
+    // Job loaded successfully
+    return job;
+}
+
+std::expected<void, MandelbrotError>
+BatchJob::LoadOutputConfig(const tomlRoot &root,
+                           const std::filesystem::path &job_directory) {
+    // Table with output options
+    const auto *const table_name = OUTPUT_TABLE_NAME.data();
+    const auto &table = root.at(table_name);
+    const auto option_name = [](OutputOption option) {
+        return OUTPUT_OPTIONS_STR.at(static_cast<size_t>(option));
+    };
+
+    // Common error message templates
+    constexpr std::string_view missing_error_msg{
+        "Missing output option -> {}"};
+    constexpr std::string_view range_error_msg{
+        "Output option {} out of range [{}..{}] -> {}"};
+
+    // Output directory, relative to the job file
+    const auto directory_name = option_name(OutputOption::Directory);
+    auto found_directory =
+        Config::FindOptional<std::string>(table, directory_name, "string");
+    if (!found_directory) {
+        return std::unexpected(found_directory.error());
+    }
+    if (!found_directory->has_value() || (*found_directory)->empty()) {
+        auto error_msg = std::format(missing_error_msg, directory_name);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::MissingOption, error_msg));
+    }
+    directory = job_directory / **found_directory;
+
+    // File name prefix of the frames
+    auto found_prefix = Config::FindOptional<std::string>(
+        table, option_name(OutputOption::Prefix), "string");
+    if (!found_prefix) {
+        return std::unexpected(found_prefix.error());
+    }
+    prefix = found_prefix->value_or(prefix);
+
+    // Image format, given by its file extension
+    const auto format_name = option_name(OutputOption::Format);
+    auto found_format =
+        Config::FindOptional<std::string>(table, format_name, "string");
+    if (!found_format) {
+        return std::unexpected(found_format.error());
+    }
+    if (found_format->has_value()) {
+        const auto index = Config::FindName(IMAGE_FORMAT_STR, **found_format);
+        if (!index.has_value()) {
+            auto error_msg =
+                std::format("Output option {} has unknown value -> {}",
+                            format_name, **found_format);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        format = static_cast<ImageFormat>(*index);
+    }
+
+    // Int options share the same validation, the range is inclusive
+    for (const auto &[option, min, max, target] :
+         {std::tuple{OutputOption::Width, FRAME_SIZE_MIN, FRAME_SIZE_MAX,
+                     &width},
+          std::tuple{OutputOption::Height, FRAME_SIZE_MIN, FRAME_SIZE_MAX,
+                     &height},
+          std::tuple{OutputOption::Frames, 1, FRAMES_MAX, &frame_count}}) {
+        const auto name = option_name(option);
+        auto found = Config::FindOptional<int>(table, name, "int");
+        if (!found) {
+            return std::unexpected(found.error());
+        }
+        if (!found->has_value()) {
+            auto error_msg = std::format(missing_error_msg, name);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::MissingOption, error_msg));
+        }
+        const int value = **found;
+        if (value < min || value > max) {
+            auto error_msg =
+                std::format(range_error_msg, name, min, max, value);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        *target = value;
+    }
+
+    // Remap the frames from a log-polar strip
+    auto found_exp_map = Config::FindOptional<bool>(
+        table, option_name(OutputOption::ExpMap), "bool");
+    if (!found_exp_map) {
+        return std::unexpected(found_exp_map.error());
+    }
+    exp_map = found_exp_map->value_or(exp_map);
+
+    TraceLog(LOG_INFO,
+             "MANDELBROT_SET: Setting %s -> %d frames of %dx%d, %s%s in %s%s",
+             table_name, frame_count, width, height, prefix.c_str(),
+             IMAGE_FORMAT_STR.at(static_cast<size_t>(format)).data(),
+             directory.c_str(), exp_map ? " (exponential map)" : "");
+    return {};
+}
+
+std::expected<void, MandelbrotError>
+BatchJob::LoadKeyframes(const tomlRoot &root) {
+    const auto *const array_name = KEYFRAMES_ARRAY_NAME.data();
+    const auto option_name = [](KeyframeOption option) {
+        return KEYFRAME_OPTIONS_STR.at(static_cast<size_t>(option));
+    };
+
+    // Keyframes are written as [[keyframes]] tables
+    if (!root.contains(array_name) || !root.at(array_name).is_array() ||
+        root.at(array_name).as_array().empty()) {
+        auto error_msg = std::format(
+            "Job file must contain at least one table [[{}]]", array_name);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::MissingOption, error_msg));
+    }
+
+    // Common error message templates
+    constexpr std::string_view missing_error_msg{
+        "Missing option of keyframe {} -> {}"};
+    constexpr std::string_view range_error_msg{
+        "Option {} of keyframe {} out of range [{}..{}] -> {}"};
+
+    const auto &tables = root.at(array_name).as_array();
+    for (std::size_t index = 0; index < tables.size(); index++) {
+        const auto &table = tables[index];
+        if (!table.is_table()) {
+            auto error_msg =
+                std::format("Keyframe {} must be a table", index);
+            return std::unexpected(
+                MandelbrotError(MandelbrotError::Code::ParseError, error_msg));
+        }
+
+        // Every option of a keyframe is required
+        const auto find = [&]<typename T>(KeyframeOption option,
+                                          std::string_view type_name)
+            -> std::expected<T, MandelbrotError> {
+            const auto name = option_name(option);
+            auto found = Config::FindOptional<T>(table, name, type_name);
+            if (!found) {
+                return std::unexpected(found.error());
+            }
+            if (!found->has_value()) {
+                auto error_msg = std::format(missing_error_msg, index, name);
+                return std::unexpected(MandelbrotError(
+                    MandelbrotError::Code::MissingOption, error_msg));
+            }
+            return **found;
+        };
+
+        Keyframe keyframe;
+        auto frame = find.operator()<int>(KeyframeOption::Frame, "int");
+        if (!frame) {
+            return std::unexpected(frame.error());
+        }
+        const int previous = keyframes.empty() ? -1 : keyframes.back().frame;
+        if (*frame <= previous || *frame >= frame_count) {
+            auto error_msg = std::format(
+                range_error_msg, option_name(KeyframeOption::Frame), index,
+                previous + 1, frame_count - 1, *frame);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        keyframe.frame = *frame;
+
+        auto zoom = find.operator()<double>(KeyframeOption::Zoom, "float");
+        if (!zoom) {
+            return std::unexpected(zoom.error());
+        }
+        if (!std::isfinite(*zoom) || *zoom <= 0.0) {
+            auto error_msg = std::format(
+                "Option {} of keyframe {} must be positive -> {}",
+                option_name(KeyframeOption::Zoom), index, *zoom);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        keyframe.zoom = *zoom;
+
+        auto max_iter = find.operator()<int>(KeyframeOption::MaxIter, "int");
+        if (!max_iter) {
+            return std::unexpected(max_iter.error());
+        }
+        if (*max_iter < 1 || *max_iter > MAX_ITER_MAX) {
+            auto error_msg = std::format(
+                range_error_msg, option_name(KeyframeOption::MaxIter), index,
+                1, MAX_ITER_MAX, *max_iter);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        keyframe.max_iter = *max_iter;
+
+        // Centers are decimal strings, doubles lose deep zoom positions
+        const auto limbs = ZoomLimbs(keyframe.zoom, width);
+        for (const auto &[option, target] :
+             {std::pair{KeyframeOption::CenterX, &keyframe.center_x},
+              std::pair{KeyframeOption::CenterY, &keyframe.center_y}}) {
+            auto text = find.operator()<std::string>(option, "string");
+            if (!text) {
+                return std::unexpected(text.error());
+            }
+            auto center = BigFixed::FromString(*text, limbs);
+            if (!center.has_value()) {
+                auto error_msg = std::format(
+                    "Option {} of keyframe {} is not a decimal number -> {}",
+                    option_name(option), index, *text);
+                return std::unexpected(MandelbrotError(
+                    MandelbrotError::Code::InvalidValue, error_msg));
+            }
+            *target = std::move(*center);
+        }
+
+        TraceLog(LOG_INFO,
+                 "MANDELBROT_SET: Setting %s %zu -> frame %d, zoom %g, "
+                 "max_iter %d",
+                 array_name, index, keyframe.frame, keyframe.zoom,
+                 keyframe.max_iter);
+        keyframes.push_back(std::move(keyframe));
+    }
+    return {};
+}
+
+std::expected<void, MandelbrotError> BatchJob::ValidateExpMap() const {
+    const auto option = OUTPUT_OPTIONS_STR.at(
+        static_cast<size_t>(OutputOption::ExpMap));
+    if (!GetFractalSettings().IsPlainMandelbrot()) {
+        auto error_msg = std::format(
+            "Output option {} needs the mandelbrot formula in double", option);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::InvalidValue, error_msg));
+    }
+
+    // NOTE: Centers of different zooms have different precisions
+    const auto &first = keyframes.front();
+    for (std::size_t index = 1; index < keyframes.size(); index++) {
+        const auto &keyframe = keyframes[index];
+        const auto limbs = std::max(first.center_x.GetFractionLimbs(),
+                                    keyframe.center_x.GetFractionLimbs());
+        if (first.center_x.WithLimbs(limbs) !=
+                keyframe.center_x.WithLimbs(limbs) ||
+            first.center_y.WithLimbs(limbs) !=
+                keyframe.center_y.WithLimbs(limbs)) {
+            auto error_msg = std::format(
+                "Output option {} needs the same center in every keyframe, "
+                "keyframe {} differs",
+                option, index);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+    }
+    return {};
+}
+
+BatchJob::Segment BatchJob::FindSegment(int frame) const {
+    // Frames outside the keyframes hold the nearest one
+    const auto next = std::ranges::upper_bound(keyframes, frame, {},
+                                               &Keyframe::frame);
+    if (next == keyframes.begin()) {
+        return {.first = keyframes.front(), .last = keyframes.front()};
+    }
+    if (next == keyframes.end()) {
+        return {.first = keyframes.back(), .last = keyframes.back()};
+    }
+    const auto &first = *std::prev(next);
+    return {.first = first,
+            .last = *next,
+            .t = static_cast<double>(frame - first.frame) /
+                 static_cast<double>(next->frame - first.frame)};
+}
+
+DeepViewport BatchJob::FrameView(int frame) const {
+    const auto [first, last, t] = FindSegment(frame);
+
+    // Zoom changes by the same factor every frame
+    const double zoom = first.zoom * std::pow(last.zoom / first.zoom, t);
+    DeepViewport view;
+    view.width = width;
+    view.height = height;
+    view.span_x = Viewport::DEFAULT_SPAN_X / zoom;
+    view.span_y =
+        view.span_x * static_cast<double>(height) / static_cast<double>(width);
+
+    // The center covers the same share of its way as the span
+    // NOTE: Linear steps would leave the target off screen for most of a
+    // deep zoom
+    const double first_span = Viewport::DEFAULT_SPAN_X / first.zoom;
+    const double last_span = Viewport::DEFAULT_SPAN_X / last.zoom;
+    const double progress = first_span == last_span
+                                ? t
+                                : (first_span - view.span_x) /
+                                      (first_span - last_span);
+    const auto limbs = std::max({first.center_x.GetFractionLimbs(),
+                                 last.center_x.GetFractionLimbs(),
+                                 ZoomLimbs(zoom, width)});
+    const auto share = BigFixed::FromDouble(progress, limbs);
+    const auto interpolate = [&](const BigFixed &from, const BigFixed &to) {
+        const auto start = from.WithLimbs(limbs);
+        return start + ((to.WithLimbs(limbs) - start) * share);
+    };
+    view.center_x = interpolate(first.center_x, last.center_x);
+    view.center_y = interpolate(first.center_y, last.center_y);
+    return view;
+}
+
+int BatchJob::FrameMaxIter(int frame) const {
+    const auto [first, last, t] = FindSegment(frame);
+    const double max_iter =
+        static_cast<double>(first.max_iter) *
+        std::pow(static_cast<double>(last.max_iter) /
+                     static_cast<double>(first.max_iter),
+                 t);
+    return std::clamp(static_cast<int>(std::lround(max_iter)), 1,
+                      MAX_ITER_MAX);
+}
+
+std::filesystem::path BatchJob::FramePath(int frame) const {
+    return directory /
+           std::format("{}{:05}.{}", prefix, frame,
+                       IMAGE_FORMAT_STR.at(static_cast<size_t>(format)));
+}
+
+int BatchJob::GetPeakMaxIter() const {
+    return std::ranges::max(keyframes, {}, &Keyframe::max_iter).max_iter;
+}
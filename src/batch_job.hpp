@@ -0,0 +1,162 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "big_fixed.hpp"
+#include "config.hpp"
+#include "enum_list.hpp"
+#include "formula.hpp"
+#include "mandelbrot_error.hpp"
+#include "palette.hpp"
+#include "viewport.hpp"
+
+// Image format of the frames written by the batch renderer
+enum class ImageFormat : std::uint8_t {
+#define X(name, str) name,
+    IMAGE_FORMAT_LIST(X)
+#undef X
+};
+
+// Number of image formats
+constexpr std::size_t IMAGE_FORMAT_COUNT{0 IMAGE_FORMAT_LIST(X_ENUM_COUNT)};
+
+// Image formats as strings, also the file extensions
+constexpr std::array<std::string_view, IMAGE_FORMAT_COUNT> IMAGE_FORMAT_STR{
+#define X(name, str) str,
+    IMAGE_FORMAT_LIST(X)
+#undef X
+};
+
+// View of one frame of a batch job, the frames in between are interpolated
+struct Keyframe {
+    int frame{};
+    BigFixed center_x;
+    BigFixed center_y;
+    // Magnification relative to the default view, see DeepViewport::Zoom()
+    double zoom{1.0};
+    int max_iter{};
+};
+
+// Zoom path rendered headlessly by the BatchRenderer, loaded from a TOML job
+// file with the [fractal] and [palette] tables of the config file
+// NOTE: Zoom and iterations are interpolated exponentially between the
+// keyframes, the center moves in step with the view size, so a keyframe
+// zooming into a point keeps heading for it
+class BatchJob {
+  public:
+    enum class OutputOption : std::uint8_t {
+#define X(name, str) name,
+        BATCH_OUTPUT_OPTION_LIST(X)
+#undef X
+    };
+    enum class KeyframeOption : std::uint8_t {
+#define X(name, str) name,
+        KEYFRAME_OPTION_LIST(X)
+#undef X
+    };
+
+    // Numbers of job options
+    static constexpr size_t OUTPUT_OPTIONS_COUNT{
+        0 BATCH_OUTPUT_OPTION_LIST(X_ENUM_COUNT)};
+    static constexpr size_t KEYFRAME_OPTIONS_COUNT{
+        0 KEYFRAME_OPTION_LIST(X_ENUM_COUNT)};
+
+    // Array of string names for output options
+    static constexpr std::array<std::string_view, OUTPUT_OPTIONS_COUNT>
+        OUTPUT_OPTIONS_STR{
+#define X(name, str) str,
+            BATCH_OUTPUT_OPTION_LIST(X)
+#undef X
+        };
+
+    // Array of string names for keyframe options
+    static constexpr std::array<std::string_view, KEYFRAME_OPTIONS_COUNT>
+        KEYFRAME_OPTIONS_STR{
+#define X(name, str) str,
+            KEYFRAME_OPTION_LIST(X)
+#undef X
+        };
+
+    // Table names in the job file
+    static constexpr std::string_view OUTPUT_TABLE_NAME{"output"};
+    static constexpr std::string_view KEYFRAMES_ARRAY_NAME{"keyframes"};
+
+    // Job boundary values
+    static constexpr int FRAME_SIZE_MIN = 16;
+    static constexpr int FRAME_SIZE_MAX = 16384;
+    static constexpr int FRAMES_MAX = 1000000;
+    static constexpr int MAX_ITER_MAX = 100000000;
+
+    // Loads the job file, relative output directories are placed next to it
+    [[nodiscard]] static std::expected<BatchJob, MandelbrotError>
+    Load(const std::filesystem::path &job_file);
+
+    // View and iteration limit of the frame
+    [[nodiscard]] DeepViewport FrameView(int frame) const;
+    [[nodiscard]] int FrameMaxIter(int frame) const;
+
+    // Path of the image of the frame, e.g. frames/frame_00042.png
+    [[nodiscard]] std::filesystem::path FramePath(int frame) const;
+
+    // Highest iteration limit of the job, colors are mapped relative to it
+    [[nodiscard]] int GetPeakMaxIter() const;
+
+    // Getters
+    [[nodiscard]] int GetWidth() const noexcept { return width; }
+    [[nodiscard]] int GetHeight() const noexcept { return height; }
+    [[nodiscard]] int GetFrameCount() const noexcept { return frame_count; }
+    [[nodiscard]] ImageFormat GetFormat() const noexcept { return format; }
+    [[nodiscard]] bool IsExpMap() const noexcept { return exp_map; }
+    [[nodiscard]] const std::filesystem::path &GetDirectory() const noexcept {
+        return directory;
+    }
+    [[nodiscard]] const std::vector<Keyframe> &GetKeyframes() const noexcept {
+        return keyframes;
+    }
+    [[nodiscard]] const FractalSettings &GetFractalSettings() const noexcept {
+        return settings.fractal_settings;
+    }
+    [[nodiscard]] const PaletteSettings &GetPaletteSettings() const noexcept {
+        return settings.palette_settings;
+    }
+
+  private:
+    std::filesystem::path directory;
+    std::string prefix{"frame_"};
+    ImageFormat format{ImageFormat::Png};
+    int width{};
+    int height{};
+    int frame_count{};
+    // Frames are remapped from a log-polar strip, see ExpMapZoom
+    bool exp_map{false};
+    // Ordered by frame
+    std::vector<Keyframe> keyframes;
+    // Fractal and palette tables, loaded like in the config file
+    Config settings;
+
+    using tomlRoot = Config::tomlRoot;
+
+    // Keyframes around a frame and the position between them, in [0, 1]
+    struct Segment {
+        const Keyframe &first;
+        const Keyframe &last;
+        double t{0.0};
+    };
+    [[nodiscard]] Segment FindSegment(int frame) const;
+
+    // Load section from job file
+    std::expected<void, MandelbrotError>
+    LoadOutputConfig(const tomlRoot &root,
+                     const std::filesystem::path &job_directory);
+    std::expected<void, MandelbrotError>
+    LoadKeyframes(const tomlRoot &root);
+
+    // Exponential map jobs zoom the plain Mandelbrot set into one center
+    [[nodiscard]] std::expected<void, MandelbrotError> ValidateExpMap() const;
+};
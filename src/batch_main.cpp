@@ -0,0 +1,41 @@
+#include <cstddef>
+#include <span>
+#include <utility>
+
+#include "raylib-cpp.hpp"
+
+#include "batch_job.hpp"
+#include "batch_renderer.hpp"
+
+// Render the frames of a job file without a window, e.g.
+// mandelbrot_batch batch.toml
+int main(int argc, char *argv[]) {
+    const std::span args(argv, static_cast<std::size_t>(argc));
+    if (args.size() != 2) {
+        TraceLog(LOG_ERROR, "MANDELBROT_SET: Usage -> %s <job file>",
+                 args.empty() ? "mandelbrot_batch" : args[0]);
+        return 1;
+    }
+
+    // Load the job file
+    TraceLog(LOG_INFO, "MANDELBROT_SET: Loading job file -> %s", args[1]);
+    auto job_result = BatchJob::Load(args[1]);
+    if (!job_result) {
+        const auto &error = job_result.error();
+        TraceLog(LOG_ERROR, "MANDELBROT_SET: [%s] %s",
+                 error.GetCodeString().data(), error.GetMessage().c_str());
+        return 1;
+    }
+
+    // Render all frames
+    BatchRenderer renderer(std::move(job_result.value()));
+    auto stats_result = renderer.Run();
+    if (!stats_result) {
+        const auto &error = stats_result.error();
+        TraceLog(LOG_ERROR, "MANDELBROT_SET: [%s] %s",
+                 error.GetCodeString().data(), error.GetMessage().c_str());
+        return 1;
+    }
+
+    return 0;
+}
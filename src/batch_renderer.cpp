@@ -0,0 +1,435 @@
+#include "batch_renderer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "raylib-cpp.hpp"
+
+#include "batch_job.hpp"
+#include "bounded_queue.hpp"
+#include "engine.hpp"
+#include "exp_map.hpp"
+#include "iteration_buffer.hpp"
+#include "mandelbrot_error.hpp"
+#include "palette.hpp"
+
+BatchRenderer::BatchRenderer(BatchJob job, BatchSettings settings,
+                             FrameSink sink)
+    : job(std::move(job)), settings(settings), sink(std::move(sink)),
+      writes_files(!this->sink) {
+    this->settings.colorizer_count =
+        std::max<std::size_t>(this->settings.colorizer_count, 1);
+    this->settings.encoder_count =
+        std::max<std::size_t>(this->settings.encoder_count, 1);
+    this->settings.queue_capacity =
+        std::max<std::size_t>(this->settings.queue_capacity, 1);
+    if (writes_files) {
+        this->sink = [this](const BatchFrame &frame) {
+            return WriteImage(this->job.FramePath(frame.frame), frame);
+        };
+    }
+}
+
+namespace {
+// Marks the end of the frames in a stage queue
+constexpr std::size_t END_OF_FRAMES = std::numeric_limits<std::size_t>::max();
+
+// Iteration buffer of a rendered frame, waiting to be colored
+struct RenderedBuffer {
+    IterationBuffer buffer;
+    int frame{};
+    int max_iter{};
+};
+
+// Sums the occupancy of the queue in front of a stage
+class OccupancySampler {
+  public:
+    explicit OccupancySampler(const BoundedQueue<std::size_t> &queue)
+        : queue(queue) {}
+
+    // Sample the queue before the stage takes a frame
+    void Sample() {
+        const std::size_t occupancy = queue.Size();
+        sum += occupancy;
+        peak = std::max(peak, occupancy);
+        ++samples;
+    }
+
+    [[nodiscard]] QueueStats GetStats() const {
+        return QueueStats{.capacity = queue.GetCapacity(),
+                          .average = samples > 0
+                                         ? static_cast<double>(sum) /
+                                               static_cast<double>(samples)
+                                         : 0.0,
+                          .peak = peak};
+    }
+
+  private:
+    const BoundedQueue<std::size_t> &queue;
+    std::size_t samples{0};
+    std::size_t sum{0};
+    std::size_t peak{0};
+};
+
+// Sum of the work of the threads of one stage
+StageStats MergeStats(std::span<const StageStats> parts) {
+    StageStats total;
+    double occupancy_sum = 0.0;
+    for (const auto &part : parts) {
+        total.threads += part.threads;
+        total.frames += part.frames;
+        total.busy += part.busy;
+        total.input_wait += part.input_wait;
+        total.output_wait += part.output_wait;
+        total.input_queue.capacity = part.input_queue.capacity;
+        total.input_queue.peak =
+            std::max(total.input_queue.peak, part.input_queue.peak);
+        occupancy_sum += part.input_queue.average;
+    }
+    // NOTE: Every thread of a stage takes frames from the same queue
+    total.input_queue.average =
+        parts.empty() ? 0.0
+                      : occupancy_sum / static_cast<double>(parts.size());
+    return total;
+}
+}  // namespace
+
+BatchStage BatchStats::Bottleneck() const {
+    std::size_t slowest = 0;
+    for (std::size_t i = 1; i < BATCH_STAGE_COUNT; ++i) {
+        if (stages[i].Throughput() < stages[slowest].Throughput()) {
+            slowest = i;
+        }
+    }
+    return static_cast<BatchStage>(slowest);
+}
+
+struct BatchRenderer::Pipeline {
+    Pipeline(const BatchJob &job, const BatchSettings &settings)
+        : engine(EngineSettings{.max_iter = job.GetPeakMaxIter(),
+                                .fractal = job.GetFractalSettings(),
+                                .thread_count = settings.thread_count}),
+          colorize(SelectColorizeKernel(engine.GetIsa())),
+          palette(job.GetPaletteSettings().Generate()),
+          buffers(settings.queue_capacity + settings.colorizer_count + 1),
+          frames(settings.queue_capacity + settings.colorizer_count +
+                 settings.encoder_count),
+          free_buffers(buffers.size()), free_frames(frames.size()),
+          colorize_queue(settings.queue_capacity),
+          encode_queue(settings.queue_capacity),
+          colorizers_left(settings.colorizer_count) {
+        // NOTE: Every buffer gets the frame size up front, rendering and
+        // coloring only reuse the storage
+        for (std::size_t i = 0; i < buffers.size(); ++i) {
+            buffers[i].buffer.Resize(job.GetWidth(), job.GetHeight());
+            free_buffers.TryPush(std::size_t{i});
+        }
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            frames[i].pixels.resize(buffers.front().buffer.GetSize());
+            free_frames.TryPush(std::size_t{i});
+        }
+        engine.SetStopToken(stop.get_token());
+        if (job.IsExpMap()) {
+            exp_map.emplace(job);
+        }
+    }
+
+    // Stop every stage, only the first error is kept
+    void Fail(MandelbrotError failure) {
+        {
+            const std::scoped_lock lock(error_mutex);
+            if (!error.has_value()) {
+                error = std::move(failure);
+            }
+        }
+        stop.request_stop();
+    }
+
+    Engine engine;
+    // Strip of exponential map jobs, used by the compute stage only
+    std::optional<ExpMapZoom> exp_map;
+    ColorizeKernel colorize;
+    Palette palette;
+
+    // Iteration buffers and colored frames, stages pass their indices
+    std::vector<RenderedBuffer> buffers;
+    std::vector<BatchFrame> frames;
+    BoundedQueue<std::size_t> free_buffers;
+    BoundedQueue<std::size_t> free_frames;
+    // Rendered buffers waiting to be colored, colored frames waiting to be
+    // encoded
+    BoundedQueue<std::size_t> colorize_queue;
+    BoundedQueue<std::size_t> encode_queue;
+    // Colorizers still running, the last one ends the encode queue
+    std::atomic<std::size_t> colorizers_left;
+
+    // Written by the compute stage only
+    std::uint64_t pixels{0};
+    std::uint64_t iterations{0};
+
+    // Cancels the frame being rendered and wakes every waiting stage
+    std::stop_source stop;
+    std::mutex error_mutex;
+    std::optional<MandelbrotError> error;
+};
+
+std::expected<BatchStats, MandelbrotError> BatchRenderer::Run() {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Create the output directory
+    if (writes_files) {
+        std::error_code error_code;
+        std::filesystem::create_directories(job.GetDirectory(), error_code);
+        if (error_code) {
+            auto error_msg =
+                std::format("Failed to create output directory {} -> {}",
+                            job.GetDirectory().string(), error_code.message());
+            return std::unexpected(
+                MandelbrotError(MandelbrotError::Code::WriteError, error_msg));
+        }
+    }
+
+    // NOTE: The compute stage drives the engine, whose workers use all
+    // render threads. Colorizers and encoders are extra threads that mostly
+    // wait for frames
+    Pipeline pipeline(job, settings);
+    TraceLog(LOG_INFO,
+             "MANDELBROT_SET: Batch rendering %d frames on %zu threads with "
+             "%zu colorizers and %zu encoders",
+             job.GetFrameCount(), pipeline.engine.GetThreadCount(),
+             settings.colorizer_count, settings.encoder_count);
+
+    StageStats compute_stats;
+    std::vector<StageStats> colorize_stats(settings.colorizer_count);
+    std::vector<StageStats> encode_stats(settings.encoder_count);
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(settings.colorizer_count + settings.encoder_count);
+        for (auto &stats : colorize_stats) {
+            threads.emplace_back(
+                [this, &pipeline, &stats]() { ColorizeLoop(pipeline, stats); });
+        }
+        for (auto &stats : encode_stats) {
+            threads.emplace_back(
+                [this, &pipeline, &stats]() { EncodeLoop(pipeline, stats); });
+        }
+        ComputeLoop(pipeline, compute_stats);
+    }
+    if (pipeline.error.has_value()) {
+        return std::unexpected(*pipeline.error);
+    }
+
+    BatchStats stats;
+    stats.duration = std::chrono::steady_clock::now() - start;
+    stats.stages[static_cast<std::size_t>(BatchStage::Compute)] =
+        compute_stats;
+    stats.stages[static_cast<std::size_t>(BatchStage::Colorize)] =
+        MergeStats(colorize_stats);
+    stats.stages[static_cast<std::size_t>(BatchStage::Encode)] =
+        MergeStats(encode_stats);
+    stats.frames = stats.Stage(BatchStage::Encode).frames;
+    stats.pixels = pipeline.pixels;
+    stats.iterations = pipeline.iterations;
+
+    const double seconds =
+        std::chrono::duration<double>(stats.duration).count();
+    TraceLog(LOG_INFO,
+             "MANDELBROT_SET: Batch finished, %d frames in %.2f s (%.2f "
+             "frames/s)",
+             stats.frames, seconds,
+             static_cast<double>(stats.frames) / seconds);
+    for (std::size_t i = 0; i < BATCH_STAGE_COUNT; ++i) {
+        const auto &stage = stats.stages[i];
+        const double busy = std::chrono::duration<double>(stage.busy).count() /
+                            (seconds * static_cast<double>(stage.threads));
+        TraceLog(LOG_INFO,
+                 "MANDELBROT_SET: Stage %s on %zu threads, %.2f frames/s, "
+                 "%.0f%% busy, queue %.2f/%zu (peak %zu)",
+                 BATCH_STAGE_STR.at(i).data(), stage.threads,
+                 stage.Throughput(), busy * 100.0, stage.input_queue.average,
+                 stage.input_queue.capacity, stage.input_queue.peak);
+    }
+    TraceLog(LOG_INFO, "MANDELBROT_SET: Bottleneck -> %s stage",
+             BATCH_STAGE_STR.at(static_cast<std::size_t>(stats.Bottleneck()))
+                 .data());
+    return stats;
+}
+
+void BatchRenderer::ComputeLoop(Pipeline &pipeline, StageStats &stats) {
+    const auto stop = pipeline.stop.get_token();
+    stats.threads = 1;
+    for (int frame = 0; frame < job.GetFrameCount(); ++frame) {
+        // Take a free buffer, waits while the colorizers hold all of them
+        const auto wait_start = std::chrono::steady_clock::now();
+        const auto index = pipeline.free_buffers.Pop(stop);
+        const auto render_start = std::chrono::steady_clock::now();
+        stats.output_wait += render_start - wait_start;
+        if (!index) {
+            return;
+        }
+
+        // Render the frame, or remap it from the exponential map
+        auto &rendered = pipeline.buffers[*index];
+        rendered.frame = frame;
+        rendered.max_iter = job.FrameMaxIter(frame);
+        pipeline.engine.SetMaxIter(rendered.max_iter);
+        const auto render_stats =
+            pipeline.exp_map.has_value()
+                ? pipeline.exp_map->RenderFrame(pipeline.engine, frame,
+                                                rendered.buffer)
+                : pipeline.engine.RenderDeep(job.FrameView(frame),
+                                             rendered.buffer);
+        if (render_stats.cancelled) {
+            return;
+        }
+        const auto render_end = std::chrono::steady_clock::now();
+        stats.busy += render_end - render_start;
+        ++stats.frames;
+        pipeline.pixels += render_stats.pixels;
+        pipeline.iterations += render_stats.iterations;
+
+        // Hand the buffer to the colorizers, waits only while the queue is
+        // full
+        if (!pipeline.colorize_queue.Push(*index, stop)) {
+            return;
+        }
+        stats.output_wait += std::chrono::steady_clock::now() - render_end;
+
+        TraceLog(LOG_INFO,
+                 "MANDELBROT_SET: Frame %d/%d rendered in %.1f ms (%s, "
+                 "max_iter %d)",
+                 frame + 1, job.GetFrameCount(),
+                 std::chrono::duration<double, std::milli>(render_end -
+                                                           render_start)
+                     .count(),
+                 PRECISION_STR.at(static_cast<size_t>(render_stats.precision))
+                     .data(),
+                 rendered.max_iter);
+    }
+
+    // Every colorizer stops at its own end marker
+    for (std::size_t i = 0; i < settings.colorizer_count; ++i) {
+        pipeline.colorize_queue.Push(END_OF_FRAMES, stop);
+    }
+}
+
+void BatchRenderer::ColorizeLoop(Pipeline &pipeline, StageStats &stats) {
+    const auto stop = pipeline.stop.get_token();
+    const auto &palette_settings = job.GetPaletteSettings();
+    const auto peak_max_iter = static_cast<float>(job.GetPeakMaxIter());
+    OccupancySampler input(pipeline.colorize_queue);
+    stats.threads = 1;
+    while (true) {
+        // Take a rendered buffer and a free frame
+        input.Sample();
+        const auto wait_start = std::chrono::steady_clock::now();
+        const auto index = pipeline.colorize_queue.Pop(stop);
+        const auto taken = std::chrono::steady_clock::now();
+        stats.input_wait += taken - wait_start;
+        if (!index || *index == END_OF_FRAMES) {
+            break;
+        }
+        const auto frame_index = pipeline.free_frames.Pop(stop);
+        const auto color_start = std::chrono::steady_clock::now();
+        stats.output_wait += color_start - taken;
+        if (!frame_index) {
+            break;
+        }
+
+        // NOTE: Colors are mapped relative to the peak iteration limit, so
+        // they do not cycle while the limit grows along the zoom
+        auto &rendered = pipeline.buffers[*index];
+        auto &colored = pipeline.frames[*frame_index];
+        colored.frame = rendered.frame;
+        colored.width = rendered.buffer.GetWidth();
+        colored.height = rendered.buffer.GetHeight();
+        colored.pixels.resize(rendered.buffer.GetSize());
+        const auto max_iter = static_cast<float>(rendered.max_iter);
+        const ColorizeParams params{
+            .palette = pipeline.palette.GetColors(),
+            .max_iter = max_iter,
+            .density = palette_settings.density * max_iter / peak_max_iter,
+            .offset = palette_settings.offset,
+            .interior = PackColor(RGB{})};
+        pipeline.colorize(params, rendered.buffer.Values(), colored.pixels);
+        pipeline.free_buffers.Push(*index, stop);
+        const auto color_end = std::chrono::steady_clock::now();
+        stats.busy += color_end - color_start;
+        ++stats.frames;
+
+        // Hand the frame to the encoders
+        if (!pipeline.encode_queue.Push(*frame_index, stop)) {
+            break;
+        }
+        stats.output_wait += std::chrono::steady_clock::now() - color_end;
+    }
+    stats.input_queue = input.GetStats();
+
+    // NOTE: The last colorizer sends an end marker to every encoder
+    if (!stop.stop_requested() && pipeline.colorizers_left.fetch_sub(1) == 1) {
+        for (std::size_t i = 0; i < settings.encoder_count; ++i) {
+            pipeline.encode_queue.Push(END_OF_FRAMES, stop);
+        }
+    }
+}
+
+void BatchRenderer::EncodeLoop(Pipeline &pipeline, StageStats &stats) {
+    const auto stop = pipeline.stop.get_token();
+    OccupancySampler input(pipeline.encode_queue);
+    stats.threads = 1;
+    while (true) {
+        input.Sample();
+        const auto wait_start = std::chrono::steady_clock::now();
+        const auto index = pipeline.encode_queue.Pop(stop);
+        const auto encode_start = std::chrono::steady_clock::now();
+        stats.input_wait += encode_start - wait_start;
+        if (!index || *index == END_OF_FRAMES) {
+            break;
+        }
+
+        auto written = sink(pipeline.frames[*index]);
+        stats.busy += std::chrono::steady_clock::now() - encode_start;
+        if (!written) {
+            // NOTE: The first error stops the renderer and the other stages
+            pipeline.Fail(std::move(written.error()));
+            break;
+        }
+        ++stats.frames;
+        pipeline.free_frames.Push(*index, stop);
+    }
+    stats.input_queue = input.GetStats();
+}
+
+std::expected<void, MandelbrotError>
+BatchRenderer::WriteImage(const std::filesystem::path &path,
+                          const BatchFrame &frame) {
+    // NOTE: Packed colors have the memory layout of the image format, raylib
+    // only reads the pixels
+    const Image image{.data = const_cast<PackedColor *>(frame.pixels.data()),
+                      .width = frame.width,
+                      .height = frame.height,
+                      .mipmaps = 1,
+                      .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    if (!ExportImage(image, path.c_str())) {
+        auto error_msg =
+            std::format("Failed to write frame image -> {}", path.string());
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::WriteError, error_msg));
+    }
+    return {};
+}
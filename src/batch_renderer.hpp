@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include "batch_job.hpp"
+#include "enum_list.hpp"
+#include "mandelbrot_error.hpp"
+#include "palette.hpp"
+
+// Colored frame of a batch job, handed to the FrameSink
+struct BatchFrame {
+    int frame{};
+    int width{};
+    int height{};
+    std::vector<PackedColor> pixels;
+};
+
+// Stage of the batch pipeline
+enum class BatchStage : std::uint8_t {
+#define X(name, str) name,
+    BATCH_STAGE_LIST(X)
+#undef X
+};
+
+// Number of batch stages
+constexpr std::size_t BATCH_STAGE_COUNT{0 BATCH_STAGE_LIST(X_ENUM_COUNT)};
+
+// Batch stages as strings
+constexpr std::array<std::string_view, BATCH_STAGE_COUNT> BATCH_STAGE_STR{
+#define X(name, str) str,
+    BATCH_STAGE_LIST(X)
+#undef X
+};
+
+// Settings of the BatchRenderer
+struct BatchSettings {
+    // Render worker threads, 0 uses all hardware threads
+    std::size_t thread_count{0};
+    // Threads coloring rendered frames
+    std::size_t colorizer_count{1};
+    // Threads encoding and writing frames
+    std::size_t encoder_count{2};
+    // Frames waiting between two stages, a stage only waits for the next one
+    // when its queue is full
+    std::size_t queue_capacity{4};
+};
+
+// Occupancy of the queue in front of a stage, sampled whenever the stage
+// takes a frame
+// NOTE: A queue that is mostly full feeds the slowest stage, a queue that is
+// mostly empty follows it
+struct QueueStats {
+    std::size_t capacity{};
+    double average{};
+    std::size_t peak{};
+};
+
+// Work of one stage of a batch run, summed over its threads
+struct StageStats {
+    std::size_t threads{};
+    int frames{};
+    // Time spent on frames, waiting for frames of the previous stage, and
+    // waiting for free buffers or queue places of the next stage
+    std::chrono::nanoseconds busy{};
+    std::chrono::nanoseconds input_wait{};
+    std::chrono::nanoseconds output_wait{};
+    QueueStats input_queue;
+
+    // Frames per second the stage sustains when it never waits
+    [[nodiscard]] double Throughput() const {
+        const double seconds = std::chrono::duration<double>(busy).count();
+        return seconds > 0.0
+                   ? static_cast<double>(frames) *
+                         static_cast<double>(threads) / seconds
+                   : 0.0;
+    }
+};
+
+// Statistics of a batch run
+struct BatchStats {
+    // Frames written
+    int frames{};
+    std::chrono::nanoseconds duration{};
+    std::array<StageStats, BATCH_STAGE_COUNT> stages{};
+    std::uint64_t pixels{};
+    std::uint64_t iterations{};
+
+    [[nodiscard]] const StageStats &Stage(BatchStage stage) const {
+        return stages.at(static_cast<std::size_t>(stage));
+    }
+
+    // Stage with the lowest throughput, it sets the pace of the pipeline
+    [[nodiscard]] BatchStage Bottleneck() const;
+};
+
+// Renders every frame of a BatchJob with the CPU engine, without a window or
+// a GPU
+// NOTE: Frames pass a pipeline of compute, colorize and encode stages with
+// their own threads, connected by lock-free bounded queues. A full queue
+// holds back the stage in front of it. Iteration buffers and colored frames
+// are allocated once per run and recycled through pools, so the steady state
+// does not allocate
+class BatchRenderer {
+  public:
+    // Function encoding a finished frame, called from the encoder threads
+    using FrameSink =
+        std::function<std::expected<void, MandelbrotError>(const BatchFrame &)>;
+
+    // Frames are written as image files to the paths of the job by default
+    explicit BatchRenderer(BatchJob job, BatchSettings settings = {},
+                           FrameSink sink = {});
+
+    // Delete copy operations
+    BatchRenderer(const BatchRenderer &) = delete;
+    BatchRenderer &operator=(const BatchRenderer &) = delete;
+
+    // Delete move operations
+    BatchRenderer(BatchRenderer &&) noexcept = delete;
+    BatchRenderer &operator=(BatchRenderer &&) = delete;
+
+    ~BatchRenderer() = default;
+
+    // Render all frames, stops at the first frame that cannot be written
+    std::expected<BatchStats, MandelbrotError> Run();
+
+    // Write the frame as an image file in the format of the path extension
+    static std::expected<void, MandelbrotError>
+    WriteImage(const std::filesystem::path &path, const BatchFrame &frame);
+
+  private:
+    BatchJob job;
+    BatchSettings settings;
+    FrameSink sink;
+    // No sink was given, frames are written to the directory of the job
+    bool writes_files;
+
+    // Queues, buffer pools and results shared by the stages of a run
+    struct Pipeline;
+
+    // Stage loops, colorize and encode run until the previous stage sends
+    // its end marker or the run is stopped
+    void ComputeLoop(Pipeline &pipeline, StageStats &stats);
+    void ColorizeLoop(Pipeline &pipeline, StageStats &stats);
+    void EncodeLoop(Pipeline &pipeline, StageStats &stats);
+};
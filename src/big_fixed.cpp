@@ -0,0 +1,254 @@
+#include "big_fixed.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace {
+constexpr std::uint64_t LIMB_BASE = std::uint64_t{1} << BigFixed::LIMB_BITS;
+constexpr std::uint64_t LIMB_MASK = LIMB_BASE - 1;
+}  // namespace
+
+BigFixed::BigFixed(std::size_t fraction_limbs) : limbs(fraction_limbs + 1) {}
+
+BigFixed BigFixed::FromDouble(double value, std::size_t fraction_limbs) {
+    BigFixed result(fraction_limbs);
+    result.negative = std::signbit(value);
+
+    // Integer part
+    double magnitude = std::fabs(value);
+    assert(magnitude < static_cast<double>(LIMB_BASE));
+    const double integer = std::floor(magnitude);
+    result.limbs.back() = static_cast<std::uint32_t>(integer);
+
+    // Fraction, one limb at a time from the most significant
+    double fraction = magnitude - integer;
+    for (std::size_t i = fraction_limbs; i-- > 0 && fraction > 0.0;) {
+        fraction *= static_cast<double>(LIMB_BASE);
+        const double limb = std::floor(fraction);
+        result.limbs[i] = static_cast<std::uint32_t>(limb);
+        fraction -= limb;
+    }
+
+    result.negative = result.negative && !result.IsZero();
+    return result;
+}
+
+std::optional<BigFixed> BigFixed::FromString(std::string_view text,
+                                             std::size_t fraction_limbs) {
+    BigFixed result(fraction_limbs);
+
+    // Sign
+    if (!text.empty() && (text.front() == '-' || text.front() == '+')) {
+        result.negative = text.front() == '-';
+        text.remove_prefix(1);
+    }
+
+    // Split into integer and fraction digits
+    const auto point = text.find('.');
+    const auto integer_digits = text.substr(0, point);
+    const auto fraction_digits =
+        point == std::string_view::npos ? std::string_view{}
+                                        : text.substr(point + 1);
+    const auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+    if (integer_digits.empty() && fraction_digits.empty()) {
+        return std::nullopt;
+    }
+    if (!std::ranges::all_of(integer_digits, is_digit) ||
+        !std::ranges::all_of(fraction_digits, is_digit)) {
+        return std::nullopt;
+    }
+
+    // Fraction, digits are added from the least significant one and the
+    // number is divided by 10 after each of them
+    for (auto it = fraction_digits.rbegin(); it != fraction_digits.rend();
+         ++it) {
+        result.limbs.back() = static_cast<std::uint32_t>(*it - '0');
+        std::uint64_t remainder = 0;
+        for (std::size_t i = result.limbs.size(); i-- > 0;) {
+            const std::uint64_t current =
+                (remainder << LIMB_BITS) | result.limbs[i];
+            result.limbs[i] = static_cast<std::uint32_t>(current / 10);
+            remainder = current % 10;
+        }
+    }
+
+    // Integer part
+    std::uint64_t integer = 0;
+    for (const char digit : integer_digits) {
+        integer = (integer * 10) + static_cast<std::uint64_t>(digit - '0');
+        if (integer > std::numeric_limits<std::uint32_t>::max()) {
+            return std::nullopt;
+        }
+    }
+    result.limbs.back() = static_cast<std::uint32_t>(integer);
+
+    result.negative = result.negative && !result.IsZero();
+    return result;
+}
+
+std::size_t BigFixed::LimbsForResolution(double resolution) {
+    constexpr double guard_bits = 64.0;
+    const double bits =
+        std::max(0.0, -std::log2(std::fabs(resolution))) + guard_bits;
+    const auto limbs = static_cast<std::size_t>(
+        std::ceil(bits / static_cast<double>(LIMB_BITS)));
+    return std::max(limbs, DEFAULT_FRACTION_LIMBS);
+}
+
+double BigFixed::ToDouble() const {
+    // Sum from the most significant limb, lower limbs are below double
+    // precision anyway
+    double result = 0.0;
+    const auto fraction_limbs = static_cast<int>(GetFractionLimbs());
+    constexpr auto limb_bits = static_cast<int>(LIMB_BITS);
+    for (std::size_t i = limbs.size(); i-- > 0;) {
+        const int exponent = (static_cast<int>(i) - fraction_limbs) * limb_bits;
+        result += std::ldexp(static_cast<double>(limbs[i]), exponent);
+    }
+    return negative ? -result : result;
+}
+
+std::string BigFixed::ToString(std::size_t digits) const {
+    std::string result = negative ? "-" : "";
+    result += std::to_string(limbs.back());
+    if (digits == 0) {
+        return result;
+    }
+    result += '.';
+
+    // Fraction digits, multiply the fraction by 10 and take the overflow
+    std::vector<std::uint32_t> fraction(limbs.begin(), limbs.end() - 1);
+    for (std::size_t digit = 0; digit < digits; ++digit) {
+        std::uint64_t carry = 0;
+        for (auto &limb : fraction) {
+            const std::uint64_t current = (std::uint64_t{limb} * 10) + carry;
+            limb = static_cast<std::uint32_t>(current & LIMB_MASK);
+            carry = current >> LIMB_BITS;
+        }
+        result += static_cast<char>('0' + carry);
+    }
+    return result;
+}
+
+BigFixed BigFixed::WithLimbs(std::size_t fraction_limbs) const {
+    BigFixed result(fraction_limbs);
+    result.negative = negative;
+    result.limbs.back() = limbs.back();
+
+    // Align the most significant fraction limbs
+    const auto own_limbs = GetFractionLimbs();
+    const auto copied = std::min(own_limbs, fraction_limbs);
+    for (std::size_t i = 0; i < copied; ++i) {
+        result.limbs[fraction_limbs - 1 - i] = limbs[own_limbs - 1 - i];
+    }
+
+    result.negative = result.negative && !result.IsZero();
+    return result;
+}
+
+bool BigFixed::IsZero() const {
+    return std::ranges::all_of(limbs,
+                               [](std::uint32_t limb) { return limb == 0; });
+}
+
+int BigFixed::CompareMagnitude(const BigFixed &lhs, const BigFixed &rhs) {
+    assert(lhs.limbs.size() == rhs.limbs.size());
+    for (std::size_t i = lhs.limbs.size(); i-- > 0;) {
+        if (lhs.limbs[i] != rhs.limbs[i]) {
+            return lhs.limbs[i] < rhs.limbs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+BigFixed BigFixed::AddMagnitude(const BigFixed &lhs, const BigFixed &rhs) {
+    assert(lhs.limbs.size() == rhs.limbs.size());
+    BigFixed result(lhs.GetFractionLimbs());
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < lhs.limbs.size(); ++i) {
+        const std::uint64_t sum =
+            std::uint64_t{lhs.limbs[i]} + rhs.limbs[i] + carry;
+        result.limbs[i] = static_cast<std::uint32_t>(sum & LIMB_MASK);
+        carry = sum >> LIMB_BITS;
+    }
+    return result;
+}
+
+BigFixed BigFixed::SubMagnitude(const BigFixed &lhs, const BigFixed &rhs) {
+    assert(lhs.limbs.size() == rhs.limbs.size());
+    BigFixed result(lhs.GetFractionLimbs());
+    std::uint64_t borrow = 0;
+    for (std::size_t i = 0; i < lhs.limbs.size(); ++i) {
+        const std::uint64_t difference =
+            LIMB_BASE + lhs.limbs[i] - rhs.limbs[i] - borrow;
+        result.limbs[i] = static_cast<std::uint32_t>(difference & LIMB_MASK);
+        borrow = difference < LIMB_BASE ? 1 : 0;
+    }
+    return result;
+}
+
+BigFixed operator+(const BigFixed &lhs, const BigFixed &rhs) {
+    // Same signs add magnitudes
+    if (lhs.negative == rhs.negative) {
+        auto result = BigFixed::AddMagnitude(lhs, rhs);
+        result.negative = lhs.negative && !result.IsZero();
+        return result;
+    }
+
+    // Different signs subtract the smaller magnitude from the larger one
+    if (BigFixed::CompareMagnitude(lhs, rhs) >= 0) {
+        auto result = BigFixed::SubMagnitude(lhs, rhs);
+        result.negative = lhs.negative && !result.IsZero();
+        return result;
+    }
+    auto result = BigFixed::SubMagnitude(rhs, lhs);
+    result.negative = rhs.negative && !result.IsZero();
+    return result;
+}
+
+BigFixed operator-(const BigFixed &lhs, const BigFixed &rhs) {
+    return lhs + (-rhs);
+}
+
+BigFixed operator-(const BigFixed &value) {
+    BigFixed result = value;
+    result.negative = !value.negative && !value.IsZero();
+    return result;
+}
+
+BigFixed operator*(const BigFixed &lhs, const BigFixed &rhs) {
+    assert(lhs.limbs.size() == rhs.limbs.size());
+    const auto size = lhs.limbs.size();
+    const auto fraction_limbs = lhs.GetFractionLimbs();
+
+    // Schoolbook multiplication into a double width product
+    std::vector<std::uint32_t> product(2 * size);
+    for (std::size_t i = 0; i < size; ++i) {
+        if (lhs.limbs[i] == 0) {
+            continue;
+        }
+        std::uint64_t carry = 0;
+        for (std::size_t j = 0; j < size; ++j) {
+            const std::uint64_t current =
+                (std::uint64_t{lhs.limbs[i]} * rhs.limbs[j]) +
+                product[i + j] + carry;
+            product[i + j] = static_cast<std::uint32_t>(current & LIMB_MASK);
+            carry = current >> BigFixed::LIMB_BITS;
+        }
+        product[i + size] = static_cast<std::uint32_t>(carry);
+    }
+
+    // Drop the extra fraction limbs, the result is truncated
+    BigFixed result(fraction_limbs);
+    std::copy_n(product.begin() + static_cast<std::ptrdiff_t>(fraction_limbs),
+                size, result.limbs.begin());
+    result.negative = (lhs.negative != rhs.negative) && !result.IsZero();
+    return result;
+}
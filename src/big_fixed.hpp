@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Arbitrary precision signed fixed-point number
+// NOTE: The magnitude is stored in 32-bit limbs, least significant first, the
+// last limb holds the integer part and the rest hold the fraction
+class BigFixed {
+  public:
+    // 128 fraction bits, enough for any zoom reachable with double
+    static constexpr std::size_t DEFAULT_FRACTION_LIMBS = 4;
+    static constexpr std::size_t LIMB_BITS = 32;
+
+    explicit BigFixed(std::size_t fraction_limbs = DEFAULT_FRACTION_LIMBS);
+
+    // Create from a double, the conversion is exact
+    [[nodiscard]] static BigFixed FromDouble(double value,
+                                             std::size_t fraction_limbs);
+
+    // Create from a decimal string, e.g. "-0.743643887037158704752191506"
+    // Returns an empty optional when the string is not a decimal number
+    [[nodiscard]] static std::optional<BigFixed>
+    FromString(std::string_view text, std::size_t fraction_limbs);
+
+    // Number of fraction limbs needed to resolve distances of the given size
+    // NOTE: Keeps 64 guard bits for the rounding errors of the iteration
+    [[nodiscard]] static std::size_t LimbsForResolution(double resolution);
+
+    // Nearest double
+    [[nodiscard]] double ToDouble() const;
+
+    // Decimal representation truncated to the given number of fraction digits
+    [[nodiscard]] std::string ToString(std::size_t digits) const;
+
+    // Copy with a different precision, extra limbs are zero
+    [[nodiscard]] BigFixed WithLimbs(std::size_t fraction_limbs) const;
+
+    // Getters
+    [[nodiscard]] std::size_t GetFractionLimbs() const noexcept {
+        return limbs.size() - 1;
+    }
+    [[nodiscard]] bool IsNegative() const noexcept { return negative; }
+
+    // Arithmetic
+    // NOTE: Both operands must have the same precision, the integer part must
+    // fit into one limb
+    friend BigFixed operator+(const BigFixed &lhs, const BigFixed &rhs);
+    friend BigFixed operator-(const BigFixed &lhs, const BigFixed &rhs);
+    friend BigFixed operator*(const BigFixed &lhs, const BigFixed &rhs);
+    friend BigFixed operator-(const BigFixed &value);
+
+    // Same value in the same precision
+    friend bool operator==(const BigFixed &lhs,
+                           const BigFixed &rhs) = default;
+
+  private:
+    bool negative{false};
+    std::vector<std::uint32_t> limbs;
+
+    [[nodiscard]] bool IsZero() const;
+
+    // Operations on magnitudes, ignoring signs
+    static int CompareMagnitude(const BigFixed &lhs, const BigFixed &rhs);
+    static BigFixed AddMagnitude(const BigFixed &lhs, const BigFixed &rhs);
+    // NOTE: lhs magnitude must not be smaller than rhs magnitude
+    static BigFixed SubMagnitude(const BigFixed &lhs, const BigFixed &rhs);
+};
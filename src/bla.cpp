@@ -0,0 +1,104 @@
+#include "bla.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "perturbation.hpp"
+
+namespace {
+// Magnitude of a complex number
+double Magnitude(double x, double y) { return std::hypot(x, y); }
+
+// Step x followed by step y
+BlaStep Merge(const BlaStep &x, const BlaStep &y, double dc_max) {
+    // A = A_y A_x, B = A_y B_x + B_y
+    const double a_x = (y.a_x * x.a_x) - (y.a_y * x.a_y);
+    const double a_y = (y.a_x * x.a_y) + (y.a_y * x.a_x);
+    const double b_x = (y.a_x * x.b_x) - (y.a_y * x.b_y) + y.b_x;
+    const double b_y = (y.a_x * x.b_y) + (y.a_y * x.b_x) + y.b_y;
+
+    // The delta after step x must stay inside the radius of step y
+    // R = min(R_x, (R_y - |B_x| dc_max) / |A_x|)
+    const double radius_x = std::sqrt(x.radius2);
+    const double radius_y = std::sqrt(y.radius2);
+    const double a_x_magnitude = Magnitude(x.a_x, x.a_y);
+    const double b_x_magnitude = Magnitude(x.b_x, x.b_y);
+    double radius = radius_x;
+    if (a_x_magnitude > 0.0) {
+        radius = std::min(
+            radius, std::max(0.0, (radius_y - (b_x_magnitude * dc_max)) /
+                                      a_x_magnitude));
+    } else {
+        radius = 0.0;
+    }
+
+    return {.a_x = a_x,
+            .a_y = a_y,
+            .b_x = b_x,
+            .b_y = b_y,
+            .radius2 = radius * radius,
+            .length = x.length + y.length};
+}
+}  // namespace
+
+BlaTable BlaTable::Build(const ReferenceOrbit &orbit, double dc_max,
+                         double epsilon) {
+    BlaTable table;
+
+    // Single steps at iterations 1 .. size - 2, every step needs the next
+    // point of the orbit, Z_0 = 0 has no linear part
+    const auto size = orbit.GetSize();
+    if (size < 3) {
+        return table;
+    }
+    std::vector<BlaStep> single;
+    single.reserve(size - 2);
+    for (std::size_t m = 1; m + 1 < size; ++m) {
+        // d' = 2 Z d + dc when d^2 is negligible, |d| < epsilon |2 Z|
+        const auto &point = orbit.points[m];
+        const double radius = epsilon * 2.0 * Magnitude(point.x, point.y);
+        single.push_back({.a_x = 2.0 * point.x,
+                          .a_y = 2.0 * point.y,
+                          .b_x = 1.0,
+                          .b_y = 0.0,
+                          .radius2 = radius * radius,
+                          .length = 1});
+    }
+    table.levels.push_back(std::move(single));
+
+    // Merge neighbouring pairs until one step is left
+    while (table.levels.back().size() > 1) {
+        const auto &previous = table.levels.back();
+        std::vector<BlaStep> merged;
+        merged.reserve(previous.size() / 2);
+        for (std::size_t j = 0; j + 1 < previous.size(); j += 2) {
+            merged.push_back(Merge(previous[j], previous[j + 1], dc_max));
+        }
+        table.levels.push_back(std::move(merged));
+    }
+    return table;
+}
+
+const BlaStep *BlaTable::Lookup(int iter, double d_norm) const {
+    if (iter < 1 || levels.empty()) {
+        return nullptr;
+    }
+
+    // Only levels whose steps start at this iteration
+    const auto offset = static_cast<unsigned>(iter - 1);
+    const auto trailing_zeros =
+        static_cast<std::size_t>(std::countr_zero(offset));
+    const auto aligned = std::min(trailing_zeros, levels.size() - 1);
+    for (std::size_t level = aligned + 1; level-- > 0;) {
+        const auto index = static_cast<std::size_t>(offset >> level);
+        if (index < levels[level].size() &&
+            d_norm < levels[level][index].radius2) {
+            return &levels[level][index];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "perturbation.hpp"
+
+// Source: https://mathr.co.uk/blog/2022-02-21_deep_zoom_theory_and_practice_again.html
+
+// Bilinear approximation of several perturbation steps
+// d_{m+l} = A d_m + B dc, valid while |d_m| < radius
+struct BlaStep {
+    double a_x;
+    double a_y;
+    double b_x;
+    double b_y;
+    // Squared validity radius
+    double radius2;
+    // Number of iterations skipped by the step
+    int length;
+};
+
+// Table of bilinear approximations along the reference orbit
+// NOTE: Level l holds steps of 2^l iterations, entry j starts at reference
+// iteration 1 + j * 2^l
+class BlaTable {
+  public:
+    BlaTable() = default;
+
+    // Build the table for pixels at most dc_max away from the reference
+    // NOTE: epsilon is the relative error allowed for dropping d^2
+    [[nodiscard]] static BlaTable Build(const ReferenceOrbit &orbit,
+                                        double dc_max, double epsilon);
+
+    // Longest step valid at the reference iteration for a delta with the
+    // squared magnitude d_norm, nullptr when there is none
+    [[nodiscard]] const BlaStep *Lookup(int iter, double d_norm) const;
+
+    [[nodiscard]] std::size_t GetLevelCount() const noexcept {
+        return levels.size();
+    }
+
+  private:
+    std::vector<std::vector<BlaStep>> levels;
+};
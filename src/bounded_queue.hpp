@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stop_token>
+#include <utility>
+#include <vector>
+
+// Lock-free queue with a fixed capacity, any number of threads may push and
+// pop
+// NOTE: Every cell carries a sequence number telling whether it is free or
+// holds a value for the current lap, so pushes and pops only race for the
+// position counters. Blocking calls sleep on a counter of the other side
+// instead of spinning
+template <typename T> class BoundedQueue {
+  public:
+    explicit BoundedQueue(std::size_t capacity)
+        : cells(std::max<std::size_t>(capacity, 1)) {
+        for (std::size_t i = 0; i < cells.size(); ++i) {
+            cells[i].sequence.store(FreeSequence(i), std::memory_order_relaxed);
+        }
+    }
+
+    // Delete copy operations
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    // Delete move operations
+    BoundedQueue(BoundedQueue &&) noexcept = delete;
+    BoundedQueue &operator=(BoundedQueue &&) = delete;
+
+    ~BoundedQueue() = default;
+
+    // Add a value, returns false when the queue is full
+    // NOTE: The value is only moved from when it was added
+    bool TryPush(T &&value) {
+        auto position = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[position % cells.size()];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == FreeSequence(position)) {
+                if (tail.compare_exchange_weak(position, position + 1,
+                                               std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(FullSequence(position),
+                                        std::memory_order_release);
+                    Signal(pushes);
+                    return true;
+                }
+            } else if (sequence < FreeSequence(position)) {
+                // NOTE: The cell still holds the value of the previous lap
+                return false;
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Take the oldest value, std::nullopt when the queue is empty
+    std::optional<T> TryPop() {
+        auto position = head.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[position % cells.size()];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == FullSequence(position)) {
+                if (head.compare_exchange_weak(position, position + 1,
+                                               std::memory_order_relaxed)) {
+                    std::optional<T> value(std::move(cell.value));
+                    cell.sequence.store(FreeSequence(position + cells.size()),
+                                        std::memory_order_release);
+                    Signal(pops);
+                    return value;
+                }
+            } else if (sequence < FullSequence(position)) {
+                return std::nullopt;
+            } else {
+                position = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Add a value, waits while the queue is full
+    // Returns false when a stop was requested before the value was added
+    bool Push(T value, const std::stop_token &stop) {
+        const std::stop_callback wake(stop, [this]() { Wake(); });
+        while (true) {
+            const auto observed = pops.load(std::memory_order_acquire);
+            if (TryPush(std::move(value))) {
+                return true;
+            }
+            if (stop.stop_requested()) {
+                return false;
+            }
+            pops.wait(observed, std::memory_order_acquire);
+        }
+    }
+
+    // Take the oldest value, waits while the queue is empty
+    // Returns std::nullopt when a stop was requested before a value arrived
+    std::optional<T> Pop(const std::stop_token &stop) {
+        const std::stop_callback wake(stop, [this]() { Wake(); });
+        while (true) {
+            const auto observed = pushes.load(std::memory_order_acquire);
+            if (auto value = TryPop()) {
+                return value;
+            }
+            if (stop.stop_requested()) {
+                return std::nullopt;
+            }
+            pushes.wait(observed, std::memory_order_acquire);
+        }
+    }
+
+    // Number of values in the queue
+    // NOTE: Only a snapshot while other threads push or pop
+    [[nodiscard]] std::size_t Size() const noexcept {
+        const auto first = head.load(std::memory_order_relaxed);
+        const auto last = tail.load(std::memory_order_relaxed);
+        return last > first ? std::min(last - first, cells.size()) : 0;
+    }
+
+    [[nodiscard]] std::size_t GetCapacity() const noexcept {
+        return cells.size();
+    }
+
+  private:
+    struct Cell {
+        // Position the cell is free for, or the position of the value it
+        // holds, see FreeSequence() and FullSequence()
+        std::atomic<std::size_t> sequence;
+        T value{};
+    };
+
+    std::vector<Cell> cells;
+    // Positions of the next push and pop, never wrap in practice
+    // NOTE: Kept on separate cache lines, producers and consumers only
+    // share the cells they hand over
+    alignas(64) std::atomic<std::size_t> tail{0};
+    alignas(64) std::atomic<std::size_t> head{0};
+    // Completed pushes and pops, blocking calls wait for them to change
+    alignas(64) std::atomic<std::uint32_t> pushes{0};
+    std::atomic<std::uint32_t> pops{0};
+
+    // NOTE: Positions are doubled, so a full cell never looks free for the
+    // next lap, even with a single cell
+    static constexpr std::size_t FreeSequence(std::size_t position) noexcept {
+        return 2 * position;
+    }
+    static constexpr std::size_t FullSequence(std::size_t position) noexcept {
+        return (2 * position) + 1;
+    }
+
+    static void Signal(std::atomic<std::uint32_t> &counter) noexcept {
+        counter.fetch_add(1, std::memory_order_release);
+        counter.notify_all();
+    }
+
+    // Wake every blocked call, so it sees the stop request
+    void Wake() noexcept {
+        Signal(pushes);
+        Signal(pops);
+    }
+};
@@ -1,15 +1,22 @@
 #include "config.hpp"
 
 #include <array>
+#include <cstddef>
 #include <expected>
 #include <format>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <vector>
 
 #include "raylib-cpp.hpp"
 #include "toml.hpp"
 
+#include "formula.hpp"
 #include "mandelbrot_error.hpp"
+#include "palette.hpp"
 
 // Loads the configuration file
 std::expected<Config, MandelbrotError>
@@ -74,6 +81,24 @@ Config::Load(std::string_view config_file) {
         return std::unexpected(shader_res.error());
     }
 
+    // Load fractal related configuration
+    auto fractal_res = config.LoadFractalConfig(root);
+    if (!fractal_res) {
+        return std::unexpected(fractal_res.error());
+    }
+
+    // Load palette related configuration
+    auto palette_res = config.LoadPaletteConfig(root);
+    if (!palette_res) {
+        return std::unexpected(palette_res.error());
+    }
+
+    // Load render thread related configuration
+    auto render_res = config.LoadRenderConfig(root);
+    if (!render_res) {
+        return std::unexpected(render_res.error());
+    }
+
     // Configuration loaded successfully
     return config;
 }
@@ -206,6 +231,334 @@ Config::LoadShaderConfig(const tomlRoot &root) {
     return {};
 }
 
+std::optional<std::size_t>
+Config::FindName(std::span<const std::string_view> names,
+                 std::string_view name) {
+    for (std::size_t i = 0; i < names.size(); i++) {
+        if (names[i] == name) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+std::expected<void, MandelbrotError>
+Config::LoadFractalConfig(const tomlRoot &root) {
+    // Table with fractal options
+    const auto *const table_name = FRACTAL_TABLE_NAME.data();
+
+    // NOTE: The table and all of its options are optional, the defaults
+    // render the plain Mandelbrot set
+    if (!root.contains(table_name)) {
+        return {};
+    }
+    if (!HasTable(root, FRACTAL_TABLE_NAME)) {
+        auto error_msg =
+            std::format("Config option [{}] must be a table", table_name);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::ParseError, error_msg));
+    }
+    const auto &table = root.at(table_name);
+
+    // Common error message templates
+    constexpr std::string_view name_error_msg{
+        "Fractal config option {} has unknown value -> {}"};
+    constexpr std::string_view range_error_msg{
+        "Fractal config option {} out of range [{}..{}] -> {}"};
+
+    // Formula and scalar type, given by their names
+    const auto formula_name =
+        FRACTAL_OPTIONS_STR.at(static_cast<size_t>(FractalOption::Formula));
+    auto formula = FindOptional<std::string>(table, formula_name, "string");
+    if (!formula) {
+        return std::unexpected(formula.error());
+    }
+    if (formula->has_value()) {
+        const auto index = FindName(FORMULA_STR, **formula);
+        if (!index.has_value()) {
+            auto error_msg =
+                std::format(name_error_msg, formula_name, **formula);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        fractal_settings.formula = static_cast<Formula>(*index);
+    }
+
+    const auto scalar_name =
+        FRACTAL_OPTIONS_STR.at(static_cast<size_t>(FractalOption::Scalar));
+    auto scalar = FindOptional<std::string>(table, scalar_name, "string");
+    if (!scalar) {
+        return std::unexpected(scalar.error());
+    }
+    if (scalar->has_value()) {
+        const auto index = FindName(SCALAR_STR, **scalar);
+        if (!index.has_value()) {
+            auto error_msg = std::format(name_error_msg, scalar_name, **scalar);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        fractal_settings.scalar = static_cast<Scalar>(*index);
+    }
+
+    // Multibrot exponent, limited to the instantiated kernels
+    const auto power_name =
+        FRACTAL_OPTIONS_STR.at(static_cast<size_t>(FractalOption::Power));
+    auto power = FindOptional<int>(table, power_name, "int");
+    if (!power) {
+        return std::unexpected(power.error());
+    }
+    if (power->has_value()) {
+        const int value = **power;
+        if (value < FractalSettings::MIN_POWER ||
+            value > FractalSettings::MAX_POWER) {
+            auto error_msg = std::format(range_error_msg, power_name,
+                                         FractalSettings::MIN_POWER,
+                                         FractalSettings::MAX_POWER, value);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        fractal_settings.power = value;
+    }
+
+    // Julia constant
+    const auto julia_x_name =
+        FRACTAL_OPTIONS_STR.at(static_cast<size_t>(FractalOption::JuliaX));
+    auto julia_x = FindOptional<double>(table, julia_x_name, "float");
+    if (!julia_x) {
+        return std::unexpected(julia_x.error());
+    }
+    fractal_settings.julia_x = julia_x->value_or(fractal_settings.julia_x);
+
+    const auto julia_y_name =
+        FRACTAL_OPTIONS_STR.at(static_cast<size_t>(FractalOption::JuliaY));
+    auto julia_y = FindOptional<double>(table, julia_y_name, "float");
+    if (!julia_y) {
+        return std::unexpected(julia_y.error());
+    }
+    fractal_settings.julia_y = julia_y->value_or(fractal_settings.julia_y);
+
+    TraceLog(LOG_INFO,
+             "MANDELBROT_SET: Setting %s -> %s %s, power %d, julia %g %+gi",
+             table_name,
+             FORMULA_STR.at(static_cast<size_t>(fractal_settings.formula))
+                 .data(),
+             SCALAR_STR.at(static_cast<size_t>(fractal_settings.scalar)).data(),
+             fractal_settings.power, fractal_settings.julia_x,
+             fractal_settings.julia_y);
+    return {};
+}
+
+std::expected<void, MandelbrotError>
+Config::LoadPaletteConfig(const tomlRoot &root) {
+    // Table with palette options
+    const auto *const table_name = PALETTE_TABLE_NAME.data();
+
+    // NOTE: The table and all of its options are optional, the defaults
+    // generate the HSV palette
+    if (!root.contains(table_name)) {
+        return {};
+    }
+    if (!HasTable(root, PALETTE_TABLE_NAME)) {
+        auto error_msg =
+            std::format("Config option [{}] must be a table", table_name);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::ParseError, error_msg));
+    }
+    const auto &table = root.at(table_name);
+
+    // Common error message templates
+    constexpr std::string_view name_error_msg{
+        "Palette config option {} has unknown value -> {}"};
+    constexpr std::string_view range_error_msg{
+        "Palette config option {} out of range [{}..{}] -> {}"};
+    const auto option_name = [](PaletteOption option) {
+        return PALETTE_OPTIONS_STR.at(static_cast<size_t>(option));
+    };
+
+    // Palette type, given by its name
+    const auto type_name = option_name(PaletteOption::Type);
+    auto type = FindOptional<std::string>(table, type_name, "string");
+    if (!type) {
+        return std::unexpected(type.error());
+    }
+    if (type->has_value()) {
+        const auto index = FindName(PALETTE_TYPE_STR, **type);
+        if (!index.has_value()) {
+            auto error_msg = std::format(name_error_msg, type_name, **type);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        palette_settings.type = static_cast<PaletteType>(*index);
+    }
+
+    // Number of colors in the lookup table
+    const auto size_name = option_name(PaletteOption::Size);
+    auto size = FindOptional<int>(table, size_name, "int");
+    if (!size) {
+        return std::unexpected(size.error());
+    }
+    if (size->has_value()) {
+        const int value = **size;
+        if (value < static_cast<int>(Palette::MIN_SIZE) ||
+            value > static_cast<int>(Palette::MAX_SIZE)) {
+            auto error_msg =
+                std::format(range_error_msg, size_name, Palette::MIN_SIZE,
+                            Palette::MAX_SIZE, value);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        palette_settings.size = static_cast<std::size_t>(value);
+    }
+
+    // Float options share the same validation, the range is inclusive
+    const auto find_float = [&](PaletteOption option, double min, double max,
+                                float &target)
+        -> std::expected<void, MandelbrotError> {
+        const auto name = option_name(option);
+        auto found = FindOptional<double>(table, name, "float");
+        if (!found) {
+            return std::unexpected(found.error());
+        }
+        if (found->has_value()) {
+            const double value = **found;
+            if (value < min || value > max) {
+                auto error_msg =
+                    std::format(range_error_msg, name, min, max, value);
+                return std::unexpected(MandelbrotError(
+                    MandelbrotError::Code::InvalidValue, error_msg));
+            }
+            target = static_cast<float>(value);
+        }
+        return {};
+    };
+    for (const auto &[option, min, max, target] :
+         {std::tuple{PaletteOption::Saturation, 0.0, 1.0,
+                     &palette_settings.saturation},
+          std::tuple{PaletteOption::Value, 0.0, 1.0, &palette_settings.value},
+          std::tuple{PaletteOption::Density, 0.0, PALETTE_DENSITY_MAX,
+                     &palette_settings.density},
+          std::tuple{PaletteOption::Offset, 0.0, 1.0,
+                     &palette_settings.offset}}) {
+        auto found = find_float(option, min, max, *target);
+        if (!found) {
+            return std::unexpected(found.error());
+        }
+    }
+    if (palette_settings.density <= 0.0F) {
+        auto error_msg = std::format("Palette config option {} must be "
+                                     "positive -> {}",
+                                     option_name(PaletteOption::Density),
+                                     palette_settings.density);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::InvalidValue, error_msg));
+    }
+
+    // Gradient stops written as "#rrggbb"
+    const auto colors_name = option_name(PaletteOption::Colors);
+    auto colors = FindOptional<std::vector<std::string>>(table, colors_name,
+                                                         "array of strings");
+    if (!colors) {
+        return std::unexpected(colors.error());
+    }
+    for (const auto &text : colors->value_or(std::vector<std::string>{})) {
+        auto color = Palette::ParseColor(text);
+        if (!color) {
+            return std::unexpected(color.error());
+        }
+        palette_settings.stops.push_back(*color);
+    }
+    if (palette_settings.type == PaletteType::Gradient &&
+        palette_settings.stops.size() <
+            static_cast<std::size_t>(PALETTE_STOPS_MIN)) {
+        auto error_msg =
+            std::format("Gradient palette needs at least {} {} -> {}",
+                        PALETTE_STOPS_MIN, colors_name,
+                        palette_settings.stops.size());
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::MissingOption, error_msg));
+    }
+
+    TraceLog(LOG_INFO,
+             "MANDELBROT_SET: Setting %s -> %s, %zu colors, density %g, "
+             "offset %g",
+             table_name,
+             PALETTE_TYPE_STR.at(static_cast<size_t>(palette_settings.type))
+                 .data(),
+             palette_settings.size,
+             static_cast<double>(palette_settings.density),
+             static_cast<double>(palette_settings.offset));
+    return {};
+}
+
+std::expected<void, MandelbrotError>
+Config::LoadRenderConfig(const tomlRoot &root) {
+    // Table with render options
+    const auto *const table_name = RENDER_TABLE_NAME.data();
+
+    // NOTE: The table and all of its options are optional
+    if (!root.contains(table_name)) {
+        return {};
+    }
+    if (!HasTable(root, RENDER_TABLE_NAME)) {
+        auto error_msg =
+            std::format("Config option [{}] must be a table", table_name);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::ParseError, error_msg));
+    }
+    const auto &table = root.at(table_name);
+
+    // Common error message template
+    constexpr std::string_view range_error_msg{
+        "Render config option {} out of range [{}..{}] -> {}"};
+    const auto option_name = [](RenderOption option) {
+        return RENDER_OPTIONS_STR.at(static_cast<size_t>(option));
+    };
+
+    // Int options share the same validation, the range is inclusive
+    for (const auto &[option, min, max, target] :
+         {std::tuple{RenderOption::MaxIter, 1, RENDER_MAX_ITER_MAX,
+                     &render_settings.max_iter},
+          std::tuple{RenderOption::TileCache, 0, RENDER_TILE_CACHE_MAX,
+                     &render_settings.tile_cache},
+          std::tuple{RenderOption::TileStoreSize, 1,
+                     RENDER_TILE_STORE_SIZE_MAX,
+                     &render_settings.tile_store_size}}) {
+        const auto name = option_name(option);
+        auto found = FindOptional<int>(table, name, "int");
+        if (!found) {
+            return std::unexpected(found.error());
+        }
+        if (found->has_value()) {
+            const int value = **found;
+            if (value < min || value > max) {
+                auto error_msg =
+                    std::format(range_error_msg, name, min, max, value);
+                return std::unexpected(MandelbrotError(
+                    MandelbrotError::Code::InvalidValue, error_msg));
+            }
+            *target = value;
+        }
+    }
+
+    // Tile store file, relative to the project root
+    const auto store_name = option_name(RenderOption::TileStore);
+    auto store = FindOptional<std::string>(table, store_name, "string");
+    if (!store) {
+        return std::unexpected(store.error());
+    }
+    if (store->has_value() && !(*store)->empty()) {
+        render_settings.tile_store = std::filesystem::path(ROOT_SV) / **store;
+    }
+
+    TraceLog(LOG_INFO,
+             "MANDELBROT_SET: Setting %s -> max_iter %d, tile cache %d MiB, "
+             "tile store '%s' of %d MiB",
+             table_name, render_settings.max_iter, render_settings.tile_cache,
+             render_settings.tile_store.c_str(),
+             render_settings.tile_store_size);
+    return {};
+}
+
 std::filesystem::path
 Config::CreateShaderPath(std::string_view shader_file_name) {
     // NOTE: Passing an empty string means "no shader" for that stage
@@ -231,3 +584,15 @@ const std::filesystem::path &Config::GetShaderPath(ShaderType type) const {
     const auto &value = shader_paths.at(index);
     return value;
 }
+
+const FractalSettings &Config::GetFractalSettings() const {
+    return fractal_settings;
+}
+
+const PaletteSettings &Config::GetPaletteSettings() const {
+    return palette_settings;
+}
+
+const RenderSettings &Config::GetRenderSettings() const {
+    return render_settings;
+}
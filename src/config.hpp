@@ -1,15 +1,34 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 
 #include "toml.hpp"
 
 #include "enum_list.hpp"
+#include "formula.hpp"
 #include "mandelbrot_error.hpp"
+#include "palette.hpp"
+
+// Options of the render thread of the viewer
+struct RenderSettings {
+    // Iterations of a full quality frame
+    int max_iter{1000};
+    // Memory of the tile cache in MiB, 0 disables it
+    int tile_cache{256};
+    // File keeping rendered tiles between runs, empty disables it
+    std::filesystem::path tile_store{};
+    // Size of the tile data of a new store file in MiB
+    int tile_store_size{1024};
+};
 
 // Class that stores configuration file data
 class Config {
@@ -25,12 +44,33 @@ class Config {
         SHADER_TYPE_LIST(X)
 #undef X
     };
+    enum class FractalOption : std::uint8_t {
+#define X(name, str) name,
+        FRACTAL_OPTION_LIST(X)
+#undef X
+    };
+    enum class PaletteOption : std::uint8_t {
+#define X(name, str) name,
+        PALETTE_OPTION_LIST(X)
+#undef X
+    };
+    enum class RenderOption : std::uint8_t {
+#define X(name, str) name,
+        RENDER_OPTION_LIST(X)
+#undef X
+    };
 
     // Numbers of configuration options
     static constexpr size_t WINDOW_OPTIONS_COUNT{
         0 WINDOW_OPTION_LIST(X_ENUM_COUNT)};
     static constexpr size_t SHADER_TYPES_COUNT{
         0 SHADER_TYPE_LIST(X_ENUM_COUNT)};
+    static constexpr size_t FRACTAL_OPTIONS_COUNT{
+        0 FRACTAL_OPTION_LIST(X_ENUM_COUNT)};
+    static constexpr size_t PALETTE_OPTIONS_COUNT{
+        0 PALETTE_OPTION_LIST(X_ENUM_COUNT)};
+    static constexpr size_t RENDER_OPTIONS_COUNT{
+        0 RENDER_OPTION_LIST(X_ENUM_COUNT)};
 
     // Array of string names for window options
     static constexpr std::array<std::string_view, WINDOW_OPTIONS_COUNT>
@@ -48,9 +88,36 @@ class Config {
 #undef X
         };
 
+    // Array of string names for fractal options
+    static constexpr std::array<std::string_view, FRACTAL_OPTIONS_COUNT>
+        FRACTAL_OPTIONS_STR{
+#define X(name, str) str,
+            FRACTAL_OPTION_LIST(X)
+#undef X
+        };
+
+    // Array of string names for palette options
+    static constexpr std::array<std::string_view, PALETTE_OPTIONS_COUNT>
+        PALETTE_OPTIONS_STR{
+#define X(name, str) str,
+            PALETTE_OPTION_LIST(X)
+#undef X
+        };
+
+    // Array of string names for render options
+    static constexpr std::array<std::string_view, RENDER_OPTIONS_COUNT>
+        RENDER_OPTIONS_STR{
+#define X(name, str) str,
+            RENDER_OPTION_LIST(X)
+#undef X
+        };
+
     // Table names in configuration file
     static constexpr std::string_view WINDOW_TABLE_NAME{"window"};
     static constexpr std::string_view SHADER_TABLE_NAME{"shaders"};
+    static constexpr std::string_view FRACTAL_TABLE_NAME{"fractal"};
+    static constexpr std::string_view PALETTE_TABLE_NAME{"palette"};
+    static constexpr std::string_view RENDER_TABLE_NAME{"render"};
 
     // Project root path
     static constexpr std::string_view ROOT_SV{PROJECT_ROOT_PATH};
@@ -63,11 +130,21 @@ class Config {
     [[nodiscard]] int GetWindowValue(WindowOption option) const;
     [[nodiscard]] const std::filesystem::path &
     GetShaderPath(ShaderType type) const;
+    [[nodiscard]] const FractalSettings &GetFractalSettings() const;
+    [[nodiscard]] const PaletteSettings &GetPaletteSettings() const;
+    [[nodiscard]] const RenderSettings &GetRenderSettings() const;
 
   private:
+    // NOTE: Batch and poster jobs share the fractal and palette tables
+    friend class BatchJob;
+    friend class PosterJob;
+
     // Config values
     std::array<int, WINDOW_OPTIONS_COUNT> window_config{};
     std::array<std::filesystem::path, SHADER_TYPES_COUNT> shader_paths{};
+    FractalSettings fractal_settings{};
+    PaletteSettings palette_settings{};
+    RenderSettings render_settings{};
 
     // Window config boundary values
     static constexpr int WINDOW_SIZE_MIN = 64;
@@ -75,6 +152,15 @@ class Config {
     static constexpr int WINDOW_FPS_MIN = 1;
     static constexpr int WINDOW_FPS_MAX = 1000;
 
+    // Palette config boundary values
+    static constexpr int PALETTE_STOPS_MIN = 2;
+    static constexpr double PALETTE_DENSITY_MAX = 1000.0;
+
+    // Render config boundary values
+    static constexpr int RENDER_MAX_ITER_MAX = 100000000;
+    static constexpr int RENDER_TILE_CACHE_MAX = 65536;
+    static constexpr int RENDER_TILE_STORE_SIZE_MAX = 1 << 20;
+
     // Creates full shader paths from file name
     static std::filesystem::path
     CreateShaderPath(std::string_view shader_file_name);
@@ -85,7 +171,41 @@ class Config {
     // Validation whether the config file has the appropriate table
     static bool HasTable(const tomlRoot &root, std::string_view table_name);
 
+    // Find an optional option of the table, an error when it has another
+    // type than T
+    // NOTE: Shared with the loaders of the batch and poster job files
+    template <typename T>
+    static std::expected<std::optional<T>, MandelbrotError>
+    FindOptional(const tomlRoot &table, std::string_view option_name,
+                 std::string_view type_name);
+
+    // Index of the name in the list of enum names
+    static std::optional<std::size_t>
+    FindName(std::span<const std::string_view> names, std::string_view name);
+
     // Load section from config file
     std::expected<void, MandelbrotError> LoadWindowConfig(const tomlRoot &root);
     std::expected<void, MandelbrotError> LoadShaderConfig(const tomlRoot &root);
+    std::expected<void, MandelbrotError>
+    LoadFractalConfig(const tomlRoot &root);
+    std::expected<void, MandelbrotError>
+    LoadPaletteConfig(const tomlRoot &root);
+    std::expected<void, MandelbrotError>
+    LoadRenderConfig(const tomlRoot &root);
 };
+
+template <typename T>
+std::expected<std::optional<T>, MandelbrotError>
+Config::FindOptional(const tomlRoot &table, std::string_view option_name,
+                     std::string_view type_name) {
+    // NOTE: type_error is thrown when the value has an invalid type
+    try {
+        return toml::find<std::optional<T>>(table, option_name.data());
+    } catch (const toml::type_error &) {
+        auto error_msg =
+            std::format("Invalid type for option '{}', expected {}",
+                        option_name, type_name);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::InvalidValue, error_msg));
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "big_fixed.hpp"
+
+// Source: https://www.davidhbailey.com/dhbsoftware/ (QD library)
+
+// Double-double number, the unevaluated sum hi + lo with |lo| <= ulp(hi) / 2
+// NOTE: Gives about 106 bits of mantissa, the error-free transformations
+// below need mul and add rounded separately (-ffp-contract=off)
+struct DoubleDouble {
+    double hi{};
+    double lo{};
+
+    constexpr DoubleDouble() = default;
+    constexpr explicit DoubleDouble(double value) : hi(value) {}
+    constexpr DoubleDouble(double high, double low) : hi(high), lo(low) {}
+
+    // Nearest double-double to a high precision number
+    static DoubleDouble FromBigFixed(const BigFixed &value) {
+        const double high = value.ToDouble();
+        const auto rest =
+            value - BigFixed::FromDouble(high, value.GetFractionLimbs());
+        return {high, rest.ToDouble()};
+    }
+
+    // a + b = s + err exactly, |a| >= |b|
+    static constexpr DoubleDouble QuickTwoSum(double a, double b) {
+        const double s = a + b;
+        return {s, b - (s - a)};
+    }
+
+    // a + b = s + err exactly
+    static constexpr DoubleDouble TwoSum(double a, double b) {
+        const double s = a + b;
+        const double bb = s - a;
+        return {s, (a - (s - bb)) + (b - bb)};
+    }
+
+    // a = hi + lo with 26 bit halves (Dekker's split)
+    static constexpr DoubleDouble Split(double a) {
+        constexpr double splitter = 134217729.0;  // 2^27 + 1
+        const double t = splitter * a;
+        const double high = t - (t - a);
+        return {high, a - high};
+    }
+
+    // a * b = p + err exactly
+    static constexpr DoubleDouble TwoProd(double a, double b) {
+        const double p = a * b;
+        const auto a_split = Split(a);
+        const auto b_split = Split(b);
+        const double err = (((a_split.hi * b_split.hi) - p) +
+                            (a_split.hi * b_split.lo) +
+                            (a_split.lo * b_split.hi)) +
+                           (a_split.lo * b_split.lo);
+        return {p, err};
+    }
+
+    friend constexpr DoubleDouble operator+(const DoubleDouble &a,
+                                            const DoubleDouble &b) {
+        auto s = TwoSum(a.hi, b.hi);
+        const auto t = TwoSum(a.lo, b.lo);
+        s = QuickTwoSum(s.hi, s.lo + t.hi);
+        return QuickTwoSum(s.hi, s.lo + t.lo);
+    }
+
+    friend constexpr DoubleDouble operator+(const DoubleDouble &a, double b) {
+        const auto s = TwoSum(a.hi, b);
+        return QuickTwoSum(s.hi, s.lo + a.lo);
+    }
+
+    friend constexpr DoubleDouble operator-(const DoubleDouble &a) {
+        return {-a.hi, -a.lo};
+    }
+
+    friend constexpr DoubleDouble operator-(const DoubleDouble &a,
+                                            const DoubleDouble &b) {
+        return a + (-b);
+    }
+
+    friend constexpr DoubleDouble operator*(const DoubleDouble &a,
+                                            const DoubleDouble &b) {
+        const auto p = TwoProd(a.hi, b.hi);
+        return QuickTwoSum(p.hi, p.lo + ((a.hi * b.lo) + (a.lo * b.hi)));
+    }
+
+    friend constexpr DoubleDouble operator*(const DoubleDouble &a, double b) {
+        const auto p = TwoProd(a.hi, b);
+        return QuickTwoSum(p.hi, p.lo + (a.lo * b));
+    }
+};
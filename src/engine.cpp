@@ -0,0 +1,1673 @@
+#include "engine.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "big_fixed.hpp"
+#include "bla.hpp"
+#include "double_double.hpp"
+#include "escape_time.hpp"
+#include "formula.hpp"
+#include "iteration_buffer.hpp"
+#include "kernels.hpp"
+#include "palette.hpp"
+#include "perturbation.hpp"
+#include "resample.hpp"
+#include "tile_cache.hpp"
+#include "tile_scheduler.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Periodicity tolerance relative to the pixel spacing
+// NOTE: Orbits returning this close are the same point at the zoom of the view
+constexpr double PERIOD_TOLERANCE = 0x1p-10;
+
+// Order in which RenderPending() refines rows, the rows of a pass are
+// REFINE_ROW_STRIDE apart
+constexpr int REFINE_ROW_STRIDE = 8;
+constexpr std::array<int, REFINE_ROW_STRIDE> REFINE_ROW_ORDER{0, 4, 2, 6,
+                                                              1, 5, 3, 7};
+
+// Block sizes of the RenderProgressive() passes, each half the previous one
+constexpr std::array<int, 4> PROGRESSIVE_BLOCK_SIZES{8, 4, 2, 1};
+
+// Add the counters of one pass to the stats of a frame
+void AddPass(RenderStats &stats, const RenderStats &pass) {
+    stats.pixels += pass.pixels;
+    stats.iterations += pass.iterations;
+    stats.skipped_iterations += pass.skipped_iterations;
+    stats.cancelled = stats.cancelled || pass.cancelled;
+    stats.cancelled_pixels += pass.cancelled_pixels;
+    stats.scheduling.wall += pass.scheduling.wall;
+    stats.scheduling.workers.resize(
+        std::max(stats.scheduling.workers.size(),
+                 pass.scheduling.workers.size()));
+    for (std::size_t i = 0; i < pass.scheduling.workers.size(); ++i) {
+        auto &worker = stats.scheduling.workers[i];
+        worker.busy += pass.scheduling.workers[i].busy;
+        worker.idle += pass.scheduling.workers[i].idle;
+        worker.tasks += pass.scheduling.workers[i].tasks;
+        worker.steals += pass.scheduling.workers[i].steals;
+    }
+}
+
+// Undecided orbits continued by one RenderResumable() task
+constexpr std::size_t RESUME_CHUNK_SIZE = 1024;
+
+// Whether two deep views sample the same points
+bool SameView(const DeepViewport &lhs, const DeepViewport &rhs) {
+    return lhs.width == rhs.width && lhs.height == rhs.height &&
+           lhs.span_x == rhs.span_x && lhs.span_y == rhs.span_y &&
+           lhs.center_x == rhs.center_x && lhs.center_y == rhs.center_y;
+}
+
+// Orbit of z^2 + c after ContinueOrbit()
+template <typename T> struct ContinuedOrbit {
+    int iter;
+    T z_x;
+    T z_y;
+    // Proven interior by the interior checks
+    bool interior;
+    // The last z escaped, the check lags one step behind so the orbit stops
+    // on the next step, see ResumeState::Orbit
+    bool escaping;
+    int skipped;
+};
+
+// Iterate z^2 + c from z and iter until the orbit escapes, becomes periodic
+// or reaches max_iter
+// NOTE: Same operations in the same order as EscapeTimeInterior() and the
+// double-double kernel, so a continued orbit ends like one iterated from
+// z = 0 with the higher limit. The escape check lags one step behind, the
+// z before the stored one was checked by the caller through escaping
+template <typename T>
+ContinuedOrbit<T> ContinueOrbit(const T &c_x, const T &c_y, T z_x, T z_y,
+                                int iter, bool escaping, int max_iter,
+                                double escape, bool check_interior,
+                                double period_tolerance) {
+    using Traits = ScalarTraits<T>;
+    if (escaping) {
+        return {iter, z_x, z_y, false, true, 0};
+    }
+    if (check_interior && iter == 0 && InCardioidOrBulb(c_x, c_y)) {
+        return {max_iter, z_x, z_y, true, false, max_iter};
+    }
+
+    T z2_x{};
+    T z2_y{};
+    // NOTE: Periodicity restarts from the first z, a fresh orbit saves z = 0
+    // and compares from the first step
+    T saved_x = z_x;
+    T saved_y = z_y;
+    int next_save = std::max(iter * 2, 1);
+    while (Traits::ToDouble(z2_x) + Traits::ToDouble(z2_y) <= escape &&
+           iter < max_iter) {
+        z2_x = z_x * z_x;
+        z2_y = z_y * z_y;
+        z_y = ((z_x * 2.0) * z_y) + c_y;
+        z_x = (z2_x - z2_y) + c_x;
+        iter++;
+
+        if (!check_interior) {
+            continue;
+        }
+        if (std::fabs(Traits::ToDouble(z_x - saved_x)) < period_tolerance &&
+            std::fabs(Traits::ToDouble(z_y - saved_y)) < period_tolerance) {
+            return {max_iter, z_x, z_y, true, false, max_iter - iter};
+        }
+        if (iter == next_save) {
+            saved_x = z_x;
+            saved_y = z_y;
+            next_save *= 2;
+        }
+    }
+    return {iter, z_x, z_y, false,
+            Traits::ToDouble(z2_x) + Traits::ToDouble(z2_y) > escape, 0};
+}
+
+// Seed of the sub-sample jitter, every frame uses the same pattern
+constexpr unsigned ANTIALIAS_SEED = 0x5eed;
+
+// Offsets of the sub-samples from the pixel center in pixels, one at a random
+// spot of every cell of a grid x grid division of the pixel
+// NOTE: Stratified jitter spreads the samples over the pixel without the
+// regular grid that aliases again on periodic detail
+std::vector<std::array<double, 2>> JitterPattern(int grid) {
+    std::minstd_rand random(ANTIALIAS_SEED);
+    std::uniform_real_distribution<double> jitter(0.0, 1.0);
+    const auto cell = 1.0 / static_cast<double>(grid);
+    std::vector<std::array<double, 2>> pattern;
+    pattern.reserve(static_cast<std::size_t>(grid * grid));
+    for (int y = 0; y < grid; ++y) {
+        for (int x = 0; x < grid; ++x) {
+            const double shift_x = (static_cast<double>(x) + jitter(random)) *
+                                   cell;
+            const double shift_y = (static_cast<double>(y) + jitter(random)) *
+                                   cell;
+            pattern.push_back({shift_x - 0.5, shift_y - 0.5});
+        }
+    }
+    return pattern;
+}
+
+// Index of the pixel in the buffer values
+std::size_t PixelIndex(const IterationBuffer &buffer, int x, int y) {
+    return (static_cast<std::size_t>(y) *
+            static_cast<std::size_t>(buffer.GetWidth())) +
+           static_cast<std::size_t>(x);
+}
+
+// Largest 4-connected region of glitched pixels, as pixel indices
+std::vector<std::size_t>
+LargestGlitchRegion(const IterationBuffer &buffer,
+                    const std::vector<std::uint8_t> &glitched) {
+    const int width = buffer.GetWidth();
+    const int height = buffer.GetHeight();
+    std::vector<std::uint8_t> visited(glitched.size(), 0);
+    std::vector<std::size_t> largest;
+    std::vector<std::size_t> region;
+
+    for (std::size_t seed = 0; seed < glitched.size(); ++seed) {
+        if (glitched[seed] == 0 || visited[seed] != 0) {
+            continue;
+        }
+
+        // Flood fill, the region itself is the queue
+        region.clear();
+        region.push_back(seed);
+        visited[seed] = 1;
+        for (std::size_t next = 0; next < region.size(); ++next) {
+            const int x = static_cast<int>(region[next]) % width;
+            const int y = static_cast<int>(region[next]) / width;
+            const std::array<std::array<int, 2>, 4> neighbours{
+                {{x - 1, y}, {x + 1, y}, {x, y - 1}, {x, y + 1}}};
+            for (const auto &[n_x, n_y] : neighbours) {
+                if (n_x < 0 || n_x >= width || n_y < 0 || n_y >= height) {
+                    continue;
+                }
+                const auto index = PixelIndex(buffer, n_x, n_y);
+                if (glitched[index] != 0 && visited[index] == 0) {
+                    visited[index] = 1;
+                    region.push_back(index);
+                }
+            }
+        }
+
+        if (region.size() > largest.size()) {
+            std::swap(region, largest);
+        }
+    }
+    return largest;
+}
+
+// Pixel of the region closest to its centroid
+std::size_t GlitchRegionCenter(const IterationBuffer &buffer,
+                               const std::vector<std::size_t> &region) {
+    const auto width = static_cast<std::size_t>(buffer.GetWidth());
+    double sum_x = 0.0;
+    double sum_y = 0.0;
+    for (const auto pixel : region) {
+        sum_x += static_cast<double>(pixel % width);
+        sum_y += static_cast<double>(pixel / width);
+    }
+    const double center_x = sum_x / static_cast<double>(region.size());
+    const double center_y = sum_y / static_cast<double>(region.size());
+
+    return *std::ranges::min_element(region, {}, [&](std::size_t pixel) {
+        const double d_x = static_cast<double>(pixel % width) - center_x;
+        const double d_y = static_cast<double>(pixel / width) - center_y;
+        return (d_x * d_x) + (d_y * d_y);
+    });
+}
+}  // namespace
+
+Engine::Engine(EngineSettings settings)
+    : settings(settings),
+      isa(SupportedIsa(settings.isa.value_or(DetectIsa()))),
+      row_kernel(SelectRowKernel(isa)), dd_row_kernel(SelectDdRowKernel(isa)),
+      formula_kernel(SelectFormulaKernel(settings.fractal)),
+      colorize_kernel(SelectColorizeKernel(isa)) {
+    // Use all hardware threads by default
+    auto thread_count = settings.thread_count;
+    if (thread_count == 0) {
+        thread_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+    scheduler = std::make_unique<TileScheduler>(thread_count);
+    this->settings.thread_count = thread_count;
+    this->settings.tile_size = std::max(settings.tile_size, 1);
+    this->settings.fractal.power =
+        std::clamp(settings.fractal.power, FractalSettings::MIN_POWER,
+                   FractalSettings::MAX_POWER);
+}
+
+RenderStats Engine::Render(const Viewport &view, IterationBuffer &buffer) {
+    if (!settings.fractal.IsPlainMandelbrot()) {
+        return RenderFormula(DeepViewport::FromViewport(view), buffer);
+    }
+    if (ResolvePrecision(view.PixelWidth()) == Precision::Double) {
+        return RenderDouble(view, buffer);
+    }
+    return RenderDeep(DeepViewport::FromViewport(view), buffer);
+}
+
+RenderStats Engine::RenderDeep(const DeepViewport &view,
+                               IterationBuffer &buffer) {
+    if (!settings.fractal.IsPlainMandelbrot()) {
+        return RenderFormula(view, buffer);
+    }
+    switch (ResolvePrecision(view.PixelWidth())) {
+    case Precision::Double:
+        return RenderDouble(view.ToViewport(), buffer);
+    case Precision::DoubleDouble:
+        return RenderDoubleDouble(view, buffer);
+    default:
+        return RenderPerturbation(view, buffer);
+    }
+}
+
+RenderStats Engine::RenderPan(const Viewport &previous, const Viewport &view,
+                              IterationBuffer &buffer) {
+    const auto offset = PanOffset(previous, view);
+    if (!offset || !settings.fractal.IsPlainMandelbrot() ||
+        ResolvePrecision(view.PixelWidth()) != Precision::Double ||
+        buffer.GetWidth() != view.width || buffer.GetHeight() != view.height) {
+        return Render(view, buffer);
+    }
+
+    // Pixel (x, y) of the view is pixel (x + offset_x, y + offset_y) of the
+    // previous one
+    const auto [offset_x, offset_y] = *offset;
+    buffer.Shift(offset_x, offset_y);
+
+    // Exposed rows span the whole width, exposed columns only the kept rows
+    const int kept_first_y = std::max(-offset_y, 0);
+    const int kept_last_y = view.height - std::max(offset_y, 0);
+    const std::array<TileRect, 3> exposed{{
+        {.first_x = 0,
+         .first_y = 0,
+         .last_x = view.width,
+         .last_y = kept_first_y},
+        {.first_x = 0,
+         .first_y = kept_last_y,
+         .last_x = view.width,
+         .last_y = view.height},
+        {.first_x = offset_x < 0 ? 0 : view.width - offset_x,
+         .first_y = kept_first_y,
+         .last_x = offset_x < 0 ? -offset_x : view.width,
+         .last_y = kept_last_y},
+    }};
+    return RenderDouble(view, buffer, exposed);
+}
+
+RenderStats Engine::RenderPending(const Viewport &view,
+                                  IterationBuffer &buffer,
+                                  PendingMask &pending,
+                                  std::chrono::nanoseconds budget) {
+    if (!settings.fractal.IsPlainMandelbrot() ||
+        ResolvePrecision(view.PixelWidth()) != Precision::Double ||
+        buffer.GetWidth() != view.width || buffer.GetHeight() != view.height ||
+        pending.size() != buffer.GetSize()) {
+        auto stats = Render(view, buffer);
+        pending.assign(buffer.GetSize(), 0);
+        return stats;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto render_span = DoubleSpan(view, buffer);
+    const auto width = static_cast<std::size_t>(view.width);
+    const auto pending_row = [&](int y) {
+        return std::span(pending).subspan(static_cast<std::size_t>(y) * width,
+                                          width);
+    };
+
+    // Rows are refined interleaved, so an interrupted refinement is spread
+    // over the whole frame
+    RenderStats stats;
+    stats.precision = Precision::Double;
+    bool rendered = false;
+    for (const int first_y : REFINE_ROW_ORDER) {
+        std::vector<TileRect> rows;
+        std::uint64_t pixels = 0;
+        for (int y = first_y; y < view.height; y += REFINE_ROW_STRIDE) {
+            const auto row_pending = std::ranges::count(
+                pending_row(y), static_cast<std::uint8_t>(1));
+            if (row_pending != 0) {
+                rows.push_back({.first_x = 0,
+                                .first_y = y,
+                                .last_x = view.width,
+                                .last_y = y + 1});
+                pixels += static_cast<std::uint64_t>(row_pending);
+            }
+        }
+        if (rows.empty()) {
+            continue;
+        }
+        // NOTE: At least one pass runs, so every call makes progress
+        if (rendered && std::chrono::steady_clock::now() - start >= budget) {
+            break;
+        }
+
+        // Render the runs of pending pixels of every row
+        auto pass = RenderTiles(rows, [&](const TileRect &tile) {
+            IterationCount count{};
+            for (int y = tile.first_y; y < tile.last_y; ++y) {
+                const auto row = pending_row(y);
+                int x = tile.first_x;
+                while (x < tile.last_x) {
+                    if (row[static_cast<std::size_t>(x)] == 0) {
+                        ++x;
+                        continue;
+                    }
+                    int last_x = x;
+                    while (last_x < tile.last_x &&
+                           row[static_cast<std::size_t>(last_x)] != 0) {
+                        ++last_x;
+                    }
+                    count += render_span(y, x, last_x);
+                    std::ranges::fill(
+                        row.subspan(static_cast<std::size_t>(x),
+                                    static_cast<std::size_t>(last_x - x)),
+                        static_cast<std::uint8_t>(0));
+                    x = last_x;
+                }
+            }
+            return count;
+        });
+        pass.pixels = pixels;
+        AddPass(stats, pass);
+        rendered = true;
+    }
+    stats.duration = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+RenderStats Engine::RenderCached(const Viewport &view,
+                                 IterationBuffer &buffer, TileCache &cache,
+                                 TileStore *store) {
+    const auto placement = PlaceInPyramid(view);
+    const bool plain = settings.fractal.IsPlainMandelbrot();
+    if (!placement ||
+        (plain && ResolvePrecision(view.PixelWidth()) != Precision::Double)) {
+        return Render(view, buffer);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    buffer.Resize(view.width, view.height);
+
+    // Tiles covering the view, in pyramid tile coordinates
+    const auto tile_index = [](std::int64_t pixel) {
+        return pixel >= 0 ? pixel / PYRAMID_TILE_SIZE
+                          : ((pixel + 1) / PYRAMID_TILE_SIZE) - 1;
+    };
+    const auto first_tile_x = tile_index(placement->first_x);
+    const auto first_tile_y = tile_index(placement->first_y);
+    const auto last_tile_x = tile_index(placement->first_x + view.width - 1);
+    const auto last_tile_y = tile_index(placement->first_y + view.height - 1);
+
+    // Tiles come from the cache, from the store or are rendered, values
+    // point into the tile or into the store mapping
+    struct CachedTile {
+        TileKey key;
+        TileCache::Tile tile;
+        std::span<const float> values;
+    };
+    std::vector<CachedTile> tiles;
+    std::vector<std::size_t> missing;
+    for (auto tile_y = first_tile_y; tile_y <= last_tile_y; ++tile_y) {
+        for (auto tile_x = first_tile_x; tile_x <= last_tile_x; ++tile_x) {
+            CachedTile cached{.key = {.level = placement->level,
+                                      .tile_x = tile_x,
+                                      .tile_y = tile_y,
+                                      .max_iter = settings.max_iter,
+                                      .escape = settings.escape,
+                                      .fractal = settings.fractal.Normalized(),
+                                      .interior_check =
+                                          settings.interior_check},
+                              .tile = nullptr,
+                              .values = {}};
+            cached.tile = cache.Find(cached.key);
+            if (cached.tile) {
+                cached.values = cached.tile->Values();
+            } else if (const auto stored =
+                           store != nullptr ? store->Find(cached.key)
+                                            : std::nullopt) {
+                cached.values = *stored;
+            } else {
+                missing.push_back(tiles.size());
+            }
+            tiles.push_back(std::move(cached));
+        }
+    }
+
+    // Render the missing tiles, one tile per task
+    std::atomic<std::uint64_t> iterations{0};
+    std::atomic<std::uint64_t> skipped{0};
+    std::atomic<std::uint64_t> cancelled{0};
+    auto scheduling = scheduler->Run(
+        missing.size(), [&](std::size_t index, std::size_t /*worker*/) {
+            if (stop_token.stop_requested()) {
+                cancelled.fetch_add(PYRAMID_TILE_SIZE * PYRAMID_TILE_SIZE,
+                                    std::memory_order_relaxed);
+                return;
+            }
+            auto &[key, tile, values] = tiles[missing[index]];
+            const auto tile_view =
+                PyramidTileViewport(key.level, key.tile_x, key.tile_y);
+            auto rendered = std::make_shared<IterationBuffer>(
+                PYRAMID_TILE_SIZE, PYRAMID_TILE_SIZE);
+            const TileRect rect{.first_x = 0,
+                                .first_y = 0,
+                                .last_x = PYRAMID_TILE_SIZE,
+                                .last_y = PYRAMID_TILE_SIZE};
+            IterationCount count{};
+            if (plain) {
+                count = RenderTile(rect, *rendered,
+                                   DoubleSpan(tile_view, *rendered));
+            } else {
+                const auto deep_view = DeepViewport::FromViewport(tile_view);
+                count = RenderRows(rect, FormulaSpan(deep_view, *rendered));
+            }
+            iterations.fetch_add(count.iterations, std::memory_order_relaxed);
+            skipped.fetch_add(count.skipped, std::memory_order_relaxed);
+            values = rendered->Values();
+            tile = std::move(rendered);
+        });
+    // Copy the part of every tile inside the view
+    for (const auto &[key, tile, values] : tiles) {
+        if (values.empty()) {
+            continue;
+        }
+        const auto tile_first_x = key.tile_x * PYRAMID_TILE_SIZE;
+        const auto tile_first_y = key.tile_y * PYRAMID_TILE_SIZE;
+        const auto first_x = std::max(tile_first_x, placement->first_x);
+        const auto last_x = std::min(tile_first_x + PYRAMID_TILE_SIZE,
+                                     placement->first_x + view.width);
+        const auto first_y = std::max(tile_first_y, placement->first_y);
+        const auto last_y = std::min(tile_first_y + PYRAMID_TILE_SIZE,
+                                     placement->first_y + view.height);
+        for (auto y = first_y; y < last_y; ++y) {
+            const auto source = values.subspan(
+                static_cast<std::size_t>(
+                    ((y - tile_first_y) * PYRAMID_TILE_SIZE) + first_x -
+                    tile_first_x),
+                static_cast<std::size_t>(last_x - first_x));
+            const auto target =
+                buffer.Row(static_cast<int>(y - placement->first_y))
+                    .subspan(static_cast<std::size_t>(first_x -
+                                                      placement->first_x));
+            std::ranges::copy(source, target.begin());
+        }
+    }
+
+    // NOTE: Tiles of a cancelled render stay missing and are not cached.
+    // Tiles are stored after the copy, a store may replace tiles whose values
+    // were copied
+    for (const auto index : missing) {
+        if (!tiles[index].tile) {
+            continue;
+        }
+        cache.Insert(tiles[index].key, tiles[index].tile);
+        if (store != nullptr) {
+            store->Insert(tiles[index].key, tiles[index].values);
+        }
+    }
+
+    RenderStats stats;
+    stats.duration = std::chrono::steady_clock::now() - start;
+    stats.pixels = static_cast<std::uint64_t>(missing.size()) *
+                   PYRAMID_TILE_SIZE * PYRAMID_TILE_SIZE;
+    stats.iterations = iterations.load();
+    stats.skipped_iterations = skipped.load();
+    stats.cancelled_pixels = cancelled.load();
+    stats.cancelled = stats.cancelled_pixels != 0;
+    stats.precision = plain ? Precision::Double : FormulaPrecision();
+    stats.scheduling = std::move(scheduling);
+    return stats;
+}
+
+RenderStats Engine::RenderProgressive(const DeepViewport &view,
+                                      IterationBuffer &buffer,
+                                      const PublishFunction &publish,
+                                      int last_block_size) {
+    const auto start = std::chrono::steady_clock::now();
+    buffer.Resize(view.width, view.height);
+
+    // Span function of the precision RenderDeep() would use
+    const auto double_view = view.ToViewport();
+    std::optional<PerturbationFrame> frame;
+    SpanFunction render_span;
+    RenderStats stats;
+    if (!settings.fractal.IsPlainMandelbrot()) {
+        render_span = FormulaSpan(view, buffer);
+        stats.precision = FormulaPrecision();
+    } else {
+        stats.precision = ResolvePrecision(view.PixelWidth());
+        switch (stats.precision) {
+        case Precision::Double:
+            render_span = DoubleSpan(double_view, buffer);
+            break;
+        case Precision::DoubleDouble:
+            render_span = DdSpan(view, buffer);
+            break;
+        default:
+            frame.emplace(PreparePerturbation(view, buffer));
+            render_span = PerturbationSpan(view, buffer, *frame);
+            stats.precision = Precision::Perturbation;
+            break;
+        }
+    }
+
+    for (const int block : PROGRESSIVE_BLOCK_SIZES) {
+        // Samples of the earlier passes lie on the grid of the previous block
+        // size
+        const int known = block == PROGRESSIVE_BLOCK_SIZES.front() ? 0
+                                                                   : block * 2;
+        std::vector<TileRect> rows;
+        std::uint64_t pixels = 0;
+        for (int y = 0; y < view.height; y += block) {
+            rows.push_back({.first_x = 0,
+                            .first_y = y,
+                            .last_x = view.width,
+                            .last_y = y + 1});
+            const bool known_row = known != 0 && y % known == 0;
+            const auto samples = (view.width + block - 1) / block;
+            const auto known_samples =
+                known_row ? (view.width + known - 1) / known : 0;
+            pixels += static_cast<std::uint64_t>(samples - known_samples);
+        }
+
+        auto pass = RenderTiles(rows, [&](const TileRect &tile) {
+            IterationCount count{};
+            for (int y = tile.first_y; y < tile.last_y; ++y) {
+                const bool known_row = known != 0 && y % known == 0;
+                if (block == 1 && !known_row) {
+                    count += render_span(y, tile.first_x, tile.last_x);
+                    continue;
+                }
+                const int first_x = (tile.first_x + block - 1) / block * block;
+                for (int x = first_x; x < tile.last_x; x += block) {
+                    if (!known_row || x % known != 0) {
+                        count += render_span(y, x, x + 1);
+                    }
+                }
+            }
+            return count;
+        });
+        pass.pixels = pixels;
+        // NOTE: Glitched samples already hold their rebased value, the coarse
+        // passes publish those and the full pass corrects every flagged
+        // sample with extra references
+        if (frame) {
+            const auto flagged = static_cast<std::uint64_t>(
+                std::ranges::count(frame->glitched, std::uint8_t{1}));
+            const auto glitched = flagged - stats.glitched_pixels;
+            if (block == 1 && !pass.cancelled) {
+                CorrectGlitches(view, *frame, buffer, pass);
+            }
+            pass.glitched_pixels = glitched;
+        }
+        // NOTE: Cancelled passes are not published. Skipped tiles count their
+        // whole rows, the pass only renders one sample per block
+        if (pass.cancelled) {
+            pass.cancelled_pixels = std::min(
+                pass.cancelled_pixels / static_cast<std::uint64_t>(block),
+                pass.pixels);
+        }
+        AddPass(stats, pass);
+        stats.glitched_pixels += pass.glitched_pixels;
+        stats.extra_references += pass.extra_references;
+        if (pass.cancelled) {
+            break;
+        }
+
+        // Preview, every sample covers its block
+        for (int y = 0; block > 1 && y < view.height; y += block) {
+            const int last_y = std::min(y + block, view.height);
+            for (int x = 0; x < view.width; x += block) {
+                const float value = buffer.At(x, y);
+                const auto width =
+                    static_cast<std::size_t>(std::min(block, view.width - x));
+                for (int fill_y = y; fill_y < last_y; ++fill_y) {
+                    std::ranges::fill(buffer.Row(fill_y).subspan(
+                                          static_cast<std::size_t>(x), width),
+                                      value);
+                }
+            }
+        }
+
+        if (publish) {
+            publish(buffer, block);
+        }
+        if (block <= last_block_size) {
+            break;
+        }
+    }
+    stats.duration = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+RenderStats Engine::RenderResumable(const DeepViewport &view,
+                                    IterationBuffer &buffer,
+                                    ResumeState &state) {
+    if (!settings.fractal.IsPlainMandelbrot()) {
+        state.Clear();
+        return RenderFormula(view, buffer);
+    }
+    switch (ResolvePrecision(view.PixelWidth())) {
+    case Precision::Double:
+        return RenderOrbits<double>(view, buffer, state);
+    case Precision::DoubleDouble:
+        return RenderOrbits<DoubleDouble>(view, buffer, state);
+    default:
+        state.Clear();
+        return RenderPerturbation(view, buffer);
+    }
+}
+
+template <typename T>
+RenderStats Engine::RenderOrbits(const DeepViewport &view,
+                                 IterationBuffer &buffer, ResumeState &state) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto precision = std::is_same_v<T, double> ? Precision::Double
+                                                     : Precision::DoubleDouble;
+    const int max_iter = settings.max_iter;
+    const bool check_interior = settings.interior_check;
+    const double period_tolerance = view.PixelWidth() * PERIOD_TOLERANCE;
+
+    // Pixels are placed like in DoubleSpan() and DdSpan()
+    const auto double_view = view.ToViewport();
+    const auto center_x = DoubleDouble::FromBigFixed(view.center_x);
+    const auto center_y = DoubleDouble::FromBigFixed(view.center_y);
+    const auto pixel = [&](int x, int y) -> std::array<T, 2> {
+        if constexpr (std::is_same_v<T, double>) {
+            return {double_view.PixelX(x), double_view.PixelY(y)};
+        } else {
+            const double offset_x =
+                view.OffsetX(0) + (static_cast<double>(x) * view.PixelWidth());
+            return {center_x + offset_x, center_y + view.OffsetY(y)};
+        }
+    };
+    const auto to_double_double = [](const T &value) {
+        if constexpr (std::is_same_v<T, double>) {
+            return DoubleDouble(value);
+        } else {
+            return value;
+        }
+    };
+    const auto from_double_double = [](const DoubleDouble &value) {
+        if constexpr (std::is_same_v<T, double>) {
+            return value.hi;
+        } else {
+            return value;
+        }
+    };
+
+    const bool resume = state.max_iter > 0 && state.max_iter <= max_iter &&
+                        state.precision == precision &&
+                        state.escape == settings.escape &&
+                        SameView(state.view, view) &&
+                        buffer.GetWidth() == view.width &&
+                        buffer.GetHeight() == view.height;
+    RenderStats stats;
+    if (!resume) {
+        // Fresh frame, every pixel starts from z = 0 and undecided ones are
+        // collected per tile
+        buffer.Resize(view.width, view.height);
+        state.orbits.clear();
+        std::mutex orbits_mutex;
+        stats = RenderTiles(buffer, [&](const TileRect &tile) {
+            IterationCount count{};
+            std::vector<ResumeState::Orbit> undecided;
+            for (int y = tile.first_y; y < tile.last_y; ++y) {
+                for (int x = tile.first_x; x < tile.last_x; ++x) {
+                    const auto [c_x, c_y] = pixel(x, y);
+                    const auto orbit =
+                        ContinueOrbit(c_x, c_y, T{}, T{}, 0, false, max_iter,
+                                      settings.escape, check_interior,
+                                      period_tolerance);
+                    buffer.At(x, y) = SmoothIteration(
+                        orbit.iter, ScalarTraits<T>::ToDouble(orbit.z_x),
+                        ScalarTraits<T>::ToDouble(orbit.z_y), max_iter);
+                    count.iterations += static_cast<std::uint64_t>(orbit.iter);
+                    count.skipped += static_cast<std::uint64_t>(orbit.skipped);
+                    if (orbit.iter >= max_iter && !orbit.interior) {
+                        undecided.push_back(
+                            {.pixel = static_cast<std::uint32_t>(
+                                 PixelIndex(buffer, x, y)),
+                             .escaping = orbit.escaping,
+                             .z_x = to_double_double(orbit.z_x),
+                             .z_y = to_double_double(orbit.z_y)});
+                    }
+                }
+            }
+            const std::scoped_lock lock(orbits_mutex);
+            state.orbits.insert(state.orbits.end(), undecided.begin(),
+                                undecided.end());
+            return count;
+        });
+        std::ranges::sort(state.orbits, {}, &ResumeState::Orbit::pixel);
+    } else {
+        // Pixels at the old limit are interior or undecided, both are at the
+        // new limit until an undecided one escapes
+        const auto previous_limit = static_cast<float>(state.max_iter);
+        for (auto &value : buffer.Values()) {
+            if (value >= previous_limit) {
+                value = static_cast<float>(max_iter);
+            }
+        }
+
+        // Continue the kept orbits in chunks, every kept orbit is at the old
+        // limit
+        const auto width = static_cast<std::uint32_t>(view.width);
+        const std::size_t chunk_count =
+            (state.orbits.size() + RESUME_CHUNK_SIZE - 1) / RESUME_CHUNK_SIZE;
+        std::vector<std::uint8_t> decided(state.orbits.size(), 0);
+        std::atomic<std::uint64_t> iterations{0};
+        std::atomic<std::uint64_t> skipped{0};
+        std::atomic<std::uint64_t> cancelled{0};
+        stats.scheduling = scheduler->Run(
+            chunk_count, [&](std::size_t chunk, std::size_t /*worker*/) {
+                const auto first = chunk * RESUME_CHUNK_SIZE;
+                const auto last =
+                    std::min(first + RESUME_CHUNK_SIZE, state.orbits.size());
+                if (stop_token.stop_requested()) {
+                    cancelled.fetch_add(last - first,
+                                        std::memory_order_relaxed);
+                    return;
+                }
+                IterationCount count{};
+                for (auto i = first; i < last; ++i) {
+                    auto &kept = state.orbits[i];
+                    const auto x = static_cast<int>(kept.pixel % width);
+                    const auto y = static_cast<int>(kept.pixel / width);
+                    const auto [c_x, c_y] = pixel(x, y);
+                    const auto orbit = ContinueOrbit(
+                        c_x, c_y, from_double_double(kept.z_x),
+                        from_double_double(kept.z_y), state.max_iter,
+                        kept.escaping, max_iter, settings.escape,
+                        check_interior, period_tolerance);
+                    buffer.At(x, y) = SmoothIteration(
+                        orbit.iter, ScalarTraits<T>::ToDouble(orbit.z_x),
+                        ScalarTraits<T>::ToDouble(orbit.z_y), max_iter);
+                    count.iterations +=
+                        static_cast<std::uint64_t>(orbit.iter - state.max_iter);
+                    count.skipped += static_cast<std::uint64_t>(orbit.skipped);
+
+                    decided[i] = orbit.iter < max_iter || orbit.interior;
+                    kept.escaping = orbit.escaping;
+                    kept.z_x = to_double_double(orbit.z_x);
+                    kept.z_y = to_double_double(orbit.z_y);
+                }
+                iterations.fetch_add(count.iterations,
+                                     std::memory_order_relaxed);
+                skipped.fetch_add(count.skipped, std::memory_order_relaxed);
+            });
+        stats.pixels = state.orbits.size();
+        stats.iterations = iterations.load();
+        stats.skipped_iterations = skipped.load();
+        stats.cancelled_pixels = cancelled.load();
+        stats.cancelled = stats.cancelled_pixels != 0;
+
+        // Keep the orbits that are still undecided, in pixel order
+        std::size_t kept_count = 0;
+        for (std::size_t i = 0; i < state.orbits.size(); ++i) {
+            if (decided[i] == 0) {
+                state.orbits[kept_count++] = state.orbits[i];
+            }
+        }
+        state.orbits.resize(kept_count);
+    }
+
+    // NOTE: Orbits of a cancelled render stopped at different iterations, the
+    // next render starts over
+    if (stats.cancelled) {
+        state.Clear();
+        stats.precision = precision;
+        stats.duration = std::chrono::steady_clock::now() - start;
+        return stats;
+    }
+    state.view = view;
+    state.precision = precision;
+    state.max_iter = max_iter;
+    state.escape = settings.escape;
+    stats.precision = precision;
+    stats.duration = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+RenderStats Engine::RenderExpMap(const ExpMapView &view,
+                                 IterationBuffer &buffer) {
+    assert(settings.fractal.IsPlainMandelbrot());
+    const auto start = std::chrono::steady_clock::now();
+    buffer.Resize(view.width, view.height);
+
+    // Directions of the columns, the same in every row
+    std::vector<double> cos_angle(static_cast<std::size_t>(view.width));
+    std::vector<double> sin_angle(static_cast<std::size_t>(view.width));
+    for (int x = 0; x < view.width; ++x) {
+        cos_angle[static_cast<std::size_t>(x)] = std::cos(view.Angle(x));
+        sin_angle[static_cast<std::size_t>(x)] = std::sin(view.Angle(x));
+    }
+
+    // Rows from the first one double cannot resolve iterate as deltas from
+    // the center
+    int first_deep_row = 0;
+    while (first_deep_row < view.height &&
+           ResolvePrecision(view.Spacing(first_deep_row)) ==
+               Precision::Double) {
+        ++first_deep_row;
+    }
+    // Offset of a sample from the zoom center
+    const auto offset = [&](int x, int y) {
+        const double radius = view.Radius(y);
+        return PixelOffset{radius * cos_angle[static_cast<std::size_t>(x)],
+                           radius * sin_angle[static_cast<std::size_t>(x)]};
+    };
+    std::optional<PerturbationFrame> frame;
+    if (first_deep_row < view.height) {
+        const auto limbs =
+            std::max(view.center_x.GetFractionLimbs(), view.RequiredLimbs());
+        auto center_x = view.center_x.WithLimbs(limbs);
+        auto center_y = view.center_y.WithLimbs(limbs);
+        auto orbit = ReferenceOrbit::Compute(center_x, center_y,
+                                             settings.max_iter,
+                                             settings.escape, stop_token);
+        auto bla = BuildBla(orbit, view.Radius(first_deep_row));
+        frame.emplace(PerturbationFrame{
+            .limbs = limbs,
+            .center_x = std::move(center_x),
+            .center_y = std::move(center_y),
+            .orbit = std::move(orbit),
+            .bla = std::move(bla),
+            .glitched = std::vector<std::uint8_t>(buffer.GetSize(), 0)});
+    }
+
+    const double center_x = view.center_x.ToDouble();
+    const double center_y = view.center_y.ToDouble();
+    const int max_iter = settings.max_iter;
+    const SpanFunction render_span = [&](int y, int first_x, int last_x) {
+        const double period_tolerance = view.Spacing(y) * PERIOD_TOLERANCE;
+        const auto *bla =
+            frame.has_value() && frame->bla ? &*frame->bla : nullptr;
+        IterationCount count{};
+        for (int x = first_x; x < last_x; ++x) {
+            const auto dc = offset(x, y);
+            std::optional<EscapeResult> result;
+            if (y < first_deep_row) {
+                result = settings.interior_check
+                             ? EscapeTimeInterior(center_x + dc.x,
+                                                  center_y + dc.y, max_iter,
+                                                  settings.escape,
+                                                  period_tolerance)
+                             : EscapeTime(center_x + dc.x, center_y + dc.y,
+                                          max_iter, settings.escape);
+            } else {
+                result = PerturbEscapeTime(frame->orbit, bla, dc.x, dc.y,
+                                           max_iter, settings.escape,
+                                           settings.glitch_tolerance);
+            }
+            if (!result.has_value()) {
+                frame->glitched[PixelIndex(buffer, x, y)] = 1;
+                continue;
+            }
+            buffer.At(x, y) =
+                SmoothIteration(result->iter, result->z_x, result->z_y,
+                                max_iter);
+            count.iterations += static_cast<std::uint64_t>(result->iter);
+            count.skipped += static_cast<std::uint64_t>(result->skipped);
+        }
+        return count;
+    };
+    auto stats = RenderTiles(buffer, [&](const TileRect &tile) {
+        return RenderRows(tile, render_span);
+    });
+
+    // NOTE: Two samples of the deep rows are at most twice the radius of the
+    // first one apart
+    if (frame.has_value() && !stats.cancelled) {
+        CorrectGlitches(offset, 2.0 * view.Radius(first_deep_row), *frame,
+                        buffer, stats);
+    }
+    stats.precision = first_deep_row < view.height ? Precision::Perturbation
+                                                   : Precision::Double;
+    stats.duration = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+void Engine::Colorize(const IterationBuffer &buffer, const Palette &palette,
+                      float density, float offset,
+                      std::span<PackedColor> out) const {
+    assert(out.size() == buffer.GetSize());
+    const ColorizeParams params{
+        .palette = palette.GetColors(),
+        .max_iter = static_cast<float>(settings.max_iter),
+        .density = density,
+        .offset = offset,
+        .interior = PackColor(RGB{})};
+    colorize_kernel(params, buffer.Values(), out);
+}
+
+RenderStats Engine::RenderAntialiased(const DeepViewport &view,
+                                      IterationBuffer &buffer,
+                                      const Palette &palette, float density,
+                                      float offset, std::span<PackedColor> out,
+                                      const AntialiasSettings &antialias) {
+    const auto start = std::chrono::steady_clock::now();
+    auto stats = RenderDeep(view, buffer);
+    if (stats.cancelled) {
+        return stats;
+    }
+    Colorize(buffer, palette, density, offset, out);
+
+    // Pixels on edges, flat neighbourhoods keep their color
+    const int grid =
+        std::clamp(antialias.grid, 1, AntialiasSettings::GRID_MAX);
+    const auto edges =
+        grid > 1 ? FindEdges(view.width, view.height, out, antialias.threshold)
+                 : std::vector<std::size_t>{};
+    stats.antialiased_pixels = edges.size();
+    if (edges.empty()) {
+        stats.duration = std::chrono::steady_clock::now() - start;
+        return stats;
+    }
+
+    // Every sub-sample is rendered at the edge pixels of a view moved by
+    // less than a pixel, in the precision of the frame
+    // NOTE: Perturbation reuses one reference at the view center and shifts
+    // the pixel offsets instead
+    IterationBuffer samples(view.width, view.height);
+    const bool plain = settings.fractal.IsPlainMandelbrot();
+    std::optional<PerturbationFrame> frame;
+    if (plain && stats.precision == Precision::Perturbation) {
+        frame.emplace(PreparePerturbation(view, samples));
+    }
+    const auto limbs =
+        std::max(view.center_x.GetFractionLimbs(), view.RequiredLimbs());
+
+    // Sums of the red, green and blue components of the sub-samples of every
+    // edge pixel and their number
+    std::vector<float> values(edges.size());
+    std::vector<PackedColor> colors(edges.size());
+    std::vector<std::array<std::uint32_t, 4>> sums(edges.size());
+    const ColorizeParams params{
+        .palette = palette.GetColors(),
+        .max_iter = static_cast<float>(settings.max_iter),
+        .density = density,
+        .offset = offset,
+        .interior = PackColor(RGB{})};
+    for (const auto &[jitter_x, jitter_y] : JitterPattern(grid)) {
+        const double shift_x = jitter_x * view.PixelWidth();
+        const double shift_y = jitter_y * view.PixelHeight();
+        DeepViewport shifted = view;
+        shifted.center_x = view.center_x.WithLimbs(limbs) +
+                           BigFixed::FromDouble(shift_x, limbs);
+        shifted.center_y = view.center_y.WithLimbs(limbs) +
+                           BigFixed::FromDouble(shift_y, limbs);
+        const auto double_view = shifted.ToViewport();
+
+        SpanFunction render_span;
+        if (!plain) {
+            render_span = FormulaSpan(shifted, samples);
+        } else if (stats.precision == Precision::Double) {
+            render_span = DoubleSpan(double_view, samples);
+        } else if (stats.precision == Precision::DoubleDouble) {
+            render_span = DdSpan(shifted, samples);
+        } else {
+            render_span =
+                PerturbationSpan(view, samples, *frame, shift_x, shift_y);
+        }
+        const auto count = RenderPixels(edges, view.width, render_span);
+        stats.iterations += count.iterations;
+        stats.skipped_iterations += count.skipped;
+        stats.pixels += edges.size();
+
+        // Glitched sub-samples get extra references like a deep frame
+        // NOTE: The corrections replace the orbit, the next sub-samples
+        // still need the one at the view center
+        if (frame && std::ranges::any_of(edges, [&](std::size_t pixel) {
+                return frame->glitched[pixel] != 0;
+            })) {
+            PerturbationFrame corrections{.limbs = frame->limbs,
+                                          .center_x = frame->center_x,
+                                          .center_y = frame->center_y,
+                                          .orbit = frame->orbit,
+                                          .bla = frame->bla,
+                                          .glitched = {}};
+            std::swap(corrections.glitched, frame->glitched);
+            const auto offset = [&](int x, int y) {
+                return PixelOffset{view.OffsetX(x) + shift_x,
+                                   view.OffsetY(y) + shift_y};
+            };
+            RenderStats corrected;
+            CorrectGlitches(offset, std::hypot(view.span_x, view.span_y),
+                            corrections, samples, corrected);
+            std::swap(corrections.glitched, frame->glitched);
+            stats.iterations += corrected.iterations;
+            stats.skipped_iterations += corrected.skipped_iterations;
+            stats.glitched_pixels += corrected.glitched_pixels;
+            stats.extra_references += corrected.extra_references;
+        }
+
+        // NOTE: A cancelled frame keeps the colors of the single samples
+        if (stop_token.stop_requested()) {
+            stats.cancelled = true;
+            stats.duration = std::chrono::steady_clock::now() - start;
+            return stats;
+        }
+
+        for (std::size_t i = 0; i < edges.size(); ++i) {
+            values[i] = samples.Values()[edges[i]];
+        }
+        colorize_kernel(params, values, colors);
+        for (std::size_t i = 0; i < edges.size(); ++i) {
+            // NOTE: Samples no reference resolved are left out
+            if (frame && frame->glitched[edges[i]] != 0) {
+                frame->glitched[edges[i]] = 0;
+                continue;
+            }
+            const auto color =
+                std::bit_cast<std::array<std::uint8_t, 4>>(colors[i]);
+            sums[i][0] += color[0];
+            sums[i][1] += color[1];
+            sums[i][2] += color[2];
+            ++sums[i][3];
+        }
+    }
+
+    // Average of the sub-samples, rounded to the nearest component
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        const auto count = sums[i][3];
+        if (count == 0) {
+            continue;
+        }
+        const auto average = [&](std::size_t component) {
+            return static_cast<std::uint8_t>(
+                (sums[i][component] + (count / 2)) / count);
+        };
+        out[edges[i]] = std::bit_cast<PackedColor>(std::array<std::uint8_t, 4>{
+            average(0), average(1), average(2), 255});
+    }
+    stats.duration = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+Precision Engine::ResolvePrecision(double spacing) const {
+    if (settings.precision == Precision::Auto) {
+        return AutoPrecision(spacing);
+    }
+    return settings.precision;
+}
+
+RenderStats Engine::RenderDouble(const Viewport &view,
+                                 IterationBuffer &buffer) {
+    buffer.Resize(view.width, view.height);
+    const std::array<TileRect, 1> whole{{{.first_x = 0,
+                                          .first_y = 0,
+                                          .last_x = view.width,
+                                          .last_y = view.height}}};
+    return RenderDouble(view, buffer, whole);
+}
+
+RenderStats Engine::RenderDouble(const Viewport &view, IterationBuffer &buffer,
+                                 std::span<const TileRect> regions) {
+    const auto render_span = DoubleSpan(view, buffer);
+    auto stats = RenderTiles(regions, [&](const TileRect &tile) {
+        return RenderTile(tile, buffer, render_span);
+    });
+    stats.precision = Precision::Double;
+    return stats;
+}
+
+Engine::SpanFunction Engine::DoubleSpan(const Viewport &view,
+                                        IterationBuffer &buffer) const {
+    return [this, &view, &buffer](int y, int first_x, int last_x) {
+        const RowParams params{
+            .origin_x = view.OriginX(),
+            .step_x = view.PixelWidth(),
+            .first_x = first_x,
+            .c_y = view.PixelY(y),
+            .max_iter = settings.max_iter,
+            .escape = settings.escape,
+            .check_interior = settings.interior_check,
+            .period_tolerance = view.PixelWidth() * PERIOD_TOLERANCE};
+        auto row = buffer.Row(y).subspan(
+            static_cast<std::size_t>(first_x),
+            static_cast<std::size_t>(last_x - first_x));
+        return row_kernel(params, row);
+    };
+}
+
+RenderStats Engine::RenderDoubleDouble(const DeepViewport &view,
+                                       IterationBuffer &buffer) {
+    buffer.Resize(view.width, view.height);
+    const auto render_span = DdSpan(view, buffer);
+    auto stats = RenderTiles(buffer, [&](const TileRect &tile) {
+        return RenderTile(tile, buffer, render_span);
+    });
+    stats.precision = Precision::DoubleDouble;
+    return stats;
+}
+
+RenderStats Engine::RenderFormula(const DeepViewport &view,
+                                  IterationBuffer &buffer) {
+    buffer.Resize(view.width, view.height);
+    const auto render_span = FormulaSpan(view, buffer);
+    auto stats = RenderTiles(buffer, [&](const TileRect &tile) {
+        return RenderRows(tile, render_span);
+    });
+    stats.precision = FormulaPrecision();
+    return stats;
+}
+
+Precision Engine::FormulaPrecision() const {
+    // NOTE: Float and fixed-point frames report Precision::Double
+    return settings.fractal.scalar == Scalar::DoubleDouble
+               ? Precision::DoubleDouble
+               : Precision::Double;
+}
+
+RenderStats Engine::RenderPerturbation(const DeepViewport &view,
+                                       IterationBuffer &buffer) {
+    const auto start = std::chrono::steady_clock::now();
+    buffer.Resize(view.width, view.height);
+
+    auto frame = PreparePerturbation(view, buffer);
+    const auto render_span = PerturbationSpan(view, buffer, frame);
+    auto stats = RenderTiles(buffer, [&](const TileRect &tile) {
+        return RenderRows(tile, render_span);
+    });
+    CorrectGlitches(view, frame, buffer, stats);
+
+    // Include the reference orbits in the frame time
+    stats.precision = Precision::Perturbation;
+    stats.duration = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+Engine::PerturbationFrame
+Engine::PreparePerturbation(const DeepViewport &view,
+                            const IterationBuffer &buffer) const {
+    // Reference orbit at the view center, with enough precision for the zoom
+    const auto limbs =
+        std::max(view.center_x.GetFractionLimbs(), view.RequiredLimbs());
+    auto center_x = view.center_x.WithLimbs(limbs);
+    auto center_y = view.center_y.WithLimbs(limbs);
+    auto orbit = ReferenceOrbit::Compute(center_x, center_y, settings.max_iter,
+                                         settings.escape, stop_token);
+    auto bla = BuildBla(orbit, std::hypot(view.span_x, view.span_y));
+    return {.limbs = limbs,
+            .center_x = std::move(center_x),
+            .center_y = std::move(center_y),
+            .orbit = std::move(orbit),
+            .bla = std::move(bla),
+            .glitched = std::vector<std::uint8_t>(buffer.GetSize(), 0)};
+}
+
+Engine::SpanFunction
+Engine::PerturbationSpan(const DeepViewport &view, IterationBuffer &buffer,
+                         PerturbationFrame &frame, double shift_x,
+                         double shift_y) const {
+    return [this, &view, &buffer, &frame, shift_x,
+            shift_y](int y, int first_x, int last_x) {
+        const auto *bla = frame.bla ? &*frame.bla : nullptr;
+        const double dc_y = view.OffsetY(y) + shift_y;
+        IterationCount count{};
+        for (int x = first_x; x < last_x; ++x) {
+            auto result = PerturbEscapeTime(
+                frame.orbit, bla, view.OffsetX(x) + shift_x, dc_y,
+                settings.max_iter, settings.escape,
+                settings.glitch_tolerance);
+            // NOTE: Glitched pixels still get the value of their delta
+            // rebased onto the same reference, so a frame whose glitches are
+            // not corrected holds no stale values
+            if (!result.has_value()) {
+                frame.glitched[PixelIndex(buffer, x, y)] = 1;
+                result = PerturbEscapeTime(
+                    frame.orbit, bla, view.OffsetX(x) + shift_x, dc_y,
+                    settings.max_iter, settings.escape, 0.0);
+            }
+            // A reference escaping on its first point cannot be rebased
+            if (!result.has_value()) {
+                buffer.At(x, y) = static_cast<float>(settings.max_iter);
+                continue;
+            }
+            buffer.At(x, y) = SmoothIteration(result->iter, result->z_x,
+                                              result->z_y, settings.max_iter);
+            count.iterations += static_cast<std::uint64_t>(result->iter);
+            count.skipped += static_cast<std::uint64_t>(result->skipped);
+        }
+        return count;
+    };
+}
+
+void Engine::CorrectGlitches(const DeepViewport &view,
+                             PerturbationFrame &frame, IterationBuffer &buffer,
+                             RenderStats &stats) {
+    // Any reference inside the view is at most a diagonal away from a pixel
+    const auto offset = [&view](int x, int y) {
+        return PixelOffset{view.OffsetX(x), view.OffsetY(y)};
+    };
+    CorrectGlitches(offset, std::hypot(view.span_x, view.span_y), frame,
+                    buffer, stats);
+}
+
+void Engine::CorrectGlitches(const OffsetFunction &offset, double dc_max,
+                             PerturbationFrame &frame, IterationBuffer &buffer,
+                             RenderStats &stats) {
+    auto &glitched = frame.glitched;
+    stats.glitched_pixels = static_cast<std::uint64_t>(std::ranges::count(
+        glitched, static_cast<std::uint8_t>(1)));
+
+    // Re-render glitched pixels with new references placed inside them, the
+    // largest glitched region first
+    PixelOffset reference_dc{0.0, 0.0};
+    for (auto region = LargestGlitchRegion(buffer, glitched); !region.empty();
+         region = LargestGlitchRegion(buffer, glitched)) {
+        // Cancelled, the frame is dropped anyway
+        if (stop_token.stop_requested()) {
+            stats.cancelled = true;
+            break;
+        }
+        const auto *bla = frame.bla ? &*frame.bla : nullptr;
+        IterationCount count{};
+
+        // Out of references, the remaining glitches are rebased onto the
+        // last reference
+        if (stats.extra_references >=
+            static_cast<std::uint64_t>(settings.max_references)) {
+            std::vector<std::size_t> remaining;
+            for (std::size_t i = 0; i < glitched.size(); ++i) {
+                if (glitched[i] != 0) {
+                    remaining.push_back(i);
+                }
+            }
+            count = RenderDeepPixels(offset, frame.orbit, bla, reference_dc.x,
+                                     reference_dc.y, remaining, 0.0, buffer,
+                                     glitched);
+            stats.iterations += count.iterations;
+            stats.skipped_iterations += count.skipped;
+            break;
+        }
+
+        const auto reference = GlitchRegionCenter(buffer, region);
+        const auto width = static_cast<std::size_t>(buffer.GetWidth());
+        reference_dc = offset(static_cast<int>(reference % width),
+                              static_cast<int>(reference / width));
+        frame.orbit = ReferenceOrbit::Compute(
+            frame.center_x + BigFixed::FromDouble(reference_dc.x, frame.limbs),
+            frame.center_y + BigFixed::FromDouble(reference_dc.y, frame.limbs),
+            settings.max_iter, settings.escape, stop_token);
+        frame.bla = BuildBla(frame.orbit, dc_max);
+        bla = frame.bla ? &*frame.bla : nullptr;
+        ++stats.extra_references;
+
+        count = RenderDeepPixels(offset, frame.orbit, bla, reference_dc.x,
+                                 reference_dc.y, region,
+                                 settings.glitch_tolerance, buffer, glitched);
+        stats.iterations += count.iterations;
+        stats.skipped_iterations += count.skipped;
+    }
+}
+
+std::optional<BlaTable> Engine::BuildBla(const ReferenceOrbit &orbit,
+                                         double dc_max) const {
+    if (!settings.bla) {
+        return std::nullopt;
+    }
+    return BlaTable::Build(orbit, dc_max, settings.bla_epsilon);
+}
+
+IterationCount Engine::RenderDeepPixels(
+    const OffsetFunction &offset, const ReferenceOrbit &orbit,
+    const BlaTable *bla, double reference_dc_x, double reference_dc_y,
+    std::span<const std::size_t> pixels, double glitch_tolerance,
+    IterationBuffer &buffer, std::vector<std::uint8_t> &glitched) {
+    // Pixels are handed out in chunks, glitched regions are small
+    constexpr std::size_t chunk_size = 256;
+    const auto chunk_count = (pixels.size() + chunk_size - 1) / chunk_size;
+    const int width = buffer.GetWidth();
+
+    std::atomic<std::uint64_t> iterations{0};
+    std::atomic<std::uint64_t> skipped{0};
+    scheduler->Run(chunk_count, [&](std::size_t chunk, std::size_t) {
+        if (stop_token.stop_requested()) {
+            return;
+        }
+        IterationCount count{};
+        const auto chunk_pixels = pixels.subspan(
+            chunk * chunk_size,
+            std::min(chunk_size, pixels.size() - (chunk * chunk_size)));
+        for (const auto pixel : chunk_pixels) {
+            const int x = static_cast<int>(pixel) % width;
+            const int y = static_cast<int>(pixel) / width;
+            const auto dc = offset(x, y);
+            const auto result = PerturbEscapeTime(
+                orbit, bla, dc.x - reference_dc_x, dc.y - reference_dc_y,
+                settings.max_iter, settings.escape, glitch_tolerance);
+            if (!result.has_value()) {
+                continue;
+            }
+            glitched[pixel] = 0;
+            buffer.At(x, y) = SmoothIteration(
+                result->iter, result->z_x, result->z_y, settings.max_iter);
+            count.iterations += static_cast<std::uint64_t>(result->iter);
+            count.skipped += static_cast<std::uint64_t>(result->skipped);
+        }
+        iterations.fetch_add(count.iterations, std::memory_order_relaxed);
+        skipped.fetch_add(count.skipped, std::memory_order_relaxed);
+    });
+    return {.iterations = iterations.load(), .skipped = skipped.load()};
+}
+
+IterationCount Engine::RenderPixels(std::span<const std::size_t> pixels,
+                                    int width,
+                                    const SpanFunction &render_span) {
+    // Pixels are handed out in chunks, edges are scattered over the frame
+    constexpr std::size_t chunk_size = 256;
+    const auto chunk_count = (pixels.size() + chunk_size - 1) / chunk_size;
+
+    std::atomic<std::uint64_t> iterations{0};
+    std::atomic<std::uint64_t> skipped{0};
+    scheduler->Run(chunk_count, [&](std::size_t chunk, std::size_t) {
+        if (stop_token.stop_requested()) {
+            return;
+        }
+        IterationCount count{};
+        const auto chunk_pixels = pixels.subspan(
+            chunk * chunk_size,
+            std::min(chunk_size, pixels.size() - (chunk * chunk_size)));
+        for (const auto pixel : chunk_pixels) {
+            const int x = static_cast<int>(pixel % static_cast<std::size_t>(
+                                                       width));
+            const int y = static_cast<int>(pixel / static_cast<std::size_t>(
+                                                       width));
+            count += render_span(y, x, x + 1);
+        }
+        iterations.fetch_add(count.iterations, std::memory_order_relaxed);
+        skipped.fetch_add(count.skipped, std::memory_order_relaxed);
+    });
+    return {.iterations = iterations.load(), .skipped = skipped.load()};
+}
+
+std::vector<std::size_t>
+Engine::FindEdges(int width, int height, std::span<const PackedColor> colors,
+                  float threshold) const {
+    // Variance of every channel from the sums of the components and of their
+    // squares, the neighbourhood is clipped at the frame border
+    constexpr float max_component = 255.0F;
+    constexpr float channels = 3.0F;
+    std::vector<std::uint8_t> edge(colors.size(), 0);
+    scheduler->Run(
+        static_cast<std::size_t>(height), [&](std::size_t row, std::size_t) {
+            const int y = static_cast<int>(row);
+            const int first_y = std::max(y - 1, 0);
+            const int last_y = std::min(y + 1, height - 1);
+            for (int x = 0; x < width; ++x) {
+                const int first_x = std::max(x - 1, 0);
+                const int last_x = std::min(x + 1, width - 1);
+                std::array<std::uint32_t, 3> sum{};
+                std::array<std::uint32_t, 3> square_sum{};
+                for (int n_y = first_y; n_y <= last_y; ++n_y) {
+                    for (int n_x = first_x; n_x <= last_x; ++n_x) {
+                        const auto color =
+                            std::bit_cast<std::array<std::uint8_t, 4>>(
+                                colors[(static_cast<std::size_t>(n_y) *
+                                        static_cast<std::size_t>(width)) +
+                                       static_cast<std::size_t>(n_x)]);
+                        for (std::size_t c = 0; c < sum.size(); ++c) {
+                            sum[c] += color[c];
+                            square_sum[c] += std::uint32_t{color[c]} * color[c];
+                        }
+                    }
+                }
+                const auto count = static_cast<std::uint32_t>(
+                    (last_x - first_x + 1) * (last_y - first_y + 1));
+                std::uint32_t spread = 0;
+                for (std::size_t c = 0; c < sum.size(); ++c) {
+                    spread += (count * square_sum[c]) - (sum[c] * sum[c]);
+                }
+                const float variance =
+                    static_cast<float>(spread) /
+                    (static_cast<float>(count * count) * max_component *
+                     max_component * channels);
+                if (variance > threshold) {
+                    edge[(static_cast<std::size_t>(y) *
+                          static_cast<std::size_t>(width)) +
+                         static_cast<std::size_t>(x)] = 1;
+                }
+            }
+        });
+
+    std::vector<std::size_t> edges;
+    for (std::size_t i = 0; i < edge.size(); ++i) {
+        if (edge[i] != 0) {
+            edges.push_back(i);
+        }
+    }
+    return edges;
+}
+
+RenderStats Engine::RenderTiles(IterationBuffer &buffer,
+                                const TileFunction &render_tile) {
+    const std::array<TileRect, 1> whole{{{.first_x = 0,
+                                          .first_y = 0,
+                                          .last_x = buffer.GetWidth(),
+                                          .last_y = buffer.GetHeight()}}};
+    return RenderTiles(whole, render_tile);
+}
+
+RenderStats Engine::RenderTiles(std::span<const TileRect> regions,
+                                const TileFunction &render_tile) {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Interior tiles cost up to max_iter times more than exterior ones, so
+    // idle workers steal tiles from the busy ones
+    const int tile_size = settings.tile_size;
+    std::vector<TileRect> tiles;
+    std::uint64_t pixels = 0;
+    for (const auto &region : regions) {
+        for (int y = region.first_y; y < region.last_y; y += tile_size) {
+            for (int x = region.first_x; x < region.last_x; x += tile_size) {
+                tiles.push_back(
+                    {.first_x = x,
+                     .first_y = y,
+                     .last_x = std::min(x + tile_size, region.last_x),
+                     .last_y = std::min(y + tile_size, region.last_y)});
+            }
+        }
+        pixels += static_cast<std::uint64_t>(
+                      std::max(region.last_x - region.first_x, 0)) *
+                  static_cast<std::uint64_t>(
+                      std::max(region.last_y - region.first_y, 0));
+    }
+
+    // NOTE: Tiles of a cancelled render are skipped, so the render stops
+    // once the running tiles are done
+    std::atomic<std::uint64_t> iterations{0};
+    std::atomic<std::uint64_t> skipped{0};
+    std::atomic<std::uint64_t> cancelled{0};
+    auto scheduling = scheduler->Run(
+        tiles.size(), [&](std::size_t index, std::size_t /*worker*/) {
+            const auto &tile = tiles[index];
+            if (stop_token.stop_requested()) {
+                cancelled.fetch_add(
+                    static_cast<std::uint64_t>(tile.last_x - tile.first_x) *
+                        static_cast<std::uint64_t>(tile.last_y - tile.first_y),
+                    std::memory_order_relaxed);
+                return;
+            }
+            const auto count = render_tile(tile);
+            iterations.fetch_add(count.iterations, std::memory_order_relaxed);
+            skipped.fetch_add(count.skipped, std::memory_order_relaxed);
+        });
+
+    RenderStats stats;
+    stats.duration = std::chrono::steady_clock::now() - start;
+    stats.pixels = pixels;
+    stats.iterations = iterations.load();
+    stats.skipped_iterations = skipped.load();
+    stats.cancelled_pixels = cancelled.load();
+    stats.cancelled = stats.cancelled_pixels != 0;
+    stats.scheduling = std::move(scheduling);
+    return stats;
+}
+
+Engine::SpanFunction Engine::DdSpan(const DeepViewport &view,
+                                    IterationBuffer &buffer) const {
+    return [this, &view, &buffer,
+            center_x = DoubleDouble::FromBigFixed(view.center_x),
+            center_y = DoubleDouble::FromBigFixed(view.center_y)](
+               int y, int first_x, int last_x) {
+        const DdRowParams params{
+            .center_x = center_x,
+            .offset_x = view.OffsetX(0),
+            .step_x = view.PixelWidth(),
+            .first_x = first_x,
+            .c_y = center_y + view.OffsetY(y),
+            .max_iter = settings.max_iter,
+            .escape = settings.escape,
+            .check_interior = settings.interior_check,
+            .period_tolerance = view.PixelWidth() * PERIOD_TOLERANCE};
+        auto row = buffer.Row(y).subspan(
+            static_cast<std::size_t>(first_x),
+            static_cast<std::size_t>(last_x - first_x));
+        return dd_row_kernel(params, row);
+    };
+}
+
+Engine::SpanFunction Engine::FormulaSpan(const DeepViewport &view,
+                                         IterationBuffer &buffer) const {
+    return [this, &view, &buffer,
+            center_x = DoubleDouble::FromBigFixed(view.center_x),
+            center_y = DoubleDouble::FromBigFixed(view.center_y)](
+               int y, int first_x, int last_x) {
+        const FormulaRowParams params{
+            .center_x = center_x,
+            .offset_x = view.OffsetX(0),
+            .step_x = view.PixelWidth(),
+            .first_x = first_x,
+            .c_y = center_y + view.OffsetY(y),
+            .julia_x = settings.fractal.julia_x,
+            .julia_y = settings.fractal.julia_y,
+            .max_iter = settings.max_iter,
+            .escape = settings.escape};
+        auto row = buffer.Row(y).subspan(
+            static_cast<std::size_t>(first_x),
+            static_cast<std::size_t>(last_x - first_x));
+        return formula_kernel(params, row);
+    };
+}
+
+IterationCount Engine::RenderRows(const TileRect &tile,
+                                  const SpanFunction &render_span) {
+    IterationCount count{};
+    for (int y = tile.first_y; y < tile.last_y; ++y) {
+        count += render_span(y, tile.first_x, tile.last_x);
+    }
+    return count;
+}
+
+IterationCount Engine::RenderTile(const TileRect &tile,
+                                  IterationBuffer &buffer,
+                                  const SpanFunction &render_span) const {
+    // Tiles without an inside are only border
+    const bool subdivide = settings.render_mode == RenderMode::MarianiSilver &&
+                           tile.last_x - tile.first_x >= 3 &&
+                           tile.last_y - tile.first_y >= 3;
+    if (!subdivide) {
+        return RenderRows(tile, render_span);
+    }
+
+    IterationCount count{};
+    count += render_span(tile.first_y, tile.first_x, tile.last_x);
+    count += render_span(tile.last_y - 1, tile.first_x, tile.last_x);
+    for (int y = tile.first_y + 1; y < tile.last_y - 1; ++y) {
+        count += render_span(y, tile.first_x, tile.first_x + 1);
+        count += render_span(y, tile.last_x - 1, tile.last_x);
+    }
+    count += Subdivide(tile, buffer, render_span);
+    return count;
+}
+
+IterationCount Engine::Subdivide(const TileRect &rect, IterationBuffer &buffer,
+                                 const SpanFunction &render_span) {
+    // Smallest inside split further, smaller ones are rendered pixel by pixel
+    constexpr int min_inside = 4;
+    const int inside_width = rect.last_x - rect.first_x - 2;
+    const int inside_height = rect.last_y - rect.first_y - 2;
+    IterationCount count{};
+    if (inside_width <= 0 || inside_height <= 0) {
+        return count;
+    }
+
+    const float value = buffer.At(rect.first_x, rect.first_y);
+    bool uniform = true;
+    for (int x = rect.first_x; x < rect.last_x && uniform; ++x) {
+        uniform = buffer.At(x, rect.first_y) == value &&
+                  buffer.At(x, rect.last_y - 1) == value;
+    }
+    for (int y = rect.first_y + 1; y < rect.last_y - 1 && uniform; ++y) {
+        uniform = buffer.At(rect.first_x, y) == value &&
+                  buffer.At(rect.last_x - 1, y) == value;
+    }
+
+    if (uniform) {
+        for (int y = rect.first_y + 1; y < rect.last_y - 1; ++y) {
+            std::ranges::fill(buffer.Row(y).subspan(
+                                  static_cast<std::size_t>(rect.first_x + 1),
+                                  static_cast<std::size_t>(inside_width)),
+                              value);
+        }
+        // NOTE: Filled pixels count as iterated to the value of the border,
+        // exact for interior borders at max_iter
+        const auto filled = static_cast<std::uint64_t>(inside_width) *
+                            static_cast<std::uint64_t>(inside_height);
+        const auto iterations = filled * static_cast<std::uint64_t>(value);
+        count.iterations += iterations;
+        count.skipped += iterations;
+        return count;
+    }
+
+    if (inside_width < min_inside || inside_height < min_inside) {
+        for (int y = rect.first_y + 1; y < rect.last_y - 1; ++y) {
+            count += render_span(y, rect.first_x + 1, rect.last_x - 1);
+        }
+        return count;
+    }
+
+    // Render the line splitting the longer side, it is the shared border of
+    // both halves
+    TileRect first = rect;
+    TileRect second = rect;
+    if (inside_width >= inside_height) {
+        const int split_x = rect.first_x + 1 + (inside_width / 2);
+        for (int y = rect.first_y + 1; y < rect.last_y - 1; ++y) {
+            count += render_span(y, split_x, split_x + 1);
+        }
+        first.last_x = split_x + 1;
+        second.first_x = split_x;
+    } else {
+        const int split_y = rect.first_y + 1 + (inside_height / 2);
+        count += render_span(split_y, rect.first_x + 1, rect.last_x - 1);
+        first.last_y = split_y + 1;
+        second.first_y = split_y;
+    }
+    count += Subdivide(first, buffer, render_span);
+    count += Subdivide(second, buffer, render_span);
+    return count;
+}
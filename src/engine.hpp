@@ -0,0 +1,468 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "big_fixed.hpp"
+#include "bla.hpp"
+#include "double_double.hpp"
+#include "enum_list.hpp"
+#include "formula.hpp"
+#include "iteration_buffer.hpp"
+#include "kernels.hpp"
+#include "palette.hpp"
+#include "perturbation.hpp"
+#include "resample.hpp"
+#include "tile_cache.hpp"
+#include "tile_store.hpp"
+#include "tile_scheduler.hpp"
+#include "viewport.hpp"
+
+// Arithmetic used to iterate the pixels
+enum class Precision : std::uint8_t {
+#define X(name, str) name,
+    PRECISION_LIST(X)
+#undef X
+};
+
+// Number of precisions
+constexpr std::size_t PRECISION_COUNT{0 PRECISION_LIST(X_ENUM_COUNT)};
+
+// Precisions as strings
+constexpr std::array<std::string_view, PRECISION_COUNT> PRECISION_STR{
+#define X(name, str) str,
+    PRECISION_LIST(X)
+#undef X
+};
+
+// Way the pixels of a tile are computed
+enum class RenderMode : std::uint8_t {
+#define X(name, str) name,
+    RENDER_MODE_LIST(X)
+#undef X
+};
+
+// Number of render modes
+constexpr std::size_t RENDER_MODE_COUNT{0 RENDER_MODE_LIST(X_ENUM_COUNT)};
+
+// Render modes as strings
+constexpr std::array<std::string_view, RENDER_MODE_COUNT> RENDER_MODE_STR{
+#define X(name, str) str,
+    RENDER_MODE_LIST(X)
+#undef X
+};
+
+// Smallest pixel spacing rendered with each precision in Precision::Auto
+// NOTE: Both keep about 10 bits below the pixel spacing for |c| <= 2, 52 and
+// 104 bits of mantissa
+constexpr double DOUBLE_MIN_SPACING = 0x1p-42;
+constexpr double DOUBLE_DOUBLE_MIN_SPACING = 0x1p-94;
+
+// Precision chosen by Precision::Auto for the pixel spacing
+[[nodiscard]] constexpr Precision AutoPrecision(double spacing) {
+    if (spacing >= DOUBLE_MIN_SPACING) {
+        return Precision::Double;
+    }
+    if (spacing >= DOUBLE_DOUBLE_MIN_SPACING) {
+        return Precision::DoubleDouble;
+    }
+    return Precision::Perturbation;
+}
+
+// Settings of the CPU rendering engine
+struct EngineSettings {
+    // Iteration limit and squared escape radius, maxIter and escapeVal in
+    // mandelbrot_set.frag
+    int max_iter{50};
+    double escape{4.0};
+    // Formula and scalar type of the iteration, anything but the plain
+    // Mandelbrot set uses the templated formula kernels
+    FractalSettings fractal{};
+    // Number of worker threads, 0 uses all hardware threads
+    std::size_t thread_count{0};
+    // Instruction set of the kernel, the widest supported one when empty
+    std::optional<Isa> isa{};
+    // Arithmetic of the kernel, Auto picks the cheapest one resolving the
+    // pixel spacing
+    Precision precision{Precision::Auto};
+    // Side of the square tiles handed out to the worker threads
+    int tile_size{64};
+    // MarianiSilver computes only the borders of rectangles inside a tile and
+    // fills rectangles with a uniform border, plain Mandelbrot set in double
+    // and double-double only
+    RenderMode render_mode{RenderMode::BruteForce};
+    // Deep zoom glitch detection, see PerturbEscapeTime()
+    double glitch_tolerance{1e-3};
+    // Extra reference orbits per frame used to correct glitched pixels
+    int max_references{64};
+    // Skip deep zoom iterations with bilinear approximation, bla_epsilon is
+    // the relative error allowed per skipped step
+    bool bla{true};
+    double bla_epsilon{1e-12};
+    // Stop interior points early with the cardioid and bulb test and with
+    // periodicity detection, not used by perturbation
+    bool interior_check{true};
+};
+
+// Adaptive anti-aliasing of Engine::RenderAntialiased()
+struct AntialiasSettings {
+    // Largest side of the sub-sample grid
+    static constexpr int GRID_MAX = 8;
+
+    // Edge pixels are split into grid x grid cells with one jittered
+    // sub-sample each, 1 turns anti-aliasing off
+    int grid{4};
+    // Variance of the colors of the 3x3 neighbourhood above which a pixel is
+    // supersampled, components in [0, 1] averaged over red, green and blue
+    float threshold{0.001F};
+};
+
+// Statistics of a single rendered frame
+struct RenderStats {
+    std::chrono::nanoseconds duration{};
+    std::uint64_t pixels{};
+    std::uint64_t iterations{};
+    // Arithmetic used for the frame
+    Precision precision{Precision::Double};
+    // Busy and idle time of every worker thread
+    SchedulerStats scheduling;
+    // Deep zoom pixels the main reference could not resolve and references
+    // added to re-render them
+    std::uint64_t glitched_pixels{};
+    std::uint64_t extra_references{};
+    // Iterations skipped instead of computed by BLA or by the interior
+    // checks, included in iterations
+    std::uint64_t skipped_iterations{};
+    // The render was stopped by the stop token of the engine, the buffer is
+    // incomplete and cancelled_pixels of the pixels were never rendered
+    bool cancelled{false};
+    std::uint64_t cancelled_pixels{};
+    // Pixels RenderAntialiased() colored from sub-samples, the sub-samples
+    // are included in pixels
+    std::uint64_t antialiased_pixels{};
+};
+
+// Orbits of the pixels a resumable render left undecided, see
+// Engine::RenderResumable()
+// NOTE: Only pixels that reached max_iter without being proven interior are
+// kept, so the state is much smaller than the frame
+struct ResumeState {
+    // Last z of one undecided pixel, every kept orbit is at max_iter
+    // NOTE: Double precision frames keep z in hi. The escape check lags one
+    // step behind, escaping orbits ended on a z past the escape radius and
+    // stop at max_iter once the limit is raised
+    struct Orbit {
+        std::uint32_t pixel;
+        bool escaping;
+        DoubleDouble z_x;
+        DoubleDouble z_y;
+    };
+
+    // Frame the orbits belong to, max_iter is 0 while no frame is kept
+    DeepViewport view;
+    Precision precision{Precision::Double};
+    int max_iter{0};
+    double escape{0.0};
+    // Ordered by pixel index
+    std::vector<Orbit> orbits;
+
+    // Forget the frame, the next resumable render starts from z = 0
+    void Clear() {
+        max_iter = 0;
+        orbits.clear();
+    }
+
+    [[nodiscard]] std::size_t GetMemoryUsage() const noexcept {
+        return orbits.size() * sizeof(Orbit);
+    }
+};
+
+// Headless CPU renderer computing the smooth iteration value of every pixel
+// NOTE: Does not depend on the App or on a raylib window
+class Engine {
+  public:
+    explicit Engine(EngineSettings settings = {});
+
+    // Render the viewport into the buffer, the buffer is resized to the
+    // viewport size
+    // NOTE: Views zoomed past double precision continue as a deep zoom
+    RenderStats Render(const Viewport &view, IterationBuffer &buffer);
+
+    // Render a view with a high precision center in the precision picked by
+    // the settings
+    // NOTE: Formulas other than the plain Mandelbrot set use the precision of
+    // their scalar type
+    RenderStats RenderDeep(const DeepViewport &view, IterationBuffer &buffer);
+
+    // Render the view into the buffer holding the frame of the previous view,
+    // when the view is the previous one moved by whole pixels only the newly
+    // exposed strips are rendered
+    // NOTE: Everything else, including views past double precision and
+    // formulas, renders the full frame
+    RenderStats RenderPan(const Viewport &previous, const Viewport &view,
+                          IterationBuffer &buffer);
+
+    // Render the pending pixels of a frame seeded by ResampleFrame() and clear
+    // their flags, rows are refined in interleaved passes until the time
+    // budget is used up
+    // NOTE: At least one pass is rendered per call, views the double kernel
+    // cannot render are rendered in full
+    RenderStats RenderPending(const Viewport &view, IterationBuffer &buffer,
+                              PendingMask &pending,
+                              std::chrono::nanoseconds budget);
+
+    // Render a view aligned to the tile pyramid, tiles found in the cache or
+    // in the optional store are copied and missing ones are rendered and
+    // added to both
+    // NOTE: Views off the pyramid grid and views past double precision are
+    // rendered without the cache, see SnapToPyramid()
+    RenderStats RenderCached(const Viewport &view, IterationBuffer &buffer,
+                             TileCache &cache, TileStore *store = nullptr);
+
+    // Function receiving the buffer after every pass of a progressive render,
+    // block_size is the side of the blocks sharing one sample
+    using PublishFunction =
+        std::function<void(const IterationBuffer &buffer, int block_size)>;
+
+    // Render coarse to fine in passes of 8x8, 4x4 and 2x2 blocks and single
+    // pixels, publishing the buffer after every pass
+    // NOTE: Every pass only renders samples no earlier pass rendered, the
+    // last pass leaves the same frame as RenderDeep()
+    // NOTE: Passes stop after the first one with blocks of at most
+    // last_block_size, the default renders every pass
+    RenderStats RenderProgressive(const DeepViewport &view,
+                                  IterationBuffer &buffer,
+                                  const PublishFunction &publish,
+                                  int last_block_size = 1);
+
+    // Render the view and keep the orbits of its undecided pixels in the
+    // state, when the state holds the same view with a lower or equal
+    // iteration limit only those orbits are continued
+    // NOTE: The frame is the one RenderDeep() renders without Mariani-Silver,
+    // pixels are iterated one by one to keep their orbits. Formulas and
+    // perturbation views render in full and clear the state
+    RenderStats RenderResumable(const DeepViewport &view,
+                                IterationBuffer &buffer, ResumeState &state);
+
+    // Render a band of the log-polar strip of a zoom into the center of the
+    // view, see ExpMapView
+    // NOTE: Plain Mandelbrot set only. Rows past double precision iterate
+    // against a reference orbit at the zoom center, the point every row
+    // surrounds, glitched samples get extra references like in RenderDeep()
+    RenderStats RenderExpMap(const ExpMapView &view, IterationBuffer &buffer);
+
+    // Color every pixel of a rendered buffer with the palette, interior
+    // pixels are black, see ColorizeParams for density and offset
+    // NOTE: A single lookup pass, palette swaps and cycling only repeat this
+    // instead of rendering again
+    void Colorize(const IterationBuffer &buffer, const Palette &palette,
+                  float density, float offset,
+                  std::span<PackedColor> out) const;
+
+    // Render the view at one sample per pixel and color it like Colorize(),
+    // pixels whose neighbourhood colors vary more than the threshold are
+    // colored again from the average of jittered sub-samples
+    // NOTE: Only the set boundary and steep gradients are supersampled, flat
+    // regions keep their single sample. Perturbation sub-samples the
+    // reference at the view center cannot resolve get extra references, the
+    // stats count them as glitched pixels
+    RenderStats RenderAntialiased(const DeepViewport &view,
+                                  IterationBuffer &buffer,
+                                  const Palette &palette, float density,
+                                  float offset, std::span<PackedColor> out,
+                                  const AntialiasSettings &antialias = {});
+
+    // Precision used for views with the pixel spacing
+    [[nodiscard]] Precision ResolvePrecision(double spacing) const;
+
+    // Iteration limit of the following renders, e.g. lowered by the
+    // FrameGovernor for expensive views
+    void SetMaxIter(int max_iter) noexcept { settings.max_iter = max_iter; }
+
+    // Token cancelling the following renders, workers check it between tiles
+    // and reference orbits every ReferenceOrbit::STOP_INTERVAL iterations
+    // NOTE: Cancelled renders return early with RenderStats::cancelled set,
+    // the buffer holds a partial frame
+    void SetStopToken(std::stop_token token) noexcept {
+        stop_token = std::move(token);
+    }
+
+    // Getters
+    [[nodiscard]] const EngineSettings &GetSettings() const noexcept {
+        return settings;
+    }
+    [[nodiscard]] std::size_t GetThreadCount() const noexcept {
+        return scheduler->GetThreadCount();
+    }
+    [[nodiscard]] Isa GetIsa() const noexcept { return isa; }
+
+  private:
+    EngineSettings settings;
+    // Kernel chosen for the host at construction
+    Isa isa;
+    RowKernel row_kernel;
+    DdRowKernel dd_row_kernel;
+    FormulaRowKernel formula_kernel;
+    ColorizeKernel colorize_kernel;
+    // Worker threads, kept alive between frames
+    std::unique_ptr<TileScheduler> scheduler;
+    // Cancels renders when a stop is requested, see SetStopToken()
+    std::stop_token stop_token;
+
+    // Pixel bounds of a tile, last values are exclusive
+    struct TileRect {
+        int first_x;
+        int first_y;
+        int last_x;
+        int last_y;
+    };
+    // Function rendering a tile
+    using TileFunction = std::function<IterationCount(const TileRect &tile)>;
+    // Function rendering the pixels [first_x, last_x) of row y
+    using SpanFunction =
+        std::function<IterationCount(int y, int first_x, int last_x)>;
+
+    // Split the buffer into tiles and render them on all threads
+    RenderStats RenderTiles(IterationBuffer &buffer,
+                            const TileFunction &render_tile);
+    // Split the regions of the buffer into tiles and render them on all
+    // threads, stats count the pixels of the regions
+    RenderStats RenderTiles(std::span<const TileRect> regions,
+                            const TileFunction &render_tile);
+
+    // Render with the double precision row kernel
+    RenderStats RenderDouble(const Viewport &view, IterationBuffer &buffer);
+    // Render only the regions of the buffer, which is already sized for the
+    // view
+    RenderStats RenderDouble(const Viewport &view, IterationBuffer &buffer,
+                             std::span<const TileRect> regions);
+
+    // Render with the double-double row kernel, good to about 1e-30
+    RenderStats RenderDoubleDouble(const DeepViewport &view,
+                                   IterationBuffer &buffer);
+
+    // Render with perturbation, one high precision reference orbit is
+    // computed at the view center and every pixel is iterated as a double
+    // precision delta from it
+    RenderStats RenderPerturbation(const DeepViewport &view,
+                                   IterationBuffer &buffer);
+
+    // Render with the formula kernel of the fractal settings
+    RenderStats RenderFormula(const DeepViewport &view,
+                              IterationBuffer &buffer);
+    // Precision reported for frames of the formula kernel
+    [[nodiscard]] Precision FormulaPrecision() const;
+
+    // RenderResumable() in double or double-double arithmetic
+    template <typename T>
+    RenderStats RenderOrbits(const DeepViewport &view,
+                             IterationBuffer &buffer, ResumeState &state);
+
+    // Reference orbit of a perturbation frame and the pixels it could not
+    // resolve
+    struct PerturbationFrame {
+        std::size_t limbs;
+        BigFixed center_x;
+        BigFixed center_y;
+        ReferenceOrbit orbit;
+        std::optional<BlaTable> bla;
+        std::vector<std::uint8_t> glitched;
+    };
+
+    // Reference orbit at the view center, with enough precision for the zoom
+    [[nodiscard]] PerturbationFrame
+    PreparePerturbation(const DeepViewport &view,
+                        const IterationBuffer &buffer) const;
+
+    // Span function iterating pixels against the reference of the frame,
+    // flags glitched pixels and gives them their rebased value, see
+    // CorrectGlitches()
+    // NOTE: The shift moves every sample off the pixel center, see
+    // RenderAntialiased()
+    [[nodiscard]] SpanFunction PerturbationSpan(const DeepViewport &view,
+                                                IterationBuffer &buffer,
+                                                PerturbationFrame &frame,
+                                                double shift_x = 0.0,
+                                                double shift_y = 0.0) const;
+
+    // Offset of a pixel from the center of the frame, the dc of
+    // PerturbEscapeTime()
+    struct PixelOffset {
+        double x;
+        double y;
+    };
+    using OffsetFunction = std::function<PixelOffset(int x, int y)>;
+
+    // Re-render glitched pixels of the frame with extra references
+    void CorrectGlitches(const DeepViewport &view, PerturbationFrame &frame,
+                         IterationBuffer &buffer, RenderStats &stats);
+    // Same for pixels at any offsets, e.g. the rows of an exponential map
+    // NOTE: dc_max bounds the distance of a pixel from a reference placed
+    // inside the buffer
+    void CorrectGlitches(const OffsetFunction &offset, double dc_max,
+                         PerturbationFrame &frame, IterationBuffer &buffer,
+                         RenderStats &stats);
+
+    // BLA table for the orbit when enabled, valid for pixels up to dc_max
+    // from the reference
+    [[nodiscard]] std::optional<BlaTable>
+    BuildBla(const ReferenceOrbit &orbit, double dc_max) const;
+
+    // Iterate the listed deep zoom pixels against a reference placed at the
+    // given offset from the frame center, clears the flags of resolved
+    // pixels
+    IterationCount RenderDeepPixels(const OffsetFunction &offset,
+                                    const ReferenceOrbit &orbit,
+                                    const BlaTable *bla, double reference_dc_x,
+                                    double reference_dc_y,
+                                    std::span<const std::size_t> pixels,
+                                    double glitch_tolerance,
+                                    IterationBuffer &buffer,
+                                    std::vector<std::uint8_t> &glitched);
+
+    // Span functions of the row kernels
+    // NOTE: The view and buffer must outlive the function
+    [[nodiscard]] SpanFunction DoubleSpan(const Viewport &view,
+                                          IterationBuffer &buffer) const;
+    [[nodiscard]] SpanFunction DdSpan(const DeepViewport &view,
+                                      IterationBuffer &buffer) const;
+    [[nodiscard]] SpanFunction FormulaSpan(const DeepViewport &view,
+                                           IterationBuffer &buffer) const;
+
+    // Render the listed pixels of a buffer of the width on all threads
+    IterationCount RenderPixels(std::span<const std::size_t> pixels, int width,
+                                const SpanFunction &render_span);
+
+    // Indices of the pixels whose 3x3 neighbourhood has a color variance
+    // above the threshold, see AntialiasSettings
+    [[nodiscard]] std::vector<std::size_t>
+    FindEdges(int width, int height, std::span<const PackedColor> colors,
+              float threshold) const;
+
+    // Render every row of the tile as one span
+    static IterationCount RenderRows(const TileRect &tile,
+                                     const SpanFunction &render_span);
+
+    // Render a single tile span by span in the render mode of the settings
+    IterationCount RenderTile(const TileRect &tile, IterationBuffer &buffer,
+                              const SpanFunction &render_span) const;
+
+    // Mariani-Silver subdivision of a rectangle whose border is rendered,
+    // fills the inside when the border has a single value and splits the
+    // rectangle in two otherwise
+    // NOTE: The Mandelbrot set is full, a closed curve inside it only
+    // encloses points of the set, so filled interior pixels are exact
+    static IterationCount Subdivide(const TileRect &rect,
+                                    IterationBuffer &buffer,
+                                    const SpanFunction &render_span);
+};
@@ -10,11 +10,121 @@
     X(Height, "height")                                                        \
     X(Fps, "fps")
 
+// Macro defining all fractal options, the whole table is optional
+#define FRACTAL_OPTION_LIST(X)                                                 \
+    X(Formula, "formula")                                                      \
+    X(Scalar, "scalar")                                                        \
+    X(Power, "power")                                                          \
+    X(JuliaX, "julia_x")                                                       \
+    X(JuliaY, "julia_y")
+
+// Macro defining all options of the render table, the whole table is optional
+#define RENDER_OPTION_LIST(X)                                                  \
+    X(MaxIter, "max_iter")                                                     \
+    X(TileCache, "tile_cache")                                                 \
+    X(TileStore, "tile_store")                                                 \
+    X(TileStoreSize, "tile_store_size")
+
 // Macro defining all shader types
 #define SHADER_TYPE_LIST(X)                                                    \
     X(Vertex, "vertex")                                                        \
     X(Fragment, "fragment")
 
+// Macro defining all instruction sets with an escape-time kernel
+// NOTE: Ordered from the narrowest to the widest vectors
+#define ISA_LIST(X)                                                            \
+    X(Scalar, "scalar")                                                        \
+    X(Sse2, "sse2")                                                            \
+    X(Avx2, "avx2")                                                            \
+    X(Avx512, "avx512")
+
+// Macro defining all arithmetic used by the CPU engine
+// NOTE: Ordered from the shallowest to the deepest zooms
+#define PRECISION_LIST(X)                                                      \
+    X(Auto, "auto")                                                            \
+    X(Double, "double")                                                        \
+    X(DoubleDouble, "double_double")                                           \
+    X(Perturbation, "perturbation")
+
+// Macro defining all ways the CPU engine covers a tile with pixels
+#define RENDER_MODE_LIST(X)                                                    \
+    X(BruteForce, "brute_force")                                               \
+    X(MarianiSilver, "mariani_silver")
+
+// Macro defining all options of the palette table, the whole table is optional
+#define PALETTE_OPTION_LIST(X)                                                 \
+    X(Type, "type")                                                            \
+    X(Size, "size")                                                            \
+    X(Saturation, "saturation")                                                \
+    X(Value, "value")                                                          \
+    X(Colors, "colors")                                                        \
+    X(Density, "density")                                                      \
+    X(Offset, "offset")
+
+// Macro defining all ways a palette is generated at runtime
+#define PALETTE_TYPE_LIST(X)                                                   \
+    X(Hsv, "hsv")                                                              \
+    X(Gradient, "gradient")
+
+// Macro defining all fractal formulas of the CPU engine
+#define FORMULA_LIST(X)                                                        \
+    X(Mandelbrot, "mandelbrot")                                                \
+    X(Julia, "julia")                                                          \
+    X(Multibrot, "multibrot")                                                  \
+    X(BurningShip, "burning_ship")
+
+// Macro defining all scalar types the formula kernels are instantiated for
+#define SCALAR_LIST(X)                                                         \
+    X(Float, "float")                                                          \
+    X(Double, "double")                                                        \
+    X(DoubleDouble, "double_double")                                           \
+    X(Fixed, "fixed")
+
+// Macro defining all options of the output table of a batch job
+#define BATCH_OUTPUT_OPTION_LIST(X)                                            \
+    X(Directory, "directory")                                                  \
+    X(Prefix, "prefix")                                                        \
+    X(Format, "format")                                                        \
+    X(Width, "width")                                                          \
+    X(Height, "height")                                                        \
+    X(Frames, "frames")                                                        \
+    X(ExpMap, "exp_map")
+
+// Macro defining all options of a keyframe of a batch job
+#define KEYFRAME_OPTION_LIST(X)                                                \
+    X(Frame, "frame")                                                          \
+    X(CenterX, "center_x")                                                     \
+    X(CenterY, "center_y")                                                     \
+    X(Zoom, "zoom")                                                            \
+    X(MaxIter, "max_iter")
+
+// Macro defining all image formats written by the batch renderer, the names
+// are the file extensions
+#define IMAGE_FORMAT_LIST(X)                                                   \
+    X(Png, "png")                                                              \
+    X(Bmp, "bmp")                                                              \
+    X(Tga, "tga")                                                              \
+    X(Qoi, "qoi")
+
+// Macro defining all stages of the batch pipeline, in the order frames pass
+// them
+#define BATCH_STAGE_LIST(X)                                                    \
+    X(Compute, "compute")                                                      \
+    X(Colorize, "colorize")                                                    \
+    X(Encode, "encode")
+
+// Macro defining all options of the [poster] table of a poster job
+#define POSTER_OPTION_LIST(X)                                                  \
+    X(File, "file")                                                            \
+    X(Width, "width")                                                          \
+    X(Height, "height")                                                        \
+    X(StripHeight, "strip_height")                                             \
+    X(CenterX, "center_x")                                                     \
+    X(CenterY, "center_y")                                                     \
+    X(Zoom, "zoom")                                                            \
+    X(MaxIter, "max_iter")                                                     \
+    X(Antialias, "antialias")
+
 // Macro defining all error codes types
 #define ERROR_CODE_LIST(X)                                                     \
     /* Referenced file does not exist */                                       \
@@ -24,7 +134,11 @@
     /* Required configuration option is missing */                             \
     X(MissingOption, "MissingOption")                                          \
     /* Configuration value is outside the allowed range */                     \
-    X(InvalidValue, "InvalidValue")
+    X(InvalidValue, "InvalidValue")                                            \
+    /* Tile store file could not be created, mapped or read */                 \
+    X(StoreError, "StoreError")                                                \
+    /* Output image could not be written */                                    \
+    X(WriteError, "WriteError")
 
 // Macro used to count number of elements in a list
 // NOTE: Expands each element to +1, sum gives total count
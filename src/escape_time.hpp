@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cmath>
+
+// Source: https://en.wikipedia.org/wiki/Plotting_algorithms_for_the_Mandelbrot_set
+
+// Result of iterating a single point
+struct EscapeResult {
+    int iter;
+    double z_x;
+    double z_y;
+    // Iterations included in iter that were skipped instead of computed
+    int skipped{0};
+};
+
+// Optimized escape algorithm
+// NOTE: Same operations in the same order as mandelbrot_set.frag
+inline EscapeResult EscapeTime(double c_x, double c_y, int max_iter,
+                               double escape) {
+    double z_x = 0.0;
+    double z_y = 0.0;
+    double z2_x = 0.0;
+    double z2_y = 0.0;
+
+    int iter = 0;
+    while (z2_x + z2_y <= escape && iter < max_iter) {
+        z2_x = z_x * z_x;
+        z2_y = z_y * z_y;
+        z_y = 2.0 * z_x * z_y + c_y;
+        z_x = z2_x - z2_y + c_x;
+        iter++;
+    }
+
+    return {iter, z_x, z_y};
+}
+
+// Whether the point is inside the main cardioid or the period-2 bulb, where
+// every orbit stays bounded
+inline bool InCardioidOrBulb(double c_x, double c_y) {
+    const double x = c_x - 0.25;
+    const double y2 = c_y * c_y;
+    const double q = (x * x) + y2;
+    if (q * (q + x) <= 0.25 * y2) {
+        return true;
+    }
+    const double bulb_x = c_x + 1.0;
+    return (bulb_x * bulb_x) + y2 <= 0.0625;
+}
+
+// EscapeTime() stopping early for interior points, which return max_iter
+// like EscapeTime() with the iterations not computed in skipped
+// NOTE: The orbit is compared with a point saved at every power of two
+// iterations (Brent), returning closer than period_tolerance means it is
+// periodic and never escapes
+inline EscapeResult EscapeTimeInterior(double c_x, double c_y, int max_iter,
+                                       double escape,
+                                       double period_tolerance) {
+    if (InCardioidOrBulb(c_x, c_y)) {
+        return {max_iter, 0.0, 0.0, max_iter};
+    }
+
+    double z_x = 0.0;
+    double z_y = 0.0;
+    double z2_x = 0.0;
+    double z2_y = 0.0;
+    double saved_x = 0.0;
+    double saved_y = 0.0;
+    int next_save = 1;
+
+    int iter = 0;
+    while (z2_x + z2_y <= escape && iter < max_iter) {
+        z2_x = z_x * z_x;
+        z2_y = z_y * z_y;
+        z_y = 2.0 * z_x * z_y + c_y;
+        z_x = z2_x - z2_y + c_x;
+        iter++;
+
+        if (std::fabs(z_x - saved_x) < period_tolerance &&
+            std::fabs(z_y - saved_y) < period_tolerance) {
+            return {max_iter, z_x, z_y, max_iter - iter};
+        }
+        if (iter == next_save) {
+            saved_x = z_x;
+            saved_y = z_y;
+            next_save *= 2;
+        }
+    }
+
+    return {iter, z_x, z_y};
+}
+
+// Smooth iteration value with the same nu smoothing as mandelbrot_set.frag
+// NOTE: Points that never escape store max_iter, the shader clamps them to 1.0
+// power is the exponent of z in the formula
+inline float SmoothIteration(int iter, double z_x, double z_y, int max_iter,
+                             double power = 2.0) {
+    if (iter >= max_iter) {
+        return static_cast<float>(max_iter);
+    }
+
+    // Linear interpolation
+    const double log_zn = std::log(z_x * z_x + z_y * z_y) / 2.0;
+    const double nu = std::log(log_zn / std::log(2.0)) / std::log(power);
+    return static_cast<float>(static_cast<double>(iter) + 1.0 - nu);
+}
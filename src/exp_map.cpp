@@ -0,0 +1,224 @@
+#include "exp_map.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <utility>
+
+#include "raylib-cpp.hpp"
+
+#include "batch_job.hpp"
+#include "engine.hpp"
+#include "iteration_buffer.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Add the counters of a band to the stats of a frame
+void AddBand(RenderStats &stats, const RenderStats &band) {
+    stats.pixels += band.pixels;
+    stats.iterations += band.iterations;
+    stats.skipped_iterations += band.skipped_iterations;
+    stats.glitched_pixels += band.glitched_pixels;
+    stats.extra_references += band.extra_references;
+    stats.precision = band.precision;
+    stats.cancelled = stats.cancelled || band.cancelled;
+    stats.cancelled_pixels += band.cancelled_pixels;
+}
+}  // namespace
+
+ExpMapZoom::ExpMapZoom(const BatchJob &job) : job(job) {
+    assert(job.IsExpMap());
+    const int width = job.GetWidth();
+    const int height = job.GetHeight();
+
+    // One sample per pixel around the circle through the frame corners
+    const double corner =
+        std::hypot(static_cast<double>(width) / 2.0,
+                   static_cast<double>(height) / 2.0);
+    samples = static_cast<int>(std::ceil(2.0 * std::numbers::pi * corner));
+    step = 2.0 * std::numbers::pi / static_cast<double>(samples);
+    band_rows = std::max(samples / BAND_ROWS_DIVISOR, BAND_ROWS_MIN);
+
+    // Row 0 lies just outside the corners of the widest frame
+    // NOTE: Every keyframe has the same center, the deepest one has the
+    // most precise digits
+    const auto &keyframes = job.GetKeyframes();
+    const auto &widest = std::ranges::min(keyframes, {}, &Keyframe::zoom);
+    const auto &deepest = std::ranges::max(keyframes, {}, &Keyframe::zoom);
+    const double widest_spacing =
+        Viewport::DEFAULT_SPAN_X / widest.zoom / static_cast<double>(width);
+    strip = ExpMapView{.center_x = deepest.center_x,
+                       .center_y = deepest.center_y,
+                       .radius = corner * widest_spacing * std::exp(step),
+                       .width = samples,
+                       .height = band_rows};
+
+    // Strip position of every pixel, the distance to the center in pixels
+    // gives the row and the direction gives the column
+    // NOTE: Pixels closer than half a pixel to the center share one row
+    const auto pixel_count =
+        static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    pixel_rows.resize(pixel_count);
+    pixel_columns.resize(pixel_count);
+    for (int y = 0; y < height; ++y) {
+        const double dy =
+            static_cast<double>(y) + 0.5 - (static_cast<double>(height) / 2.0);
+        for (int x = 0; x < width; ++x) {
+            const double dx = static_cast<double>(x) + 0.5 -
+                              (static_cast<double>(width) / 2.0);
+            const double distance = std::max(std::hypot(dx, dy), 0.5);
+            double angle = std::atan2(dy, dx);
+            if (angle < 0.0) {
+                angle += 2.0 * std::numbers::pi;
+            }
+            const double column = std::fmod(angle / step,
+                                            static_cast<double>(samples));
+            const auto index = (static_cast<std::size_t>(y) *
+                                static_cast<std::size_t>(width)) +
+                               static_cast<std::size_t>(x);
+            pixel_rows[index] = static_cast<float>(-std::log(distance) / step);
+            pixel_columns[index] = static_cast<float>(column);
+        }
+    }
+    first_pixel_row = std::ranges::min(pixel_rows);
+    last_pixel_row = std::ranges::max(pixel_rows);
+
+    const double window_rows =
+        static_cast<double>(last_pixel_row - first_pixel_row) +
+        (2.0 * static_cast<double>(band_rows));
+    TraceLog(LOG_INFO,
+             "MANDELBROT_SET: Exponential map of %d samples around, %d rows "
+             "per band, about %.0f MiB of bands per frame",
+             samples, band_rows,
+             window_rows * static_cast<double>(samples) *
+                 static_cast<double>(sizeof(float)) / (1024.0 * 1024.0));
+}
+
+RenderStats ExpMapZoom::RenderFrame(Engine &engine, int frame,
+                                    IterationBuffer &buffer) {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Rows of the strip the frame covers, plus one for the interpolation
+    const double base_row = FrameRow(frame);
+    const int first_row = std::max(
+        static_cast<int>(std::floor(base_row + first_pixel_row)), 0);
+    const int last_row =
+        static_cast<int>(std::floor(base_row + last_pixel_row)) + 1;
+    auto stats =
+        UpdateBands(engine, first_row / band_rows, last_row / band_rows);
+    if (stats.cancelled) {
+        stats.duration = std::chrono::steady_clock::now() - start;
+        return stats;
+    }
+
+    // Interpolate between the four samples around every pixel
+    // NOTE: Interior samples are not blended with escaping ones, that would
+    // smear the boundary, the nearest sample is taken instead
+    const auto interior = static_cast<float>(job.GetPeakMaxIter());
+    buffer.Resize(job.GetWidth(), job.GetHeight());
+    const auto values = buffer.Values();
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const double row = std::clamp(base_row + pixel_rows[i],
+                                      static_cast<double>(first_row),
+                                      static_cast<double>(last_row));
+        const int row0 = std::min(static_cast<int>(row), last_row - 1);
+        const auto row_t = static_cast<float>(row - row0);
+        const auto column = pixel_columns[i];
+        const int column0 = std::min(static_cast<int>(column), samples - 1);
+        const int column1 = column0 + 1 == samples ? 0 : column0 + 1;
+        const float column_t = column - static_cast<float>(column0);
+
+        const float top_left = Sample(row0, column0);
+        const float top_right = Sample(row0, column1);
+        const float bottom_left = Sample(row0 + 1, column0);
+        const float bottom_right = Sample(row0 + 1, column1);
+        if (std::max({top_left, top_right, bottom_left, bottom_right}) >=
+            interior) {
+            values[i] = Sample(row_t < 0.5F ? row0 : row0 + 1,
+                               column_t < 0.5F ? column0 : column1);
+            continue;
+        }
+        const float top = std::lerp(top_left, top_right, column_t);
+        const float bottom = std::lerp(bottom_left, bottom_right, column_t);
+        values[i] = std::lerp(top, bottom, row_t);
+    }
+
+    stats.duration = std::chrono::steady_clock::now() - start;
+    return stats;
+}
+
+double ExpMapZoom::FrameRow(int frame) const {
+    return std::log(strip.radius / job.FrameView(frame).PixelWidth()) / step;
+}
+
+RenderStats ExpMapZoom::UpdateBands(Engine &engine, int first_index,
+                                    int last_index) {
+    // Recycle the bands the frame left
+    const auto recycle = [this](Band &band) {
+        spare_values.push_back(std::move(band.values));
+    };
+    while (!bands.empty() && bands.front().index < first_index) {
+        recycle(bands.front());
+        bands.pop_front();
+    }
+    while (!bands.empty() && bands.back().index > last_index) {
+        recycle(bands.back());
+        bands.pop_back();
+    }
+
+    // Grow the kept bands in both directions, a zoom only grows inwards
+    RenderStats stats{};
+    const auto add_band = [&](int index, bool at_front) {
+        Band band{.index = index, .values = {}};
+        if (!spare_values.empty()) {
+            band.values = std::move(spare_values.back());
+            spare_values.pop_back();
+        }
+        AddBand(stats, RenderBand(engine, index, band));
+        // NOTE: A cancelled band holds a partial render and is dropped
+        if (stats.cancelled) {
+            recycle(band);
+            return false;
+        }
+        if (at_front) {
+            bands.push_front(std::move(band));
+        } else {
+            bands.push_back(std::move(band));
+        }
+        return true;
+    };
+    if (bands.empty() && !add_band(first_index, false)) {
+        return stats;
+    }
+    while (bands.front().index > first_index) {
+        if (!add_band(bands.front().index - 1, true)) {
+            return stats;
+        }
+    }
+    while (bands.back().index < last_index) {
+        if (!add_band(bands.back().index + 1, false)) {
+            return stats;
+        }
+    }
+    return stats;
+}
+
+RenderStats ExpMapZoom::RenderBand(Engine &engine, int index, Band &band) {
+    // NOTE: Samples are shared by frames of different iteration limits, so
+    // the strip is iterated up to the highest one
+    ExpMapView view = strip;
+    view.radius =
+        strip.radius * std::exp(-step * static_cast<double>(index) *
+                                static_cast<double>(band_rows));
+    engine.SetMaxIter(job.GetPeakMaxIter());
+    return engine.RenderExpMap(view, band.values);
+}
+
+float ExpMapZoom::Sample(int row, int column) const {
+    const auto &band = bands[static_cast<std::size_t>(
+        (row / band_rows) - bands.front().index)];
+    return band.values.At(column, row % band_rows);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "batch_job.hpp"
+#include "engine.hpp"
+#include "iteration_buffer.hpp"
+#include "viewport.hpp"
+
+// Frames of a zoom video remapped from the log-polar strip of the zoom
+// center, see ExpMapView
+// NOTE: Consecutive frames of a zoom share almost all of their points. The
+// strip samples every radius once, with one sample per pixel at the frame
+// corners, so the cost of a video is the cost of the strip and each frame
+// is only a lookup into it
+class ExpMapZoom {
+  public:
+    // Rows of a band relative to the samples around the circle
+    static constexpr int BAND_ROWS_DIVISOR = 16;
+    static constexpr int BAND_ROWS_MIN = 16;
+
+    // NOTE: The job must be an exponential map job and outlive the zoom
+    explicit ExpMapZoom(const BatchJob &job);
+
+    // Render the bands of the strip the frame needs and remap the frame into
+    // the buffer, bands no longer needed are recycled
+    // NOTE: Every band is rendered once while the zoom goes one way, the
+    // stats count the samples of the bands rendered for this frame
+    RenderStats RenderFrame(Engine &engine, int frame, IterationBuffer &buffer);
+
+    // Getters
+    [[nodiscard]] int GetSamples() const noexcept { return samples; }
+    [[nodiscard]] int GetBandRows() const noexcept { return band_rows; }
+    [[nodiscard]] std::size_t GetBandCount() const noexcept {
+        return bands.size();
+    }
+
+  private:
+    const BatchJob &job;
+    // Strip around the zoom center, row 0 is outside every frame corner
+    ExpMapView strip;
+    int samples;
+    int band_rows;
+    double step;
+
+    // Row and column of every frame pixel, rows are relative to the row
+    // whose spacing is the pixel spacing of the frame
+    // NOTE: Frames share one pixel grid, only the zoom moves them along the
+    // rows
+    std::vector<float> pixel_rows;
+    std::vector<float> pixel_columns;
+    float first_pixel_row;
+    float last_pixel_row;
+
+    // Rendered band of rows [index * band_rows, (index + 1) * band_rows)
+    struct Band {
+        int index;
+        IterationBuffer values;
+    };
+    // Consecutive bands, ordered by index
+    std::deque<Band> bands;
+    std::vector<IterationBuffer> spare_values;
+
+    // Row of the strip whose spacing is the pixel spacing of the frame
+    [[nodiscard]] double FrameRow(int frame) const;
+
+    // Keep the bands [first_index, last_index] and render the missing ones
+    RenderStats UpdateBands(Engine &engine, int first_index, int last_index);
+    // Render one band into recycled storage
+    RenderStats RenderBand(Engine &engine, int index, Band &band);
+
+    // Value of a strip sample, the row must be in a kept band
+    [[nodiscard]] float Sample(int row, int column) const;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+#include "double_double.hpp"
+
+// Signed fixed-point number with 7 integer and 56 fraction bits
+// NOTE: Results saturate instead of wrapping, so escaping orbits stay outside
+// the escape radius, the range is about +-128
+struct Fixed64 {
+    static constexpr int FRACTION_BITS = 56;
+    static constexpr double ONE = 0x1p56;
+    static constexpr auto MAX = std::numeric_limits<std::int64_t>::max();
+    static constexpr auto MIN = std::numeric_limits<std::int64_t>::min();
+
+    std::int64_t raw{};
+
+    // Fixed-point number rounded toward zero, saturated to the range
+    static constexpr Fixed64 FromDouble(double value) {
+        const double scaled = value * ONE;
+        if (scaled >= 0x1p63) {
+            return {MAX};
+        }
+        if (scaled < -0x1p63) {
+            return {MIN};
+        }
+        return {static_cast<std::int64_t>(scaled)};
+    }
+    static constexpr Fixed64 FromDoubleDouble(const DoubleDouble &value) {
+        return FromDouble(value.hi) + FromDouble(value.lo);
+    }
+
+    [[nodiscard]] constexpr double ToDouble() const {
+        return static_cast<double>(raw) / ONE;
+    }
+
+    friend constexpr Fixed64 operator+(Fixed64 a, Fixed64 b) {
+        std::int64_t sum = 0;
+        if (__builtin_add_overflow(a.raw, b.raw, &sum)) {
+            return {a.raw < 0 ? MIN : MAX};
+        }
+        return {sum};
+    }
+
+    friend constexpr Fixed64 operator-(Fixed64 a) {
+        return {a.raw == MIN ? MAX : -a.raw};
+    }
+
+    friend constexpr Fixed64 operator-(Fixed64 a, Fixed64 b) {
+        return a + (-b);
+    }
+
+    friend constexpr Fixed64 operator*(Fixed64 a, Fixed64 b) {
+        // NOTE: __extension__ silences the pedantic warning about __int128
+        __extension__ using Int128 = __int128;
+        const Int128 product =
+            (static_cast<Int128>(a.raw) * b.raw) >> FRACTION_BITS;
+        if (product > MAX) {
+            return {MAX};
+        }
+        if (product < MIN) {
+            return {MIN};
+        }
+        return {static_cast<std::int64_t>(product)};
+    }
+};
@@ -0,0 +1,60 @@
+#include "formula.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <utility>
+
+#include "double_double.hpp"
+#include "fixed_point.hpp"
+
+namespace {
+// Number of instantiated Multibrot exponents
+constexpr std::size_t POWER_COUNT = static_cast<std::size_t>(
+    FractalSettings::MAX_POWER - FractalSettings::MIN_POWER + 1);
+
+// Multibrot kernels of the scalar type, indexed by power - MIN_POWER
+template <typename T, int... offsets>
+constexpr std::array<FormulaRowKernel, POWER_COUNT>
+GenMultibrotKernels(std::integer_sequence<int, offsets...> /*offsets*/) {
+    return {&EscapeRowFormula<
+        T, MultibrotFormula<FractalSettings::MIN_POWER + offsets>>...};
+}
+
+// Kernels of the scalar type
+template <typename T> struct ScalarKernels {
+    static constexpr auto MULTIBROT = GenMultibrotKernels<T>(
+        std::make_integer_sequence<int, static_cast<int>(POWER_COUNT)>{});
+
+    static FormulaRowKernel Select(Formula formula, int power) {
+        switch (formula) {
+        case Formula::Mandelbrot:
+            return &EscapeRowFormula<T, MandelbrotFormula>;
+        case Formula::Julia:
+            return &EscapeRowFormula<T, JuliaFormula>;
+        case Formula::Multibrot:
+            return MULTIBROT.at(static_cast<std::size_t>(
+                power - FractalSettings::MIN_POWER));
+        case Formula::BurningShip:
+            return &EscapeRowFormula<T, BurningShipFormula>;
+        }
+        return &EscapeRowFormula<T, MandelbrotFormula>;
+    }
+};
+}  // namespace
+
+FormulaRowKernel SelectFormulaKernel(const FractalSettings &fractal) {
+    const int power = std::clamp(fractal.power, FractalSettings::MIN_POWER,
+                                 FractalSettings::MAX_POWER);
+    switch (fractal.scalar) {
+    case Scalar::Float:
+        return ScalarKernels<float>::Select(fractal.formula, power);
+    case Scalar::Double:
+        return ScalarKernels<double>::Select(fractal.formula, power);
+    case Scalar::DoubleDouble:
+        return ScalarKernels<DoubleDouble>::Select(fractal.formula, power);
+    case Scalar::Fixed:
+        return ScalarKernels<Fixed64>::Select(fractal.formula, power);
+    }
+    return ScalarKernels<double>::Select(fractal.formula, power);
+}
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "double_double.hpp"
+#include "enum_list.hpp"
+#include "escape_time.hpp"
+#include "fixed_point.hpp"
+#include "kernels.hpp"
+
+// Source: https://en.wikipedia.org/wiki/Multibrot_set
+// Source: https://en.wikipedia.org/wiki/Burning_Ship_fractal
+
+// Fractal formulas of the CPU engine
+enum class Formula : std::uint8_t {
+#define X(name, str) name,
+    FORMULA_LIST(X)
+#undef X
+};
+
+// Scalar types the formula kernels are instantiated for
+enum class Scalar : std::uint8_t {
+#define X(name, str) name,
+    SCALAR_LIST(X)
+#undef X
+};
+
+// Numbers of formulas and scalar types
+constexpr std::size_t FORMULA_COUNT{0 FORMULA_LIST(X_ENUM_COUNT)};
+constexpr std::size_t SCALAR_COUNT{0 SCALAR_LIST(X_ENUM_COUNT)};
+
+// Formulas and scalar types as strings
+constexpr std::array<std::string_view, FORMULA_COUNT> FORMULA_STR{
+#define X(name, str) str,
+    FORMULA_LIST(X)
+#undef X
+};
+constexpr std::array<std::string_view, SCALAR_COUNT> SCALAR_STR{
+#define X(name, str) str,
+    SCALAR_LIST(X)
+#undef X
+};
+
+// Fractal rendered by the CPU engine
+struct FractalSettings {
+    // Multibrot exponents with an instantiated kernel
+    static constexpr int MIN_POWER = 2;
+    static constexpr int MAX_POWER = 8;
+    // Julia constant with a connected set
+    static constexpr double DEFAULT_JULIA_X = -0.8;
+    static constexpr double DEFAULT_JULIA_Y = 0.156;
+
+    Formula formula{Formula::Mandelbrot};
+    Scalar scalar{Scalar::Double};
+    // Exponent of z, Multibrot only
+    int power{MIN_POWER};
+    // Constant c, Julia only
+    double julia_x{DEFAULT_JULIA_X};
+    double julia_y{DEFAULT_JULIA_Y};
+
+    // z^2 + c in double, rendered by the vector and deep zoom kernels
+    [[nodiscard]] constexpr bool IsPlainMandelbrot() const {
+        return formula == Formula::Mandelbrot && scalar == Scalar::Double;
+    }
+
+    // Copy with the options the formula ignores at their defaults, so
+    // settings rendering the same fractal compare equal
+    [[nodiscard]] constexpr FractalSettings Normalized() const {
+        FractalSettings normalized = *this;
+        if (formula != Formula::Multibrot) {
+            normalized.power = MIN_POWER;
+        }
+        if (formula != Formula::Julia) {
+            normalized.julia_x = DEFAULT_JULIA_X;
+            normalized.julia_y = DEFAULT_JULIA_Y;
+        }
+        return normalized;
+    }
+};
+
+// Conversions and operations the formulas need beyond + - *
+template <typename T> struct ScalarTraits;
+
+template <> struct ScalarTraits<float> {
+    static constexpr float FromDouble(double value) {
+        return static_cast<float>(value);
+    }
+    static constexpr float FromDoubleDouble(const DoubleDouble &value) {
+        return static_cast<float>(value.hi);
+    }
+    static constexpr double ToDouble(float value) { return value; }
+    static constexpr float Abs(float value) {
+        return value < 0.0F ? -value : value;
+    }
+};
+
+template <> struct ScalarTraits<double> {
+    static constexpr double FromDouble(double value) { return value; }
+    static constexpr double FromDoubleDouble(const DoubleDouble &value) {
+        return value.hi;
+    }
+    static constexpr double ToDouble(double value) { return value; }
+    static constexpr double Abs(double value) {
+        return value < 0.0 ? -value : value;
+    }
+};
+
+template <> struct ScalarTraits<DoubleDouble> {
+    static constexpr DoubleDouble FromDouble(double value) {
+        return DoubleDouble(value);
+    }
+    static constexpr DoubleDouble FromDoubleDouble(const DoubleDouble &value) {
+        return value;
+    }
+    static constexpr double ToDouble(const DoubleDouble &value) {
+        return value.hi;
+    }
+    static constexpr DoubleDouble Abs(const DoubleDouble &value) {
+        return value.hi < 0.0 ? -value : value;
+    }
+};
+
+template <> struct ScalarTraits<Fixed64> {
+    static constexpr Fixed64 FromDouble(double value) {
+        return Fixed64::FromDouble(value);
+    }
+    static constexpr Fixed64 FromDoubleDouble(const DoubleDouble &value) {
+        return Fixed64::FromDoubleDouble(value);
+    }
+    static constexpr double ToDouble(Fixed64 value) { return value.ToDouble(); }
+    static constexpr Fixed64 Abs(Fixed64 value) {
+        return value.raw < 0 ? -value : value;
+    }
+};
+
+// State of an orbit, z is iterated and c is added every step
+template <typename T> struct FormulaPoint {
+    T z_x;
+    T z_y;
+    T c_x;
+    T c_y;
+};
+
+// Formula policies
+// NOTE: Start() places the pixel and the Julia constant, Step() computes the
+// next z from z and its squares z2 = (z_x^2, z_y^2)
+
+// z^2 + c with z_0 = 0 and c = pixel
+struct MandelbrotFormula {
+    static constexpr int POWER = 2;
+
+    template <typename T>
+    static constexpr FormulaPoint<T> Start(T x, T y, T /*julia_x*/,
+                                           T /*julia_y*/) {
+        return {T{}, T{}, x, y};
+    }
+
+    // NOTE: Same operations in the same order as EscapeTime(), doubling is
+    // exact so 2 * z_x is written as z_x + z_x for every scalar type
+    template <typename T>
+    static constexpr void Step(T &z_x, T &z_y, const T &z2_x, const T &z2_y,
+                               const T &c_x, const T &c_y) {
+        z_y = ((z_x + z_x) * z_y) + c_y;
+        z_x = (z2_x - z2_y) + c_x;
+    }
+};
+
+// z^2 + c with z_0 = pixel and a fixed c
+struct JuliaFormula : MandelbrotFormula {
+    template <typename T>
+    static constexpr FormulaPoint<T> Start(T x, T y, T julia_x, T julia_y) {
+        return {x, y, julia_x, julia_y};
+    }
+};
+
+// z^power + c with z_0 = 0 and c = pixel
+template <int power> struct MultibrotFormula {
+    static_assert(power >= 2);
+    static constexpr int POWER = power;
+
+    template <typename T>
+    static constexpr FormulaPoint<T> Start(T x, T y, T /*julia_x*/,
+                                           T /*julia_y*/) {
+        return {T{}, T{}, x, y};
+    }
+
+    // z^2 from the squares, then power - 2 complex multiplications
+    // NOTE: power is a constant, so the loop unrolls
+    template <typename T>
+    static constexpr void Step(T &z_x, T &z_y, const T &z2_x, const T &z2_y,
+                               const T &c_x, const T &c_y) {
+        T p_x = z2_x - z2_y;
+        T p_y = (z_x + z_x) * z_y;
+        for (int i = 2; i < POWER; ++i) {
+            const T next_x = (p_x * z_x) - (p_y * z_y);
+            p_y = (p_x * z_y) + (p_y * z_x);
+            p_x = next_x;
+        }
+        z_x = p_x + c_x;
+        z_y = p_y + c_y;
+    }
+};
+
+// (|z_x| + i|z_y|)^2 + c with z_0 = 0 and c = pixel
+struct BurningShipFormula : MandelbrotFormula {
+    template <typename T>
+    static constexpr void Step(T &z_x, T &z_y, const T &z2_x, const T &z2_y,
+                               const T &c_x, const T &c_y) {
+        const T abs_x = ScalarTraits<T>::Abs(z_x);
+        z_y = ((abs_x + abs_x) * ScalarTraits<T>::Abs(z_y)) + c_y;
+        z_x = (z2_x - z2_y) + c_x;
+    }
+};
+
+// Escape algorithm of EscapeTime() for any scalar type and formula
+template <typename T, typename Formula>
+constexpr EscapeResult FormulaEscapeTime(FormulaPoint<T> point, int max_iter,
+                                         double escape) {
+    using Traits = ScalarTraits<T>;
+    auto &[z_x, z_y, c_x, c_y] = point;
+    T z2_x{};
+    T z2_y{};
+
+    int iter = 0;
+    while (Traits::ToDouble(z2_x) + Traits::ToDouble(z2_y) <= escape &&
+           iter < max_iter) {
+        z2_x = z_x * z_x;
+        z2_y = z_y * z_y;
+        Formula::Step(z_x, z_y, z2_x, z2_y, c_x, c_y);
+        iter++;
+    }
+
+    return {iter, Traits::ToDouble(z_x), Traits::ToDouble(z_y)};
+}
+
+// Parameters shared by all pixels of a formula row
+// NOTE: Pixels are placed like in DdRowParams, so double-double and
+// fixed-point kernels keep their precision past double resolution
+struct FormulaRowParams {
+    DoubleDouble center_x;
+    // Offset of the first pixel of the viewport from the center and distance
+    // between pixels
+    double offset_x;
+    double step_x;
+    // Index of the first pixel of the row segment in the viewport row
+    int first_x;
+    // Imaginary part of the row pixels
+    DoubleDouble c_y;
+    // Julia constant
+    double julia_x;
+    double julia_y;
+    int max_iter;
+    double escape;
+};
+
+// Formula kernel, same contract as RowKernel
+using FormulaRowKernel = IterationCount (*)(const FormulaRowParams &params,
+                                            std::span<float> out);
+
+// Row kernel for a scalar type and formula
+// NOTE: Every instantiation is a separate loop without runtime dispatch
+template <typename T, typename Formula>
+IterationCount EscapeRowFormula(const FormulaRowParams &params,
+                                std::span<float> out) {
+    using Traits = ScalarTraits<T>;
+    const T pixel_y = Traits::FromDoubleDouble(params.c_y);
+    const T julia_x = Traits::FromDouble(params.julia_x);
+    const T julia_y = Traits::FromDouble(params.julia_y);
+
+    std::uint64_t iterations = 0;
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        const auto index = static_cast<std::size_t>(params.first_x) + i;
+        const double offset_x =
+            params.offset_x + (static_cast<double>(index) * params.step_x);
+        const T pixel_x = Traits::FromDoubleDouble(params.center_x + offset_x);
+
+        const auto result = FormulaEscapeTime<T, Formula>(
+            Formula::Start(pixel_x, pixel_y, julia_x, julia_y),
+            params.max_iter, params.escape);
+        out[i] = SmoothIteration(result.iter, result.z_x, result.z_y,
+                                 params.max_iter, Formula::POWER);
+        iterations += static_cast<std::uint64_t>(result.iter);
+    }
+    return {.iterations = iterations, .skipped = 0};
+}
+
+// Instantiated kernel for the fractal, powers are clamped to the
+// instantiated range
+[[nodiscard]] FormulaRowKernel
+SelectFormulaKernel(const FractalSettings &fractal);
@@ -0,0 +1,128 @@
+#include "frame_governor.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+
+#include "raylib-cpp.hpp"
+
+FrameGovernor::FrameGovernor(GovernorSettings settings)
+    : settings(settings),
+      budget(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::duration<double>(settings.budget_share /
+                                        std::max(settings.fps, 1)))) {
+    this->settings.min_scale = std::clamp(settings.min_scale, SCALE_STEP, 1.0);
+    this->settings.min_max_iter =
+        std::clamp(settings.min_max_iter, 1, settings.max_iter);
+    // NOTE: Progressive passes halve the block size
+    this->settings.max_block_size = static_cast<int>(std::bit_floor(
+        static_cast<unsigned>(std::max(settings.max_block_size, 1))));
+
+    // NOTE: The cost of the view is unknown, the first frame is the cheapest
+    // one and the following ones refine it
+    quality = LowestQuality();
+}
+
+const FrameQuality &FrameGovernor::Update(std::chrono::nanoseconds render_time,
+                                          bool view_changed) {
+    // Cost of one unit of work, smoothed over the last frames
+    const double frame_cost =
+        static_cast<double>(render_time.count()) / Work(quality);
+    unit_cost = unit_cost == 0.0
+                    ? frame_cost
+                    : (COST_SMOOTHING * frame_cost) +
+                          ((1.0 - COST_SMOOTHING) * unit_cost);
+
+    // New views get the best quality that fits, repeated views refine
+    // NOTE: Refining frames may take longer than the budget, the view does
+    // not move while they render
+    if (view_changed) {
+        SetQuality(Fit(static_cast<double>(budget.count()) / unit_cost),
+                   "new view", render_time);
+    } else {
+        SetQuality(Refine(quality), "refine", render_time);
+    }
+    return quality;
+}
+
+const FrameQuality &FrameGovernor::NewView() {
+    // NOTE: Before the first frame the cost is unknown and the quality is
+    // still the lowest one
+    if (unit_cost > 0.0) {
+        SetQuality(Fit(static_cast<double>(budget.count()) / unit_cost),
+                   "new view", {});
+    }
+    return quality;
+}
+
+void FrameGovernor::SetQuality(const FrameQuality &next, const char *reason,
+                               std::chrono::nanoseconds render_time) {
+    if (next == quality) {
+        return;
+    }
+    quality = next;
+    TraceLog(LOG_INFO,
+             "MANDELBROT_SET: Governor %s (%.2f ms of %.2f ms) -> scale %.4g, "
+             "max_iter %d, block %d",
+             reason,
+             std::chrono::duration<double, std::milli>(render_time).count(),
+             std::chrono::duration<double, std::milli>(budget).count(),
+             quality.scale, quality.max_iter, quality.block_size);
+}
+
+FrameQuality FrameGovernor::FullQuality() const {
+    return {.scale = 1.0, .max_iter = settings.max_iter, .block_size = 1};
+}
+
+FrameQuality FrameGovernor::LowestQuality() const {
+    return {.scale = settings.min_scale,
+            .max_iter = settings.min_max_iter,
+            .block_size = settings.max_block_size};
+}
+
+double FrameGovernor::Work(const FrameQuality &frame) {
+    const double block = frame.block_size;
+    return (frame.scale * frame.scale) / (block * block) *
+           static_cast<double>(frame.max_iter);
+}
+
+FrameQuality FrameGovernor::Fit(double work) const {
+    auto frame = FullQuality();
+    // Share of the full quality work that fits
+    double ratio = work / Work(frame);
+    if (ratio >= 1.0) {
+        return frame;
+    }
+
+    // Resolution, rounded down to whole scale steps
+    const double scale = std::floor(std::sqrt(ratio) / SCALE_STEP) * SCALE_STEP;
+    frame.scale = std::clamp(scale, settings.min_scale, 1.0);
+    ratio /= frame.scale * frame.scale;
+
+    // Progressive depth, every skipped pass divides the samples by 4
+    while (ratio < 1.0 && frame.block_size < settings.max_block_size) {
+        frame.block_size *= 2;
+        ratio *= 4.0;
+    }
+
+    // Iterations
+    if (ratio < 1.0) {
+        frame.max_iter = std::max(
+            static_cast<int>(static_cast<double>(frame.max_iter) * ratio),
+            settings.min_max_iter);
+    }
+    return frame;
+}
+
+FrameQuality FrameGovernor::Refine(const FrameQuality &frame) const {
+    auto refined = frame;
+    if (refined.block_size > 1) {
+        refined.block_size /= 2;
+    } else if (refined.scale < 1.0) {
+        refined.scale = std::min(refined.scale * 2.0, 1.0);
+    } else if (refined.max_iter < settings.max_iter) {
+        refined.max_iter = std::min(refined.max_iter * 2, settings.max_iter);
+    }
+    return refined;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+
+// Quality of one frame picked by the FrameGovernor
+struct FrameQuality {
+    // Size of the rendered buffer relative to the window, in (0, 1]
+    double scale{1.0};
+    int max_iter{};
+    // Blocks sharing one sample after the last progressive pass, 1 renders
+    // every pixel, see Engine::RenderProgressive()
+    int block_size{1};
+
+    bool operator==(const FrameQuality &other) const = default;
+};
+
+// Limits of the FrameGovernor
+struct GovernorSettings {
+    // Frame rate to hold, see Config::WindowOption::Fps
+    int fps{60};
+    // Iterations of a full quality frame
+    int max_iter{1000};
+    // Lowest quality the governor falls back to
+    double min_scale{0.25};
+    int min_max_iter{64};
+    int max_block_size{8};
+    // Share of the frame time available for rendering, the rest is left to
+    // drawing and input
+    double budget_share{0.8};
+};
+
+// Picks the quality of every frame from the cost of the previous ones, so
+// frames fit into the budget of the target fps
+// NOTE: Cost is modelled as proportional to the rendered samples times the
+// iteration limit. Frames of a new view get the best quality that fits,
+// repeated frames of the same view refine one step at a time up to full
+// quality
+// NOTE: Refinement raises the iteration limit last, so the render thread
+// continues the orbits of the full resolution frame, see
+// Engine::RenderResumable()
+class FrameGovernor {
+  public:
+    explicit FrameGovernor(GovernorSettings settings = {});
+
+    // Report the render time of a frame rendered at GetQuality(), returns the
+    // quality of the next frame
+    // NOTE: view_changed is false when the frame showed the same view as the
+    // one before it
+    const FrameQuality &Update(std::chrono::nanoseconds render_time,
+                               bool view_changed);
+
+    // Drop the refinement of the previous view, returns the best quality that
+    // fits the budget at the measured cost
+    const FrameQuality &NewView();
+
+    // Getters
+    [[nodiscard]] const FrameQuality &GetQuality() const noexcept {
+        return quality;
+    }
+    [[nodiscard]] std::chrono::nanoseconds GetBudget() const noexcept {
+        return budget;
+    }
+    [[nodiscard]] bool IsFullQuality() const noexcept {
+        return quality == FullQuality();
+    }
+
+  private:
+    GovernorSettings settings;
+    std::chrono::nanoseconds budget;
+    FrameQuality quality;
+    // Smoothed render time of one unit of Work(), 0 before the first frame
+    double unit_cost{0.0};
+
+    // Weight of the newest frame in the smoothed cost
+    static constexpr double COST_SMOOTHING = 0.5;
+    // Rendered sizes are multiples of this share of the window
+    static constexpr double SCALE_STEP = 1.0 / 16.0;
+
+    [[nodiscard]] FrameQuality FullQuality() const;
+    [[nodiscard]] FrameQuality LowestQuality() const;
+    // Samples times iterations, full quality is settings.max_iter
+    [[nodiscard]] static double Work(const FrameQuality &frame);
+    // Best quality whose work does not exceed the given one, resolution is
+    // lowered first, then the progressive depth and then the iterations
+    [[nodiscard]] FrameQuality Fit(double work) const;
+    // One step toward full quality, the progressive depth first, then the
+    // resolution and then the iterations
+    [[nodiscard]] FrameQuality Refine(const FrameQuality &frame) const;
+    // Switch to the quality, logged when it changes
+    void SetQuality(const FrameQuality &next, const char *reason,
+                    std::chrono::nanoseconds render_time);
+};
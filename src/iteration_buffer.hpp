@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <span>
+#include <vector>
+
+// In-memory buffer with the smooth iteration value of every pixel
+class IterationBuffer {
+  public:
+    IterationBuffer() = default;
+    IterationBuffer(int width, int height) { Resize(width, height); }
+
+    // Change the size of the buffer, keeps the storage when possible
+    void Resize(int new_width, int new_height) {
+        assert(new_width >= 0 && new_height >= 0);
+        width = new_width;
+        height = new_height;
+        values.resize(static_cast<std::size_t>(width) *
+                      static_cast<std::size_t>(height));
+    }
+
+    // Move the contents so pixel (x, y) gets the value of pixel
+    // (x + offset_x, y + offset_y), pixels shifted in from outside the buffer
+    // keep stale values
+    // NOTE: Rows are stored back to back, so the shift is a single move of
+    // the whole storage
+    void Shift(int offset_x, int offset_y) {
+        assert(std::abs(offset_x) <= width && std::abs(offset_y) <= height);
+        const auto offset = (static_cast<std::ptrdiff_t>(offset_y) * width) +
+                            offset_x;
+        if (offset > 0) {
+            std::copy(values.begin() + offset, values.end(), values.begin());
+        } else if (offset < 0) {
+            std::copy_backward(values.begin(), values.end() + offset,
+                               values.end());
+        }
+    }
+
+    // Getters
+    [[nodiscard]] int GetWidth() const noexcept { return width; }
+    [[nodiscard]] int GetHeight() const noexcept { return height; }
+    [[nodiscard]] std::size_t GetSize() const noexcept { return values.size(); }
+
+    // Access a single pixel
+    [[nodiscard]] float &At(int x, int y) { return values[Index(x, y)]; }
+    [[nodiscard]] float At(int x, int y) const { return values[Index(x, y)]; }
+
+    // Access a single row
+    [[nodiscard]] std::span<float> Row(int y) {
+        return Values().subspan(RowOffset(y), static_cast<std::size_t>(width));
+    }
+    [[nodiscard]] std::span<const float> Row(int y) const {
+        return Values().subspan(RowOffset(y), static_cast<std::size_t>(width));
+    }
+
+    // Access the whole buffer, rows are stored one after another
+    [[nodiscard]] std::span<float> Values() noexcept { return values; }
+    [[nodiscard]] std::span<const float> Values() const noexcept {
+        return values;
+    }
+
+  private:
+    int width{};
+    int height{};
+    std::vector<float> values;
+
+    [[nodiscard]] std::size_t RowOffset(int y) const {
+        assert(y >= 0 && y < height);
+        return static_cast<std::size_t>(y) * static_cast<std::size_t>(width);
+    }
+    [[nodiscard]] std::size_t Index(int x, int y) const {
+        assert(x >= 0 && x < width);
+        return RowOffset(y) + static_cast<std::size_t>(x);
+    }
+};
@@ -0,0 +1,379 @@
+#include "kernels.hpp"
+
+#ifdef MANDELBROT_X86_KERNELS
+
+#include <immintrin.h>
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "escape_time.hpp"
+#include "palette.hpp"
+
+namespace {
+// Four double-double numbers, see DoubleDouble for the algorithms
+// NOTE: Same operations in the same order as DoubleDouble, so results are
+// bit-exact with the scalar kernel
+struct DdVec {
+    __m256d hi;
+    __m256d lo;
+};
+
+__attribute__((target("avx2"))) inline DdVec QuickTwoSum(__m256d a,
+                                                        __m256d b) {
+    const __m256d s = _mm256_add_pd(a, b);
+    return {s, _mm256_sub_pd(b, _mm256_sub_pd(s, a))};
+}
+
+__attribute__((target("avx2"))) inline DdVec TwoSum(__m256d a, __m256d b) {
+    const __m256d s = _mm256_add_pd(a, b);
+    const __m256d bb = _mm256_sub_pd(s, a);
+    return {s, _mm256_add_pd(_mm256_sub_pd(a, _mm256_sub_pd(s, bb)),
+                             _mm256_sub_pd(b, bb))};
+}
+
+__attribute__((target("avx2"))) inline DdVec Split(__m256d a) {
+    const __m256d t = _mm256_mul_pd(_mm256_set1_pd(134217729.0), a);
+    const __m256d high = _mm256_sub_pd(t, _mm256_sub_pd(t, a));
+    return {high, _mm256_sub_pd(a, high)};
+}
+
+__attribute__((target("avx2"))) inline DdVec TwoProd(__m256d a, __m256d b) {
+    const __m256d p = _mm256_mul_pd(a, b);
+    const DdVec a_split = Split(a);
+    const DdVec b_split = Split(b);
+    const __m256d err = _mm256_add_pd(
+        _mm256_add_pd(
+            _mm256_add_pd(
+                _mm256_sub_pd(_mm256_mul_pd(a_split.hi, b_split.hi), p),
+                _mm256_mul_pd(a_split.hi, b_split.lo)),
+            _mm256_mul_pd(a_split.lo, b_split.hi)),
+        _mm256_mul_pd(a_split.lo, b_split.lo));
+    return {p, err};
+}
+
+__attribute__((target("avx2"))) inline DdVec Add(const DdVec &a,
+                                                const DdVec &b) {
+    DdVec s = TwoSum(a.hi, b.hi);
+    const DdVec t = TwoSum(a.lo, b.lo);
+    s = QuickTwoSum(s.hi, _mm256_add_pd(s.lo, t.hi));
+    return QuickTwoSum(s.hi, _mm256_add_pd(s.lo, t.lo));
+}
+
+__attribute__((target("avx2"))) inline DdVec Add(const DdVec &a, __m256d b) {
+    const DdVec s = TwoSum(a.hi, b);
+    return QuickTwoSum(s.hi, _mm256_add_pd(s.lo, a.lo));
+}
+
+__attribute__((target("avx2"))) inline DdVec Sub(const DdVec &a,
+                                                const DdVec &b) {
+    const __m256d zero = _mm256_setzero_pd();
+    return Add(a, DdVec{_mm256_sub_pd(zero, b.hi), _mm256_sub_pd(zero, b.lo)});
+}
+
+__attribute__((target("avx2"))) inline DdVec Mul(const DdVec &a,
+                                                const DdVec &b) {
+    const DdVec p = TwoProd(a.hi, b.hi);
+    return QuickTwoSum(
+        p.hi, _mm256_add_pd(p.lo, _mm256_add_pd(_mm256_mul_pd(a.hi, b.lo),
+                                                _mm256_mul_pd(a.lo, b.hi))));
+}
+
+__attribute__((target("avx2"))) inline DdVec Mul(const DdVec &a, __m256d b) {
+    const DdVec p = TwoProd(a.hi, b);
+    return QuickTwoSum(p.hi, _mm256_add_pd(p.lo, _mm256_mul_pd(a.lo, b)));
+}
+
+__attribute__((target("avx2"))) inline DdVec Blend(const DdVec &a,
+                                                  const DdVec &b,
+                                                  __m256d mask) {
+    return {_mm256_blendv_pd(a.hi, b.hi, mask),
+            _mm256_blendv_pd(a.lo, b.lo, mask)};
+}
+}  // namespace
+
+// NOTE: Only this function is built for AVX2, everything it inlines is built
+// for AVX2 too, anything called out of line keeps the baseline instruction set
+__attribute__((target("avx2"))) IterationCount
+EscapeRowAvx2(const RowParams &params, std::span<float> out) {
+    constexpr std::size_t lanes = 4;
+
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d two = _mm256_set1_pd(2.0);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d escape = _mm256_set1_pd(params.escape);
+    const __m256d tolerance = _mm256_set1_pd(params.period_tolerance);
+    const __m256d origin_x = _mm256_set1_pd(params.origin_x);
+    const __m256d step_x = _mm256_set1_pd(params.step_x);
+    const __m256d c_y = _mm256_set1_pd(params.c_y);
+    const __m256d lane_index = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+
+    alignas(32) std::array<double, lanes> iter_out{};
+    alignas(32) std::array<double, lanes> z_x_out{};
+    alignas(32) std::array<double, lanes> z_y_out{};
+
+    const auto first_x = static_cast<std::size_t>(params.first_x);
+    IterationCount count{};
+    for (std::size_t first = 0; first < out.size(); first += lanes) {
+        // Same operations as the scalar kernel, so results are bit-exact
+        const auto first_index = static_cast<double>(first_x + first);
+        const __m256d index =
+            _mm256_add_pd(_mm256_set1_pd(first_index), lane_index);
+        const __m256d c_x =
+            _mm256_add_pd(origin_x, _mm256_mul_pd(index, step_x));
+
+        // Lanes known to never escape, see EscapeTimeInterior()
+        __m256d interior = zero;
+        if (params.check_interior) {
+            const __m256d x = _mm256_sub_pd(c_x, _mm256_set1_pd(0.25));
+            const __m256d y2 = _mm256_mul_pd(c_y, c_y);
+            const __m256d q = _mm256_add_pd(_mm256_mul_pd(x, x), y2);
+            const __m256d cardioid = _mm256_cmp_pd(
+                _mm256_mul_pd(q, _mm256_add_pd(q, x)),
+                _mm256_mul_pd(_mm256_set1_pd(0.25), y2), _CMP_LE_OQ);
+            const __m256d bulb_x = _mm256_add_pd(c_x, one);
+            const __m256d bulb = _mm256_cmp_pd(
+                _mm256_add_pd(_mm256_mul_pd(bulb_x, bulb_x), y2),
+                _mm256_set1_pd(0.0625), _CMP_LE_OQ);
+            interior = _mm256_or_pd(cardioid, bulb);
+        }
+
+        __m256d z_x = zero;
+        __m256d z_y = zero;
+        __m256d z2_x = zero;
+        __m256d z2_y = zero;
+        __m256d saved_x = zero;
+        __m256d saved_y = zero;
+        __m256d iter = zero;
+        int next_save = 1;
+        for (int i = 0; i < params.max_iter; ++i) {
+            // Lanes that did not escape yet
+            const __m256d active = _mm256_andnot_pd(
+                interior, _mm256_cmp_pd(_mm256_add_pd(z2_x, z2_y), escape,
+                                        _CMP_LE_OQ));
+            if (_mm256_movemask_pd(active) == 0) {
+                break;
+            }
+
+            const __m256d next_z2_x = _mm256_mul_pd(z_x, z_x);
+            const __m256d next_z2_y = _mm256_mul_pd(z_y, z_y);
+            const __m256d next_z_y = _mm256_add_pd(
+                _mm256_mul_pd(_mm256_mul_pd(two, z_x), z_y), c_y);
+            const __m256d next_z_x =
+                _mm256_add_pd(_mm256_sub_pd(next_z2_x, next_z2_y), c_x);
+
+            // Escaped lanes keep their last values
+            z2_x = _mm256_blendv_pd(z2_x, next_z2_x, active);
+            z2_y = _mm256_blendv_pd(z2_y, next_z2_y, active);
+            z_y = _mm256_blendv_pd(z_y, next_z_y, active);
+            z_x = _mm256_blendv_pd(z_x, next_z_x, active);
+            iter = _mm256_add_pd(iter, _mm256_and_pd(active, one));
+
+            // Periodic orbits, lanes keep the iteration of the detection
+            if (params.check_interior) {
+                const __m256d d_x =
+                    _mm256_andnot_pd(sign, _mm256_sub_pd(z_x, saved_x));
+                const __m256d d_y =
+                    _mm256_andnot_pd(sign, _mm256_sub_pd(z_y, saved_y));
+                const __m256d periodic =
+                    _mm256_and_pd(_mm256_cmp_pd(d_x, tolerance, _CMP_LT_OQ),
+                                  _mm256_cmp_pd(d_y, tolerance, _CMP_LT_OQ));
+                interior =
+                    _mm256_or_pd(interior, _mm256_and_pd(active, periodic));
+                if (i + 1 == next_save) {
+                    saved_x = z_x;
+                    saved_y = z_y;
+                    next_save *= 2;
+                }
+            }
+        }
+
+        _mm256_store_pd(iter_out.data(), iter);
+        _mm256_store_pd(z_x_out.data(), z_x);
+        _mm256_store_pd(z_y_out.data(), z_y);
+        const int interior_lanes = _mm256_movemask_pd(interior);
+
+        // Smoothing is done per pixel, lanes past the end are dropped
+        for (std::size_t lane = 0; lane < lanes && first + lane < out.size();
+             ++lane) {
+            auto lane_iter = static_cast<int>(iter_out[lane]);
+            if ((interior_lanes & (1 << lane)) != 0) {
+                count.skipped +=
+                    static_cast<std::uint64_t>(params.max_iter - lane_iter);
+                lane_iter = params.max_iter;
+            }
+            out[first + lane] =
+                SmoothIteration(lane_iter, z_x_out[lane], z_y_out[lane],
+                                params.max_iter);
+            count.iterations += static_cast<std::uint64_t>(lane_iter);
+        }
+    }
+    return count;
+}
+
+__attribute__((target("avx2"))) IterationCount
+EscapeRowDdAvx2(const DdRowParams &params, std::span<float> out) {
+    constexpr std::size_t lanes = 4;
+
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d two = _mm256_set1_pd(2.0);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256d escape = _mm256_set1_pd(params.escape);
+    const __m256d tolerance = _mm256_set1_pd(params.period_tolerance);
+    const DdVec center_x{_mm256_set1_pd(params.center_x.hi),
+                         _mm256_set1_pd(params.center_x.lo)};
+    const DdVec c_y{_mm256_set1_pd(params.c_y.hi),
+                    _mm256_set1_pd(params.c_y.lo)};
+    const __m256d offset_x = _mm256_set1_pd(params.offset_x);
+    const __m256d step_x = _mm256_set1_pd(params.step_x);
+    const __m256d lane_index = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+
+    alignas(32) std::array<double, lanes> iter_out{};
+    alignas(32) std::array<double, lanes> z_x_out{};
+    alignas(32) std::array<double, lanes> z_y_out{};
+
+    const auto first_x = static_cast<std::size_t>(params.first_x);
+    IterationCount count{};
+    for (std::size_t first = 0; first < out.size(); first += lanes) {
+        const auto first_index = static_cast<double>(first_x + first);
+        const __m256d index =
+            _mm256_add_pd(_mm256_set1_pd(first_index), lane_index);
+        const __m256d offset =
+            _mm256_add_pd(offset_x, _mm256_mul_pd(index, step_x));
+        const DdVec c_x = Add(center_x, offset);
+
+        // Lanes known to never escape, same test as the scalar kernel
+        __m256d interior = zero;
+        if (params.check_interior) {
+            const DdVec x = Add(c_x, _mm256_set1_pd(-0.25));
+            const DdVec y2 = Mul(c_y, c_y);
+            const DdVec q = Add(Mul(x, x), y2);
+            const DdVec cardioid = Sub(Mul(q, Add(q, x)),
+                                       Mul(y2, _mm256_set1_pd(0.25)));
+            const DdVec bulb_x = Add(c_x, one);
+            const DdVec bulb = Add(Add(Mul(bulb_x, bulb_x), y2),
+                                   _mm256_set1_pd(-0.0625));
+            interior =
+                _mm256_or_pd(_mm256_cmp_pd(cardioid.hi, zero, _CMP_LE_OQ),
+                             _mm256_cmp_pd(bulb.hi, zero, _CMP_LE_OQ));
+        }
+
+        DdVec z_x{zero, zero};
+        DdVec z_y{zero, zero};
+        DdVec z2_x{zero, zero};
+        DdVec z2_y{zero, zero};
+        DdVec saved_x{zero, zero};
+        DdVec saved_y{zero, zero};
+        __m256d iter = zero;
+        int next_save = 1;
+        for (int i = 0; i < params.max_iter; ++i) {
+            // Lanes that did not escape yet
+            const __m256d active = _mm256_andnot_pd(
+                interior, _mm256_cmp_pd(_mm256_add_pd(z2_x.hi, z2_y.hi),
+                                        escape, _CMP_LE_OQ));
+            if (_mm256_movemask_pd(active) == 0) {
+                break;
+            }
+
+            const DdVec next_z2_x = Mul(z_x, z_x);
+            const DdVec next_z2_y = Mul(z_y, z_y);
+            const DdVec next_z_y = Add(Mul(Mul(z_x, two), z_y), c_y);
+            const DdVec next_z_x = Add(Sub(next_z2_x, next_z2_y), c_x);
+
+            // Escaped lanes keep their last values
+            z2_x = Blend(z2_x, next_z2_x, active);
+            z2_y = Blend(z2_y, next_z2_y, active);
+            z_y = Blend(z_y, next_z_y, active);
+            z_x = Blend(z_x, next_z_x, active);
+            iter = _mm256_add_pd(iter, _mm256_and_pd(active, one));
+
+            // Periodic orbits, lanes keep the iteration of the detection
+            if (params.check_interior) {
+                const __m256d d_x =
+                    _mm256_andnot_pd(sign, Sub(z_x, saved_x).hi);
+                const __m256d d_y =
+                    _mm256_andnot_pd(sign, Sub(z_y, saved_y).hi);
+                const __m256d periodic =
+                    _mm256_and_pd(_mm256_cmp_pd(d_x, tolerance, _CMP_LT_OQ),
+                                  _mm256_cmp_pd(d_y, tolerance, _CMP_LT_OQ));
+                interior =
+                    _mm256_or_pd(interior, _mm256_and_pd(active, periodic));
+                if (i + 1 == next_save) {
+                    saved_x = z_x;
+                    saved_y = z_y;
+                    next_save *= 2;
+                }
+            }
+        }
+
+        _mm256_store_pd(iter_out.data(), iter);
+        _mm256_store_pd(z_x_out.data(), z_x.hi);
+        _mm256_store_pd(z_y_out.data(), z_y.hi);
+        const int interior_lanes = _mm256_movemask_pd(interior);
+
+        // Smoothing is done per pixel, lanes past the end are dropped
+        for (std::size_t lane = 0; lane < lanes && first + lane < out.size();
+             ++lane) {
+            auto lane_iter = static_cast<int>(iter_out[lane]);
+            if ((interior_lanes & (1 << lane)) != 0) {
+                count.skipped +=
+                    static_cast<std::uint64_t>(params.max_iter - lane_iter);
+                lane_iter = params.max_iter;
+            }
+            out[first + lane] =
+                SmoothIteration(lane_iter, z_x_out[lane], z_y_out[lane],
+                                params.max_iter);
+            count.iterations += static_cast<std::uint64_t>(lane_iter);
+        }
+    }
+    return count;
+}
+
+__attribute__((target("avx2"))) void
+ColorizeAvx2(const ColorizeParams &params, std::span<const float> values,
+             std::span<PackedColor> out) {
+    assert(out.size() == values.size());
+    assert(!params.palette.empty());
+    constexpr std::size_t lanes = 8;
+    // NOTE: Gathers read 32-bit integers, the palette size is limited so the
+    // indices fit
+    const auto *const palette =
+        reinterpret_cast<const int *>(params.palette.data());
+
+    const __m256 max_iter = _mm256_set1_ps(params.max_iter);
+    const __m256 scale = _mm256_set1_ps(params.Scale());
+    const __m256 offset = _mm256_set1_ps(params.offset);
+    const __m256 size =
+        _mm256_set1_ps(static_cast<float>(params.palette.size()));
+    const __m256i last =
+        _mm256_set1_epi32(static_cast<int>(params.palette.size() - 1));
+    const __m256i interior =
+        _mm256_set1_epi32(static_cast<int>(params.interior));
+
+    std::size_t first = 0;
+    for (; first + lanes <= values.size(); first += lanes) {
+        // Same operations in the same order as ColorizeScalar()
+        const __m256 value = _mm256_loadu_ps(values.data() + first);
+        __m256 position = _mm256_add_ps(_mm256_mul_ps(value, scale), offset);
+        position = _mm256_sub_ps(position, _mm256_floor_ps(position));
+        const __m256i index = _mm256_min_epi32(
+            _mm256_cvttps_epi32(_mm256_mul_ps(position, size)), last);
+        const __m256i color = _mm256_i32gather_epi32(palette, index, 4);
+
+        // Interior lanes take the interior color
+        const __m256i inside = _mm256_castps_si256(
+            _mm256_cmp_ps(value, max_iter, _CMP_GE_OQ));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out.data() + first),
+                            _mm256_blendv_epi8(color, interior, inside));
+    }
+
+    // Pixels past the last full vector
+    ColorizeScalar(params, values.subspan(first), out.subspan(first));
+}
+
+#endif
@@ -0,0 +1,129 @@
+#include "kernels.hpp"
+
+#ifdef MANDELBROT_X86_KERNELS
+
+#include <immintrin.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "escape_time.hpp"
+
+// NOTE: Only this function is built for AVX-512, everything it inlines is
+// built for AVX-512 too, anything called out of line keeps the baseline
+// instruction set
+__attribute__((target("avx512f"))) IterationCount
+EscapeRowAvx512(const RowParams &params, std::span<float> out) {
+    constexpr std::size_t lanes = 8;
+
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d two = _mm512_set1_pd(2.0);
+    const __m512d escape = _mm512_set1_pd(params.escape);
+    const __m512d tolerance = _mm512_set1_pd(params.period_tolerance);
+    const __m512d origin_x = _mm512_set1_pd(params.origin_x);
+    const __m512d step_x = _mm512_set1_pd(params.step_x);
+    const __m512d c_y = _mm512_set1_pd(params.c_y);
+    const __m512d lane_index =
+        _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+
+    alignas(64) std::array<double, lanes> iter_out{};
+    alignas(64) std::array<double, lanes> z_x_out{};
+    alignas(64) std::array<double, lanes> z_y_out{};
+
+    const auto first_x = static_cast<std::size_t>(params.first_x);
+    IterationCount count{};
+    for (std::size_t first = 0; first < out.size(); first += lanes) {
+        // Same operations as the scalar kernel, so results are bit-exact
+        const auto first_index = static_cast<double>(first_x + first);
+        const __m512d index =
+            _mm512_add_pd(_mm512_set1_pd(first_index), lane_index);
+        const __m512d c_x =
+            _mm512_add_pd(origin_x, _mm512_mul_pd(index, step_x));
+
+        // Lanes known to never escape, see EscapeTimeInterior()
+        __mmask8 interior = 0;
+        if (params.check_interior) {
+            const __m512d x = _mm512_sub_pd(c_x, _mm512_set1_pd(0.25));
+            const __m512d y2 = _mm512_mul_pd(c_y, c_y);
+            const __m512d q = _mm512_add_pd(_mm512_mul_pd(x, x), y2);
+            const __mmask8 cardioid = _mm512_cmp_pd_mask(
+                _mm512_mul_pd(q, _mm512_add_pd(q, x)),
+                _mm512_mul_pd(_mm512_set1_pd(0.25), y2), _CMP_LE_OQ);
+            const __m512d bulb_x = _mm512_add_pd(c_x, one);
+            const __mmask8 bulb = _mm512_cmp_pd_mask(
+                _mm512_add_pd(_mm512_mul_pd(bulb_x, bulb_x), y2),
+                _mm512_set1_pd(0.0625), _CMP_LE_OQ);
+            interior = cardioid | bulb;
+        }
+
+        __m512d z_x = zero;
+        __m512d z_y = zero;
+        __m512d z2_x = zero;
+        __m512d z2_y = zero;
+        __m512d saved_x = zero;
+        __m512d saved_y = zero;
+        __m512d iter = zero;
+        int next_save = 1;
+        for (int i = 0; i < params.max_iter; ++i) {
+            // Lanes that did not escape yet
+            const __mmask8 active =
+                _mm512_cmp_pd_mask(_mm512_add_pd(z2_x, z2_y), escape,
+                                   _CMP_LE_OQ) &
+                static_cast<__mmask8>(~interior);
+            if (active == 0) {
+                break;
+            }
+
+            // Escaped lanes keep their last values
+            const __m512d next_z_y = _mm512_add_pd(
+                _mm512_mul_pd(_mm512_mul_pd(two, z_x), z_y), c_y);
+            z2_x = _mm512_mask_mul_pd(z2_x, active, z_x, z_x);
+            z2_y = _mm512_mask_mul_pd(z2_y, active, z_y, z_y);
+            z_y = _mm512_mask_mov_pd(z_y, active, next_z_y);
+            z_x = _mm512_mask_add_pd(z_x, active, _mm512_sub_pd(z2_x, z2_y),
+                                     c_x);
+            iter = _mm512_mask_add_pd(iter, active, iter, one);
+
+            // Periodic orbits, lanes keep the iteration of the detection
+            if (params.check_interior) {
+                const __m512d d_x = _mm512_abs_pd(_mm512_sub_pd(z_x, saved_x));
+                const __m512d d_y = _mm512_abs_pd(_mm512_sub_pd(z_y, saved_y));
+                const __mmask8 periodic =
+                    _mm512_mask_cmp_pd_mask(active, d_x, tolerance,
+                                            _CMP_LT_OQ) &
+                    _mm512_cmp_pd_mask(d_y, tolerance, _CMP_LT_OQ);
+                interior |= periodic;
+                if (i + 1 == next_save) {
+                    saved_x = z_x;
+                    saved_y = z_y;
+                    next_save *= 2;
+                }
+            }
+        }
+
+        _mm512_store_pd(iter_out.data(), iter);
+        _mm512_store_pd(z_x_out.data(), z_x);
+        _mm512_store_pd(z_y_out.data(), z_y);
+
+        // Smoothing is done per pixel, lanes past the end are dropped
+        for (std::size_t lane = 0; lane < lanes && first + lane < out.size();
+             ++lane) {
+            auto lane_iter = static_cast<int>(iter_out[lane]);
+            if ((interior & (1U << lane)) != 0) {
+                count.skipped +=
+                    static_cast<std::uint64_t>(params.max_iter - lane_iter);
+                lane_iter = params.max_iter;
+            }
+            out[first + lane] =
+                SmoothIteration(lane_iter, z_x_out[lane], z_y_out[lane],
+                                params.max_iter);
+            count.iterations += static_cast<std::uint64_t>(lane_iter);
+        }
+    }
+    return count;
+}
+
+#endif
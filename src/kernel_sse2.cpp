@@ -0,0 +1,138 @@
+#include "kernels.hpp"
+
+#ifdef MANDELBROT_X86_KERNELS
+
+#include <emmintrin.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "escape_time.hpp"
+
+namespace {
+// Select b where the mask is set and a elsewhere
+// NOTE: SSE2 has no blend instruction
+__attribute__((target("sse2"))) inline __m128d Blend(__m128d a, __m128d b,
+                                                     __m128d mask) {
+    return _mm_or_pd(_mm_and_pd(mask, b), _mm_andnot_pd(mask, a));
+}
+}  // namespace
+
+__attribute__((target("sse2"))) IterationCount
+EscapeRowSse2(const RowParams &params, std::span<float> out) {
+    constexpr std::size_t lanes = 2;
+
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d two = _mm_set1_pd(2.0);
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d escape = _mm_set1_pd(params.escape);
+    const __m128d tolerance = _mm_set1_pd(params.period_tolerance);
+    const __m128d origin_x = _mm_set1_pd(params.origin_x);
+    const __m128d step_x = _mm_set1_pd(params.step_x);
+    const __m128d c_y = _mm_set1_pd(params.c_y);
+    const __m128d lane_index = _mm_set_pd(1.0, 0.0);
+
+    alignas(16) std::array<double, lanes> iter_out{};
+    alignas(16) std::array<double, lanes> z_x_out{};
+    alignas(16) std::array<double, lanes> z_y_out{};
+
+    const auto first_x = static_cast<std::size_t>(params.first_x);
+    IterationCount count{};
+    for (std::size_t first = 0; first < out.size(); first += lanes) {
+        // Same operations as the scalar kernel, so results are bit-exact
+        const auto first_index = static_cast<double>(first_x + first);
+        const __m128d index = _mm_add_pd(_mm_set1_pd(first_index), lane_index);
+        const __m128d c_x = _mm_add_pd(origin_x, _mm_mul_pd(index, step_x));
+
+        // Lanes known to never escape, see EscapeTimeInterior()
+        __m128d interior = zero;
+        if (params.check_interior) {
+            const __m128d x = _mm_sub_pd(c_x, _mm_set1_pd(0.25));
+            const __m128d y2 = _mm_mul_pd(c_y, c_y);
+            const __m128d q = _mm_add_pd(_mm_mul_pd(x, x), y2);
+            const __m128d cardioid =
+                _mm_cmple_pd(_mm_mul_pd(q, _mm_add_pd(q, x)),
+                             _mm_mul_pd(_mm_set1_pd(0.25), y2));
+            const __m128d bulb_x = _mm_add_pd(c_x, one);
+            const __m128d bulb =
+                _mm_cmple_pd(_mm_add_pd(_mm_mul_pd(bulb_x, bulb_x), y2),
+                             _mm_set1_pd(0.0625));
+            interior = _mm_or_pd(cardioid, bulb);
+        }
+
+        __m128d z_x = zero;
+        __m128d z_y = zero;
+        __m128d z2_x = zero;
+        __m128d z2_y = zero;
+        __m128d saved_x = zero;
+        __m128d saved_y = zero;
+        __m128d iter = zero;
+        int next_save = 1;
+        for (int i = 0; i < params.max_iter; ++i) {
+            // Lanes that did not escape yet
+            const __m128d active =
+                _mm_andnot_pd(interior,
+                              _mm_cmple_pd(_mm_add_pd(z2_x, z2_y), escape));
+            if (_mm_movemask_pd(active) == 0) {
+                break;
+            }
+
+            const __m128d next_z2_x = _mm_mul_pd(z_x, z_x);
+            const __m128d next_z2_y = _mm_mul_pd(z_y, z_y);
+            const __m128d next_z_y =
+                _mm_add_pd(_mm_mul_pd(_mm_mul_pd(two, z_x), z_y), c_y);
+            const __m128d next_z_x =
+                _mm_add_pd(_mm_sub_pd(next_z2_x, next_z2_y), c_x);
+
+            // Escaped lanes keep their last values
+            z2_x = Blend(z2_x, next_z2_x, active);
+            z2_y = Blend(z2_y, next_z2_y, active);
+            z_y = Blend(z_y, next_z_y, active);
+            z_x = Blend(z_x, next_z_x, active);
+            iter = _mm_add_pd(iter, _mm_and_pd(active, one));
+
+            // Periodic orbits, lanes keep the iteration of the detection
+            if (params.check_interior) {
+                const __m128d d_x =
+                    _mm_andnot_pd(sign, _mm_sub_pd(z_x, saved_x));
+                const __m128d d_y =
+                    _mm_andnot_pd(sign, _mm_sub_pd(z_y, saved_y));
+                const __m128d periodic =
+                    _mm_and_pd(_mm_cmplt_pd(d_x, tolerance),
+                               _mm_cmplt_pd(d_y, tolerance));
+                interior = _mm_or_pd(interior, _mm_and_pd(active, periodic));
+                if (i + 1 == next_save) {
+                    saved_x = z_x;
+                    saved_y = z_y;
+                    next_save *= 2;
+                }
+            }
+        }
+
+        _mm_store_pd(iter_out.data(), iter);
+        _mm_store_pd(z_x_out.data(), z_x);
+        _mm_store_pd(z_y_out.data(), z_y);
+        const int interior_lanes = _mm_movemask_pd(interior);
+
+        // Smoothing is done per pixel, lanes past the end are dropped
+        for (std::size_t lane = 0; lane < lanes && first + lane < out.size();
+             ++lane) {
+            auto lane_iter = static_cast<int>(iter_out[lane]);
+            if ((interior_lanes & (1 << lane)) != 0) {
+                count.skipped +=
+                    static_cast<std::uint64_t>(params.max_iter - lane_iter);
+                lane_iter = params.max_iter;
+            }
+            out[first + lane] =
+                SmoothIteration(lane_iter, z_x_out[lane], z_y_out[lane],
+                                params.max_iter);
+            count.iterations += static_cast<std::uint64_t>(lane_iter);
+        }
+    }
+    return count;
+}
+
+#endif
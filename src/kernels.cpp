@@ -0,0 +1,160 @@
+#include "kernels.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <span>
+
+#include "double_double.hpp"
+#include "escape_time.hpp"
+
+bool InCardioidOrBulb(const DoubleDouble &c_x, const DoubleDouble &c_y) {
+    const DoubleDouble x = c_x + -0.25;
+    const DoubleDouble y2 = c_y * c_y;
+    const DoubleDouble q = (x * x) + y2;
+    if (((q * (q + x)) - (y2 * 0.25)).hi <= 0.0) {
+        return true;
+    }
+    const DoubleDouble bulb_x = c_x + 1.0;
+    return (((bulb_x * bulb_x) + y2) + -0.0625).hi <= 0.0;
+}
+
+IterationCount EscapeRowScalar(const RowParams &params, std::span<float> out) {
+    IterationCount count{};
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        const auto index = static_cast<std::size_t>(params.first_x) + i;
+        const double c_x =
+            params.origin_x + (static_cast<double>(index) * params.step_x);
+        const auto result =
+            params.check_interior
+                ? EscapeTimeInterior(c_x, params.c_y, params.max_iter,
+                                     params.escape, params.period_tolerance)
+                : EscapeTime(c_x, params.c_y, params.max_iter, params.escape);
+        out[i] = SmoothIteration(result.iter, result.z_x, result.z_y,
+                                 params.max_iter);
+        count.iterations += static_cast<std::uint64_t>(result.iter);
+        count.skipped += static_cast<std::uint64_t>(result.skipped);
+    }
+    return count;
+}
+
+IterationCount EscapeRowDdScalar(const DdRowParams &params,
+                                 std::span<float> out) {
+    IterationCount count{};
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        const auto index = static_cast<std::size_t>(params.first_x) + i;
+        const double offset_x =
+            params.offset_x + (static_cast<double>(index) * params.step_x);
+        const DoubleDouble c_x = params.center_x + offset_x;
+
+        if (params.check_interior && InCardioidOrBulb(c_x, params.c_y)) {
+            out[i] = static_cast<float>(params.max_iter);
+            count.iterations += static_cast<std::uint64_t>(params.max_iter);
+            count.skipped += static_cast<std::uint64_t>(params.max_iter);
+            continue;
+        }
+
+        // Same escape algorithm as EscapeTimeInterior() in double-double
+        DoubleDouble z_x;
+        DoubleDouble z_y;
+        DoubleDouble z2_x;
+        DoubleDouble z2_y;
+        DoubleDouble saved_x;
+        DoubleDouble saved_y;
+        int next_save = 1;
+        int iter = 0;
+        int skipped = 0;
+        while (z2_x.hi + z2_y.hi <= params.escape && iter < params.max_iter) {
+            z2_x = z_x * z_x;
+            z2_y = z_y * z_y;
+            z_y = ((z_x * 2.0) * z_y) + params.c_y;
+            z_x = (z2_x - z2_y) + c_x;
+            iter++;
+
+            if (!params.check_interior) {
+                continue;
+            }
+            if (std::fabs((z_x - saved_x).hi) < params.period_tolerance &&
+                std::fabs((z_y - saved_y).hi) < params.period_tolerance) {
+                skipped = params.max_iter - iter;
+                iter = params.max_iter;
+                break;
+            }
+            if (iter == next_save) {
+                saved_x = z_x;
+                saved_y = z_y;
+                next_save *= 2;
+            }
+        }
+
+        out[i] = SmoothIteration(iter, z_x.hi, z_y.hi, params.max_iter);
+        count.iterations += static_cast<std::uint64_t>(iter);
+        count.skipped += static_cast<std::uint64_t>(skipped);
+    }
+    return count;
+}
+
+bool IsIsaSupported(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar:
+        return true;
+#ifdef MANDELBROT_X86_KERNELS
+    case Isa::Sse2:
+        return __builtin_cpu_supports("sse2") != 0;
+    case Isa::Avx2:
+        return __builtin_cpu_supports("avx2") != 0;
+    case Isa::Avx512:
+        return __builtin_cpu_supports("avx512f") != 0;
+#endif
+    }
+    return false;
+}
+
+Isa DetectIsa() {
+    // Checked once, the host does not change while running
+    static const Isa detected = []() {
+        Isa widest = Isa::Scalar;
+        for (std::size_t i = 0; i < ISA_COUNT; ++i) {
+            const auto isa = static_cast<Isa>(i);
+            if (IsIsaSupported(isa)) {
+                widest = isa;
+            }
+        }
+        return widest;
+    }();
+    return detected;
+}
+
+Isa SupportedIsa(Isa isa) {
+    if (IsIsaSupported(isa)) {
+        return isa;
+    }
+    return DetectIsa();
+}
+
+RowKernel SelectRowKernel(Isa isa) {
+    switch (SupportedIsa(isa)) {
+    case Isa::Scalar:
+        return &EscapeRowScalar;
+#ifdef MANDELBROT_X86_KERNELS
+    case Isa::Sse2:
+        return &EscapeRowSse2;
+    case Isa::Avx2:
+        return &EscapeRowAvx2;
+    case Isa::Avx512:
+        return &EscapeRowAvx512;
+#endif
+    }
+    return &EscapeRowScalar;
+}
+
+DdRowKernel SelectDdRowKernel(Isa isa) {
+    switch (SupportedIsa(isa)) {
+#ifdef MANDELBROT_X86_KERNELS
+    case Isa::Avx2:
+    case Isa::Avx512:
+        return &EscapeRowDdAvx2;
+#endif
+    default:
+        return &EscapeRowDdScalar;
+    }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "double_double.hpp"
+#include "enum_list.hpp"
+
+// x86 vector kernels are built with function target attributes, so a single
+// binary contains all of them and picks one at runtime
+#if (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (defined(__GNUC__) || defined(__clang__))
+#define MANDELBROT_X86_KERNELS 1
+#endif
+
+// Instruction sets with an escape-time kernel
+enum class Isa : std::uint8_t {
+#define X(name, str) name,
+    ISA_LIST(X)
+#undef X
+};
+
+// Number of instruction sets
+constexpr std::size_t ISA_COUNT{0 ISA_LIST(X_ENUM_COUNT)};
+
+// Instruction sets as strings
+constexpr std::array<std::string_view, ISA_COUNT> ISA_STR{
+#define X(name, str) str,
+    ISA_LIST(X)
+#undef X
+};
+
+// Iterations done and skipped by a group of pixels
+// NOTE: Skipped iterations are included in iterations
+struct IterationCount {
+    std::uint64_t iterations;
+    std::uint64_t skipped;
+
+    constexpr IterationCount &operator+=(const IterationCount &other) {
+        iterations += other.iterations;
+        skipped += other.skipped;
+        return *this;
+    }
+};
+
+// Parameters shared by all pixels of a row
+struct RowParams {
+    // Real part of the first pixel of the viewport and distance between pixels
+    double origin_x;
+    double step_x;
+    // Index of the first pixel of the row segment in the viewport row
+    // NOTE: Pixels are placed relative to origin_x, so results do not depend
+    // on how rows are split
+    int first_x;
+    // Imaginary part of the whole row
+    double c_y;
+    int max_iter;
+    double escape;
+    // Stop early for interior points, see EscapeTimeInterior()
+    bool check_interior;
+    double period_tolerance;
+};
+
+// Kernel computing the smooth iteration value of every pixel in the row
+// Returns the number of iterations done and skipped
+// NOTE: out.size() is the number of pixels in the row
+using RowKernel = IterationCount (*)(const RowParams &params,
+                                     std::span<float> out);
+
+// Parameters shared by all pixels of a double-double row
+// NOTE: Pixels are placed as the double offset from the high precision
+// center, the offset is tiny compared to the center
+struct DdRowParams {
+    DoubleDouble center_x;
+    // Offset of the first pixel of the viewport from the center and distance
+    // between pixels
+    double offset_x;
+    double step_x;
+    // Index of the first pixel of the row segment in the viewport row
+    int first_x;
+    DoubleDouble c_y;
+    int max_iter;
+    double escape;
+    // Stop early for interior points, see EscapeTimeInterior()
+    bool check_interior;
+    double period_tolerance;
+};
+
+// Double-double kernel, same contract as RowKernel
+using DdRowKernel = IterationCount (*)(const DdRowParams &params,
+                                       std::span<float> out);
+
+// InCardioidOrBulb() in double-double, the boundaries are resolved at any
+// zoom of the double-double band
+[[nodiscard]] bool InCardioidOrBulb(const DoubleDouble &c_x,
+                                    const DoubleDouble &c_y);
+
+// Scalar reference kernels
+IterationCount EscapeRowScalar(const RowParams &params, std::span<float> out);
+IterationCount EscapeRowDdScalar(const DdRowParams &params,
+                                 std::span<float> out);
+
+#ifdef MANDELBROT_X86_KERNELS
+// Vector kernels, 2, 4 and 8 pixels per instruction
+// NOTE: Must be called only when IsIsaSupported() returns true
+IterationCount EscapeRowSse2(const RowParams &params, std::span<float> out);
+IterationCount EscapeRowAvx2(const RowParams &params, std::span<float> out);
+IterationCount EscapeRowAvx512(const RowParams &params,
+                               std::span<float> out);
+// Double-double vector kernel, 4 pixels per instruction
+IterationCount EscapeRowDdAvx2(const DdRowParams &params,
+                               std::span<float> out);
+#endif
+
+// Whether the host can run the kernel
+[[nodiscard]] bool IsIsaSupported(Isa isa);
+
+// Widest instruction set supported by the host
+[[nodiscard]] Isa DetectIsa();
+
+// Requested instruction set, or the widest supported one when the host cannot
+// run it
+[[nodiscard]] Isa SupportedIsa(Isa isa);
+
+// Kernel for the instruction set, see SupportedIsa()
+[[nodiscard]] RowKernel SelectRowKernel(Isa isa);
+
+// Double-double kernel for the instruction set, see SupportedIsa()
+// NOTE: AVX-512 hosts use the AVX2 kernel, SSE2 hosts the scalar one
+[[nodiscard]] DdRowKernel SelectDdRowKernel(Isa isa);
@@ -0,0 +1,145 @@
+#include "palette.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <format>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "kernels.hpp"
+#include "mandelbrot_error.hpp"
+#include "rgb.hpp"
+
+Palette::Palette(std::span<const RGB> colors) {
+    assert(colors.size() >= MIN_SIZE && colors.size() <= MAX_SIZE);
+    this->colors.reserve(colors.size());
+    for (const auto &color : colors) {
+        this->colors.push_back(PackColor(color));
+    }
+}
+
+Palette Palette::Hsv(std::size_t size, float saturation, float value) {
+    constexpr float hue_full_circle_degrees = 360.0F;
+    std::vector<RGB> colors(size);
+
+    // NOTE: Same operations as GenPaletteHSV(), so the default palette matches
+    // the compile time one
+    const auto size_float = static_cast<float>(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        const auto index_float = static_cast<float>(i);
+        const float hue_degrees =
+            (hue_full_circle_degrees * index_float) / size_float;
+        colors[i] = RGB::FromHSV(hue_degrees, saturation, value);
+    }
+    return Palette(colors);
+}
+
+Palette Palette::Gradient(std::span<const RGB> stops, std::size_t size) {
+    assert(!stops.empty());
+    std::vector<RGB> colors(size);
+
+    const auto stop_count = static_cast<double>(stops.size());
+    for (std::size_t i = 0; i < size; ++i) {
+        // Position between two stops
+        const double position =
+            static_cast<double>(i) * stop_count / static_cast<double>(size);
+        const auto first = static_cast<std::size_t>(position);
+        const auto second = (first + 1) % stops.size();
+        const auto fraction =
+            static_cast<float>(position - static_cast<double>(first));
+
+        const auto &from = stops[first];
+        const auto &to = stops[second];
+        colors[i] = RGB{from.r + ((to.r - from.r) * fraction),
+                        from.g + ((to.g - from.g) * fraction),
+                        from.b + ((to.b - from.b) * fraction)};
+    }
+    return Palette(colors);
+}
+
+std::expected<RGB, MandelbrotError> Palette::ParseColor(std::string_view text) {
+    constexpr std::size_t hex_length = 7;
+    constexpr float max_component = 255.0F;
+    const auto invalid = [&]() {
+        auto error_msg =
+            std::format("Invalid color, expected \"#rrggbb\" -> {}", text);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::InvalidValue, error_msg));
+    };
+    if (text.size() != hex_length || text.front() != '#') {
+        return invalid();
+    }
+
+    // Two hex digits per component
+    std::array<float, 3> components{};
+    for (std::size_t i = 0; i < components.size(); ++i) {
+        const char *const first = text.data() + 1 + (i * 2);
+        std::uint8_t component = 0;
+        const auto [end, error] =
+            std::from_chars(first, first + 2, component, 16);
+        if (error != std::errc{} || end != first + 2) {
+            return invalid();
+        }
+        components.at(i) = static_cast<float>(component) / max_component;
+    }
+    return RGB{components[0], components[1], components[2]};
+}
+
+Palette PaletteSettings::Generate() const {
+    switch (type) {
+    case PaletteType::Hsv:
+        break;
+    case PaletteType::Gradient:
+        if (!stops.empty()) {
+            return Palette::Gradient(stops, size);
+        }
+        break;
+    }
+    return Palette::Hsv(size, saturation, value);
+}
+
+void ColorizeScalar(const ColorizeParams &params,
+                    std::span<const float> values,
+                    std::span<PackedColor> out) {
+    assert(out.size() == values.size());
+    assert(!params.palette.empty());
+    const float scale = params.Scale();
+    const auto size = static_cast<float>(params.palette.size());
+    const auto last = static_cast<std::uint32_t>(params.palette.size() - 1);
+
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const float value = values[i];
+        if (value >= params.max_iter) {
+            out[i] = params.interior;
+            continue;
+        }
+        // Fractional palette position, then the color under it
+        // NOTE: Rounding can make the position exactly 1, the index is
+        // clamped to the last color
+        float position = (value * scale) + params.offset;
+        position -= std::floor(position);
+        const auto index =
+            std::min(static_cast<std::uint32_t>(position * size), last);
+        out[i] = params.palette[index];
+    }
+}
+
+ColorizeKernel SelectColorizeKernel(Isa isa) {
+    switch (SupportedIsa(isa)) {
+#ifdef MANDELBROT_X86_KERNELS
+    case Isa::Avx2:
+    case Isa::Avx512:
+        return &ColorizeAvx2;
+#endif
+    default:
+        return &ColorizeScalar;
+    }
+}
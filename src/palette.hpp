@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "enum_list.hpp"
+#include "kernels.hpp"
+#include "mandelbrot_error.hpp"
+#include "rgb.hpp"
+
+// Ways a palette is generated at runtime
+enum class PaletteType : std::uint8_t {
+#define X(name, str) name,
+    PALETTE_TYPE_LIST(X)
+#undef X
+};
+
+// Number of palette types
+constexpr std::size_t PALETTE_TYPE_COUNT{0 PALETTE_TYPE_LIST(X_ENUM_COUNT)};
+
+// Palette types as strings
+constexpr std::array<std::string_view, PALETTE_TYPE_COUNT> PALETTE_TYPE_STR{
+#define X(name, str) str,
+    PALETTE_TYPE_LIST(X)
+#undef X
+};
+
+// Color as 8-bit r, g, b and a in memory order
+// NOTE: Same layout as raylib Color and PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+using PackedColor = std::uint32_t;
+
+// Opaque color with components in [0, 1]
+constexpr PackedColor PackColor(const RGB &color) {
+    constexpr float max_component = 255.0F;
+    return std::bit_cast<PackedColor>(std::array<std::uint8_t, 4>{
+        static_cast<std::uint8_t>(color.r * max_component),
+        static_cast<std::uint8_t>(color.g * max_component),
+        static_cast<std::uint8_t>(color.b * max_component), 255});
+}
+
+// Color lookup table built at runtime
+class Palette {
+  public:
+    static constexpr std::size_t DEFAULT_SIZE = 1024;
+    // NOTE: Colors are indexed with 32-bit lanes by the vector kernel
+    static constexpr std::size_t MIN_SIZE = 1;
+    static constexpr std::size_t MAX_SIZE = 65536;
+
+    explicit Palette(std::span<const RGB> colors);
+
+    // Evenly spaced hues around the HSV color wheel, see RGB::GenPaletteHSV()
+    [[nodiscard]] static Palette Hsv(std::size_t size = DEFAULT_SIZE,
+                                     float saturation = 1.0F,
+                                     float value = 1.0F);
+
+    // Colors blended linearly between evenly spaced stops
+    // NOTE: The last stop blends back into the first one, so a cycled palette
+    // has no seam
+    [[nodiscard]] static Palette Gradient(std::span<const RGB> stops,
+                                          std::size_t size = DEFAULT_SIZE);
+
+    // Color written as "#rrggbb"
+    [[nodiscard]] static std::expected<RGB, MandelbrotError>
+    ParseColor(std::string_view text);
+
+    // Getters
+    [[nodiscard]] std::size_t GetSize() const noexcept {
+        return colors.size();
+    }
+    [[nodiscard]] std::span<const PackedColor> GetColors() const noexcept {
+        return colors;
+    }
+
+  private:
+    std::vector<PackedColor> colors;
+};
+
+// Palette described in the config file
+struct PaletteSettings {
+    PaletteType type{PaletteType::Hsv};
+    std::size_t size{Palette::DEFAULT_SIZE};
+    // HSV only
+    float saturation{1.0F};
+    float value{1.0F};
+    // Gradient only
+    std::vector<RGB> stops;
+    // Starting mapping of iterations to colors, see ColorizeParams
+    float density{1.0F};
+    float offset{0.0F};
+
+    [[nodiscard]] Palette Generate() const;
+};
+
+// Mapping of smooth iteration values to palette colors
+// NOTE: Only the palette, density and offset change while cycling, the
+// iteration values stay as they are
+struct ColorizeParams {
+    std::span<const PackedColor> palette;
+    float max_iter;
+    // Palette repetitions between 0 and max_iter iterations
+    float density;
+    // Palette rotation, 1 is the whole palette
+    float offset;
+    // Color of pixels that reached max_iter
+    PackedColor interior;
+
+    // Palette position per iteration
+    // NOTE: Computed the same way by every kernel, so they stay bit-exact
+    [[nodiscard]] constexpr float Scale() const { return density / max_iter; }
+};
+
+// Kernel looking up the color of every value
+// NOTE: out.size() is values.size()
+using ColorizeKernel = void (*)(const ColorizeParams &params,
+                                std::span<const float> values,
+                                std::span<PackedColor> out);
+
+// Scalar reference kernel
+void ColorizeScalar(const ColorizeParams &params,
+                    std::span<const float> values, std::span<PackedColor> out);
+
+#ifdef MANDELBROT_X86_KERNELS
+// Vector kernel, 8 pixels per gather
+// NOTE: Must be called only when IsIsaSupported() returns true
+void ColorizeAvx2(const ColorizeParams &params, std::span<const float> values,
+                  std::span<PackedColor> out);
+#endif
+
+// Colorize kernel for the instruction set, see SupportedIsa()
+// NOTE: AVX-512 hosts use the AVX2 kernel, SSE2 hosts the scalar one
+[[nodiscard]] ColorizeKernel SelectColorizeKernel(Isa isa);
@@ -0,0 +1,128 @@
+#include "perturbation.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <stop_token>
+
+#include "big_fixed.hpp"
+#include "bla.hpp"
+#include "escape_time.hpp"
+
+ReferenceOrbit ReferenceOrbit::Compute(const BigFixed &c_x, const BigFixed &c_y,
+                                       int max_iter, double escape,
+                                       const std::stop_token &stop) {
+    ReferenceOrbit orbit;
+    orbit.c_x = c_x.ToDouble();
+    orbit.c_y = c_y.ToDouble();
+    orbit.points.reserve(
+        std::min(static_cast<std::size_t>(max_iter) + 1, RESERVED_POINTS));
+
+    BigFixed z_x(c_x.GetFractionLimbs());
+    BigFixed z_y(c_x.GetFractionLimbs());
+    for (int iter = 0; iter <= max_iter; ++iter) {
+        const ReferenceOrbit::Point point{z_x.ToDouble(), z_y.ToDouble()};
+        orbit.points.push_back(point);
+        if ((point.x * point.x) + (point.y * point.y) > escape) {
+            break;
+        }
+        if (iter % STOP_INTERVAL == 0 && stop.stop_requested()) {
+            break;
+        }
+
+        // Z = Z^2 + C
+        const auto z2_x = z_x * z_x;
+        const auto z2_y = z_y * z_y;
+        const auto z_xy = z_x * z_y;
+        z_y = z_xy + z_xy + c_y;
+        z_x = z2_x - z2_y + c_x;
+    }
+    return orbit;
+}
+
+std::optional<EscapeResult>
+PerturbEscapeTime(const ReferenceOrbit &orbit, const BlaTable *bla,
+                  double dc_x, double dc_y, int max_iter, double escape,
+                  double glitch_tolerance) {
+    const double tolerance2 = glitch_tolerance * glitch_tolerance;
+    const double c_x = orbit.c_x + dc_x;
+    const double c_y = orbit.c_y + dc_y;
+    const int last = static_cast<int>(orbit.GetSize()) - 1;
+
+    double d_x = 0.0;
+    double d_y = 0.0;
+    double z_x = 0.0;
+    double z_y = 0.0;
+    int iter = 0;
+    // Index of the reference point, restarts when the delta is rebased
+    int ref_iter = 0;
+    int skipped = 0;
+    while (iter < max_iter) {
+        const auto &ref = orbit.points[static_cast<std::size_t>(ref_iter)];
+        z_x = ref.x + d_x;
+        z_y = ref.y + d_y;
+        const double z_norm = (z_x * z_x) + (z_y * z_y);
+
+        // Escaped, do one more step like the shader does
+        if (z_norm > escape) {
+            const double next_z_x = (z_x * z_x) - (z_y * z_y) + c_x;
+            const double next_z_y = (2.0 * z_x * z_y) + c_y;
+            return EscapeResult{iter + 1, next_z_x, next_z_y, skipped};
+        }
+
+        // The delta is as large as the orbit itself, its low bits are lost
+        const double ref_norm = (ref.x * ref.x) + (ref.y * ref.y);
+        if (z_norm < tolerance2 * ref_norm) {
+            return std::nullopt;
+        }
+
+        // Without glitch detection the delta is rebased onto the start of
+        // the orbit, where Z_0 = 0, when the reference escaped first or when
+        // z is closer to 0 than the delta
+        // NOTE: The pixel keeps its dc, so rebasing loses no precision
+        const double d_norm = (d_x * d_x) + (d_y * d_y);
+        if (glitch_tolerance == 0.0 && ref_iter > 0 &&
+            (ref_iter == last || z_norm < d_norm)) {
+            d_x = z_x;
+            d_y = z_y;
+            ref_iter = 0;
+            continue;
+        }
+
+        // The reference escaped first
+        if (ref_iter == last) {
+            return std::nullopt;
+        }
+
+        // Skip iterations while d^2 is negligible
+        // NOTE: After a rebase the orbit may reach past max_iter
+        const BlaStep *step =
+            bla != nullptr ? bla->Lookup(ref_iter, d_norm) : nullptr;
+        if (step != nullptr && step->length <= max_iter - iter) {
+            const double next_d_x = (step->a_x * d_x) - (step->a_y * d_y) +
+                                    (step->b_x * dc_x) - (step->b_y * dc_y);
+            const double next_d_y = (step->a_x * d_y) + (step->a_y * d_x) +
+                                    (step->b_x * dc_y) + (step->b_y * dc_x);
+            d_x = next_d_x;
+            d_y = next_d_y;
+            iter += step->length;
+            ref_iter += step->length;
+            skipped += step->length;
+            continue;
+        }
+
+        // d = 2 Z d + d^2 + dc
+        const double next_d_x =
+            (2.0 * ((ref.x * d_x) - (ref.y * d_y))) + (d_x * d_x) -
+            (d_y * d_y) + dc_x;
+        const double next_d_y =
+            (2.0 * ((ref.x * d_y) + (ref.y * d_x))) + (2.0 * d_x * d_y) + dc_y;
+        d_x = next_d_x;
+        d_y = next_d_y;
+        ++iter;
+        ++ref_iter;
+    }
+
+    // Interior point
+    return EscapeResult{max_iter, z_x, z_y, skipped};
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <stop_token>
+#include <vector>
+
+#include "big_fixed.hpp"
+#include "escape_time.hpp"
+
+class BlaTable;
+
+// Source: https://mathr.co.uk/blog/2021-05-14_deep_zoom_theory_and_practice.html
+
+// Orbit of the reference point, computed once per frame in high precision
+// and stored as doubles
+struct ReferenceOrbit {
+    // One point of the orbit
+    struct Point {
+        double x;
+        double y;
+    };
+
+    // Reference point c
+    double c_x{};
+    double c_y{};
+    // Z_n for n = 0, 1, ... until the orbit escapes or reaches max_iter
+    std::vector<Point> points;
+
+    // Iterations between two checks of the stop token in Compute()
+    static constexpr int STOP_INTERVAL = 1024;
+    // Points reserved up front by Compute(), longer orbits grow the vector
+    // NOTE: Most references escape long before max_iter, reserving the whole
+    // limit would allocate 16 bytes per iteration for every reference
+    static constexpr std::size_t RESERVED_POINTS = std::size_t{1} << 16U;
+
+    // Iterate the reference point in high precision
+    // NOTE: A stop request ends the orbit early, pixels iterated against the
+    // shortened orbit come out glitched
+    [[nodiscard]] static ReferenceOrbit
+    Compute(const BigFixed &c_x, const BigFixed &c_y, int max_iter,
+            double escape, const std::stop_token &stop = {});
+
+    [[nodiscard]] std::size_t GetSize() const noexcept {
+        return points.size();
+    }
+};
+
+// Iterate a pixel as a delta from the reference orbit
+// z_n = Z_n + d_n, d_{n+1} = 2 Z_n d_n + d_n^2 + dc
+// NOTE: dc is the offset of the pixel from the reference point, the result
+// has the same meaning as EscapeTime()
+// Returns an empty optional for glitched pixels, i.e. when the delta loses
+// precision, |Z_n + d_n| < glitch_tolerance * |Z_n| (Pauldelbrot's
+// criterion), or when the reference escapes first
+// NOTE: glitch_tolerance 0 disables the detection, the delta is rebased onto
+// the start of the orbit instead, so pixels outliving the reference keep
+// their precision
+// When a BLA table is given, iterations it approximates are skipped in bulk
+[[nodiscard]] std::optional<EscapeResult>
+PerturbEscapeTime(const ReferenceOrbit &orbit, const BlaTable *bla,
+                  double dc_x, double dc_y, int max_iter, double escape,
+                  double glitch_tolerance);
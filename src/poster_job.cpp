@@ -0,0 +1,255 @@
+#include "poster_job.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include "raylib-cpp.hpp"
+#include "toml.hpp"
+
+#include "big_fixed.hpp"
+#include "config.hpp"
+#include "engine.hpp"
+#include "mandelbrot_error.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Hash of the bytes of a file, the same in every build
+// Source: FNV-1a, http://www.isthe.com/chongo/tech/comp/fnv/
+std::uint64_t HashFile(const std::filesystem::path &path) {
+    constexpr std::uint64_t offset_basis = 0xcbf29ce484222325ULL;
+    constexpr std::uint64_t prime = 0x100000001b3ULL;
+    std::ifstream stream(path, std::ios::binary);
+    std::uint64_t hash = offset_basis;
+    for (auto byte = std::istreambuf_iterator<char>(stream);
+         byte != std::istreambuf_iterator<char>(); ++byte) {
+        hash ^= static_cast<unsigned char>(*byte);
+        hash *= prime;
+    }
+    return hash;
+}
+}  // namespace
+
+// Loads the job file
+std::expected<PosterJob, MandelbrotError>
+PosterJob::Load(const std::filesystem::path &job_file) {
+    // Validate job path
+    if (!std::filesystem::exists(job_file)) {
+        auto error_msg =
+            std::format("Job file does not exist -> {}", job_file.string());
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::FileNotFound, error_msg));
+    }
+
+    // Parse job file
+    auto parse_result = toml::try_parse(job_file);
+
+    // Check if parsing succeeded
+    if (!parse_result.is_ok()) {
+        const auto &errors = parse_result.unwrap_err();
+        // Use the first error and convert it to string
+        std::string first_msg = format_error(errors.at(0));
+        auto error_msg =
+            std::format("Failed to parse job file -> {}", first_msg);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::ParseError, error_msg));
+    }
+
+    // Extract the root TOML value
+    const auto &root = parse_result.unwrap();
+
+    // Check if poster table exists
+    if (!Config::HasTable(root, POSTER_TABLE_NAME)) {
+        auto error_msg = std::format("Job file must contain a table [{}]",
+                                     POSTER_TABLE_NAME);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::ParseError, error_msg));
+    }
+
+    // Create an empty job object
+    PosterJob job{};
+    job.fingerprint = HashFile(job_file);
+
+    // Load poster related configuration
+    auto poster_res = job.LoadPosterConfig(root, job_file.parent_path());
+    if (!poster_res) {
+        return std::unexpected(poster_res.error());
+    }
+
+    // Load fractal and palette tables like the config file
+    auto fractal_res = job.settings.LoadFractalConfig(root);
+    if (!fractal_res) {
+        return std::unexpected(fractal_res.error());
+    }
+    auto palette_res = job.settings.LoadPaletteConfig(root);
+    if (!palette_res) {
+        return std::unexpected(palette_res.error());
+    }
+
+    // Job loaded successfully
+    return job;
+}
+
+std::expected<void, MandelbrotError>
+PosterJob::LoadPosterConfig(const tomlRoot &root,
+                            const std::filesystem::path &job_directory) {
+    // Table with poster options
+    const auto *const table_name = POSTER_TABLE_NAME.data();
+    const auto &table = root.at(table_name);
+    const auto option_name = [](Option option) {
+        return OPTIONS_STR.at(static_cast<size_t>(option));
+    };
+
+    // Common error message templates
+    constexpr std::string_view missing_error_msg{
+        "Missing poster option -> {}"};
+    constexpr std::string_view range_error_msg{
+        "Poster option {} out of range [{}..{}] -> {}"};
+
+    // Image file, relative to the job file
+    const auto file_name = option_name(Option::File);
+    auto found_file =
+        Config::FindOptional<std::string>(table, file_name, "string");
+    if (!found_file) {
+        return std::unexpected(found_file.error());
+    }
+    if (!found_file->has_value() || (*found_file)->empty()) {
+        auto error_msg = std::format(missing_error_msg, file_name);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::MissingOption, error_msg));
+    }
+    file = job_directory / **found_file;
+
+    // Int options share the same validation, the range is inclusive
+    // NOTE: The strip height and anti-aliasing are optional, the size and
+    // iterations are not
+    for (const auto &[option, min, max, target, required] :
+         {std::tuple{Option::Width, POSTER_SIZE_MIN, POSTER_SIZE_MAX, &width,
+                     true},
+          std::tuple{Option::Height, POSTER_SIZE_MIN, POSTER_SIZE_MAX,
+                     &height, true},
+          std::tuple{Option::StripHeight, 1, POSTER_SIZE_MAX, &strip_height,
+                     false},
+          std::tuple{Option::MaxIter, 1, MAX_ITER_MAX, &max_iter, true},
+          std::tuple{Option::Antialias, 1, AntialiasSettings::GRID_MAX,
+                     &antialias, false}}) {
+        const auto name = option_name(option);
+        auto found = Config::FindOptional<int>(table, name, "int");
+        if (!found) {
+            return std::unexpected(found.error());
+        }
+        if (!found->has_value()) {
+            if (!required) {
+                continue;
+            }
+            auto error_msg = std::format(missing_error_msg, name);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::MissingOption, error_msg));
+        }
+        const int value = **found;
+        if (value < min || value > max) {
+            auto error_msg =
+                std::format(range_error_msg, name, min, max, value);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        *target = value;
+    }
+
+    // Memory of the renderer grows with the strip, not with the poster
+    strip_height = std::min(strip_height, height);
+    const std::int64_t strip_pixels =
+        static_cast<std::int64_t>(width) * strip_height;
+    if (strip_pixels > STRIP_PIXELS_MAX) {
+        auto error_msg = std::format(
+            "Poster strips of {}x{} exceed {} pixels, lower {}", width,
+            strip_height, STRIP_PIXELS_MAX,
+            option_name(Option::StripHeight));
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::InvalidValue, error_msg));
+    }
+
+    // Magnification relative to the default view
+    const auto zoom_name = option_name(Option::Zoom);
+    auto found_zoom = Config::FindOptional<double>(table, zoom_name, "float");
+    if (!found_zoom) {
+        return std::unexpected(found_zoom.error());
+    }
+    const double zoom = found_zoom->value_or(1.0);
+    if (!std::isfinite(zoom) || zoom <= 0.0) {
+        auto error_msg = std::format("Poster option {} must be positive -> {}",
+                                     zoom_name, zoom);
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::InvalidValue, error_msg));
+    }
+    view.width = width;
+    view.height = height;
+    view.span_x = Viewport::DEFAULT_SPAN_X / zoom;
+    view.span_y =
+        view.span_x * static_cast<double>(height) / static_cast<double>(width);
+
+    // Centers are decimal strings, doubles lose deep zoom positions
+    const auto limbs =
+        std::max(view.RequiredLimbs(), BigFixed::DEFAULT_FRACTION_LIMBS);
+    for (const auto &[option, target] :
+         {std::pair{Option::CenterX, &view.center_x},
+          std::pair{Option::CenterY, &view.center_y}}) {
+        const auto name = option_name(option);
+        auto found = Config::FindOptional<std::string>(table, name, "string");
+        if (!found) {
+            return std::unexpected(found.error());
+        }
+        if (!found->has_value()) {
+            auto error_msg = std::format(missing_error_msg, name);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::MissingOption, error_msg));
+        }
+        auto center = BigFixed::FromString(**found, limbs);
+        if (!center.has_value()) {
+            auto error_msg =
+                std::format("Poster option {} is not a decimal number -> {}",
+                            name, **found);
+            return std::unexpected(MandelbrotError(
+                MandelbrotError::Code::InvalidValue, error_msg));
+        }
+        *target = std::move(*center);
+    }
+
+    TraceLog(LOG_INFO,
+             "MANDELBROT_SET: Setting %s -> %dx%d in %d strips of %d rows, "
+             "zoom %g, max_iter %d, antialias %dx%d, %s",
+             table_name, width, height, GetStripCount(), strip_height, zoom,
+             max_iter, antialias, antialias, file.c_str());
+    return {};
+}
+
+int PosterJob::StripRows(int strip) const noexcept {
+    return std::min(strip_height, height - StripRow(strip));
+}
+
+DeepViewport PosterJob::RowsView(int first_row, int rows) const {
+    // Pixel centers of the rows sit where they sit in the whole poster
+    // NOTE: The center moves in high precision, so deep strips do not drift
+    // apart
+    DeepViewport rows_view = view;
+    rows_view.height = rows;
+    rows_view.span_y = view.PixelHeight() * static_cast<double>(rows);
+    const double shift = static_cast<double>(first_row) +
+                         (static_cast<double>(rows) / 2.0) -
+                         (static_cast<double>(height) / 2.0);
+    rows_view.center_y =
+        view.center_y + BigFixed::FromDouble(shift * view.PixelHeight(),
+                                             view.center_y.GetFractionLimbs());
+    return rows_view;
+}
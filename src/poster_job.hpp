@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string_view>
+
+#include "big_fixed.hpp"
+#include "config.hpp"
+#include "enum_list.hpp"
+#include "formula.hpp"
+#include "mandelbrot_error.hpp"
+#include "palette.hpp"
+#include "viewport.hpp"
+
+// Single image larger than any window, rendered by the PosterRenderer in
+// horizontal strips, loaded from a TOML job file with the [fractal] and
+// [palette] tables of the config file
+// NOTE: The image is written as a binary PPM, the only format of the
+// project that stores rows in order without a size limit, so strips are
+// appended as they finish
+class PosterJob {
+  public:
+    enum class Option : std::uint8_t {
+#define X(name, str) name,
+        POSTER_OPTION_LIST(X)
+#undef X
+    };
+
+    // Number of poster options
+    static constexpr size_t OPTIONS_COUNT{0 POSTER_OPTION_LIST(X_ENUM_COUNT)};
+
+    // Array of string names for poster options
+    static constexpr std::array<std::string_view, OPTIONS_COUNT> OPTIONS_STR{
+#define X(name, str) str,
+        POSTER_OPTION_LIST(X)
+#undef X
+    };
+
+    // Table name in the job file
+    static constexpr std::string_view POSTER_TABLE_NAME{"poster"};
+
+    // Job boundary values
+    // NOTE: A strip holds an iteration value and a color per pixel, the
+    // pixel limit keeps one strip below 1 GiB
+    static constexpr int POSTER_SIZE_MIN = 16;
+    static constexpr int POSTER_SIZE_MAX = 1 << 20;
+    static constexpr int STRIP_HEIGHT_DEFAULT = 64;
+    static constexpr std::int64_t STRIP_PIXELS_MAX = std::int64_t{1} << 27;
+    static constexpr int MAX_ITER_MAX = 100000000;
+
+    // Loads the job file, a relative image file is placed next to it
+    [[nodiscard]] static std::expected<PosterJob, MandelbrotError>
+    Load(const std::filesystem::path &job_file);
+
+    // Number of strips, the last one may be lower than the others
+    [[nodiscard]] int GetStripCount() const noexcept {
+        return (height + strip_height - 1) / strip_height;
+    }
+    // First image row and number of rows of the strip
+    [[nodiscard]] int StripRow(int strip) const noexcept {
+        return strip * strip_height;
+    }
+    [[nodiscard]] int StripRows(int strip) const noexcept;
+
+    // View of the strip, the rows of the poster it covers with the pixel
+    // spacing of the poster
+    [[nodiscard]] DeepViewport StripView(int strip) const {
+        return RowsView(StripRow(strip), StripRows(strip));
+    }
+    // View of the rows [first_row, first_row + rows) of the poster
+    [[nodiscard]] DeepViewport RowsView(int first_row, int rows) const;
+
+    // Getters
+    [[nodiscard]] const std::filesystem::path &GetFile() const noexcept {
+        return file;
+    }
+    [[nodiscard]] int GetWidth() const noexcept { return width; }
+    [[nodiscard]] int GetHeight() const noexcept { return height; }
+    [[nodiscard]] int GetStripHeight() const noexcept { return strip_height; }
+    [[nodiscard]] int GetMaxIter() const noexcept { return max_iter; }
+    // Side of the sub-sample grid of edge pixels, 1 renders one sample per
+    // pixel, see Engine::RenderAntialiased()
+    [[nodiscard]] int GetAntialias() const noexcept { return antialias; }
+    // Hash of the job file, a restart only continues the image of the same
+    // job
+    [[nodiscard]] std::uint64_t GetFingerprint() const noexcept {
+        return fingerprint;
+    }
+    [[nodiscard]] const DeepViewport &GetView() const noexcept { return view; }
+    [[nodiscard]] const FractalSettings &GetFractalSettings() const noexcept {
+        return settings.fractal_settings;
+    }
+    [[nodiscard]] const PaletteSettings &GetPaletteSettings() const noexcept {
+        return settings.palette_settings;
+    }
+
+  private:
+    std::filesystem::path file;
+    int width{};
+    int height{};
+    int strip_height{STRIP_HEIGHT_DEFAULT};
+    int max_iter{};
+    int antialias{1};
+    std::uint64_t fingerprint{};
+    // View of the whole poster
+    DeepViewport view;
+    // Fractal and palette tables, loaded like in the config file
+    Config settings;
+
+    using tomlRoot = Config::tomlRoot;
+
+    // Load section from job file
+    std::expected<void, MandelbrotError>
+    LoadPosterConfig(const tomlRoot &root,
+                     const std::filesystem::path &job_directory);
+};
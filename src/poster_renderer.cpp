@@ -0,0 +1,378 @@
+#include "poster_renderer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <ios>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "raylib-cpp.hpp"
+
+#include "bounded_queue.hpp"
+#include "engine.hpp"
+#include "iteration_buffer.hpp"
+#include "mandelbrot_error.hpp"
+#include "palette.hpp"
+#include "poster_job.hpp"
+
+PosterRenderer::PosterRenderer(PosterJob job, PosterSettings settings)
+    : job(std::move(job)), settings(settings) {
+    this->settings.queue_capacity =
+        std::max<std::size_t>(this->settings.queue_capacity, 1);
+    this->settings.max_strips = std::max(this->settings.max_strips, 0);
+}
+
+namespace {
+// Marks the end of the strips in the write queue
+constexpr std::size_t END_OF_STRIPS = std::numeric_limits<std::size_t>::max();
+
+// Bytes of a pixel in the image, PPM stores RGB without alpha
+constexpr std::size_t PPM_PIXEL_BYTES = 3;
+
+// Rows of the neighbouring strips rendered above and below an anti-aliased
+// strip, the edge test of a pixel looks one row up and down
+constexpr int EDGE_OVERLAP_ROWS = 1;
+
+// Rendered and colored strip of the poster
+struct ColoredStrip {
+    IterationBuffer buffer;
+    std::vector<PackedColor> pixels;
+    int strip{};
+    // Overlap rows above the first row of the strip
+    int first_row{};
+};
+}  // namespace
+
+struct PosterRenderer::Pipeline {
+    Pipeline(const PosterJob &job, const PosterSettings &settings)
+        : engine(EngineSettings{.max_iter = job.GetMaxIter(),
+                                .fractal = job.GetFractalSettings(),
+                                .thread_count = settings.thread_count}),
+          palette(job.GetPaletteSettings().Generate()),
+          strips(settings.queue_capacity + 2), free_strips(strips.size()),
+          write_queue(settings.queue_capacity) {
+        // NOTE: One strip is rendered, one is written and the others wait in
+        // the queue, memory does not grow with the height of the poster
+        const int overlap = job.GetAntialias() > 1 ? 2 * EDGE_OVERLAP_ROWS : 0;
+        for (std::size_t i = 0; i < strips.size(); ++i) {
+            strips[i].buffer.Resize(job.GetWidth(),
+                                    job.GetStripHeight() + overlap);
+            strips[i].pixels.resize(strips[i].buffer.GetSize());
+            free_strips.TryPush(std::size_t{i});
+        }
+        engine.SetStopToken(stop.get_token());
+    }
+
+    // Stop rendering and writing, only the first error is kept
+    void Fail(MandelbrotError failure) {
+        {
+            const std::scoped_lock lock(error_mutex);
+            if (!error.has_value()) {
+                error = std::move(failure);
+            }
+        }
+        stop.request_stop();
+    }
+
+    Engine engine;
+    Palette palette;
+
+    // Strip storage, the threads pass their indices
+    std::vector<ColoredStrip> strips;
+    BoundedQueue<std::size_t> free_strips;
+    // Colored strips in the order of the image
+    // NOTE: A single renderer and a single writer keep the queue in order
+    BoundedQueue<std::size_t> write_queue;
+    // Used by the writer thread only
+    std::ofstream image;
+
+    // Cancels the strip being rendered and wakes a waiting thread
+    std::stop_source stop;
+    std::mutex error_mutex;
+    std::optional<MandelbrotError> error;
+};
+
+std::string PosterRenderer::PpmHeader(int width, int height) {
+    return std::format("P6\n{} {}\n255\n", width, height);
+}
+
+std::filesystem::path
+PosterRenderer::ProgressPath(const std::filesystem::path &file) {
+    auto path = file;
+    path += ".progress";
+    return path;
+}
+
+std::uintmax_t PosterRenderer::ImageSize(int strips) const {
+    const int rows = std::min(job.StripRow(strips), job.GetHeight());
+    return PpmHeader(job.GetWidth(), job.GetHeight()).size() +
+           (static_cast<std::uintmax_t>(rows) *
+            static_cast<std::uintmax_t>(job.GetWidth()) * PPM_PIXEL_BYTES);
+}
+
+int PosterRenderer::ReadProgress() const {
+    // NOTE: The progress is only trusted for the same job file and an image
+    // holding every strip it counts, anything else starts over
+    std::ifstream progress(ProgressPath(job.GetFile()));
+    std::uint64_t fingerprint = 0;
+    int strips = 0;
+    if (!(progress >> std::hex >> fingerprint >> std::dec >> strips) ||
+        fingerprint != job.GetFingerprint() || strips < 0 ||
+        strips > job.GetStripCount()) {
+        return 0;
+    }
+    std::error_code error_code;
+    const auto size = std::filesystem::file_size(job.GetFile(), error_code);
+    if (error_code || size < ImageSize(strips)) {
+        return 0;
+    }
+    return strips;
+}
+
+std::expected<void, MandelbrotError>
+PosterRenderer::WriteProgress(int strips) const {
+    // Replace the progress in one step, a stop while writing keeps the old
+    // one
+    const auto path = ProgressPath(job.GetFile());
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream progress(temp_path, std::ios::trunc);
+        progress << std::hex << job.GetFingerprint() << ' ' << std::dec
+                 << strips << '\n';
+        if (!progress.flush()) {
+            auto error_msg =
+                std::format("Failed to write poster progress -> {}",
+                            temp_path.string());
+            return std::unexpected(
+                MandelbrotError(MandelbrotError::Code::WriteError, error_msg));
+        }
+    }
+    std::error_code error_code;
+    std::filesystem::rename(temp_path, path, error_code);
+    if (error_code) {
+        auto error_msg =
+            std::format("Failed to write poster progress {} -> {}",
+                        path.string(), error_code.message());
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::WriteError, error_msg));
+    }
+    return {};
+}
+
+std::expected<void, MandelbrotError>
+PosterRenderer::OpenImage(Pipeline &pipeline, int completed) const {
+    const auto &file = job.GetFile();
+    if (completed > 0) {
+        // Drop a strip that was written only in part
+        std::error_code error_code;
+        std::filesystem::resize_file(file, ImageSize(completed), error_code);
+        if (!error_code) {
+            pipeline.image.open(file, std::ios::binary | std::ios::app);
+        }
+    } else {
+        pipeline.image.open(file, std::ios::binary | std::ios::trunc);
+        const auto header = PpmHeader(job.GetWidth(), job.GetHeight());
+        pipeline.image.write(header.data(),
+                             static_cast<std::streamsize>(header.size()));
+    }
+    if (!pipeline.image) {
+        auto error_msg =
+            std::format("Failed to open poster image -> {}", file.string());
+        return std::unexpected(
+            MandelbrotError(MandelbrotError::Code::WriteError, error_msg));
+    }
+    return {};
+}
+
+std::expected<PosterStats, MandelbrotError> PosterRenderer::Run() {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Create the directory of the image
+    const auto directory = job.GetFile().parent_path();
+    if (!directory.empty()) {
+        std::error_code error_code;
+        std::filesystem::create_directories(directory, error_code);
+        if (error_code) {
+            auto error_msg =
+                std::format("Failed to create output directory {} -> {}",
+                            directory.string(), error_code.message());
+            return std::unexpected(
+                MandelbrotError(MandelbrotError::Code::WriteError, error_msg));
+        }
+    }
+
+    // Continue behind the strips of a stopped run
+    PosterStats stats;
+    const int strip_count = job.GetStripCount();
+    const int first = ReadProgress();
+    const int last = settings.max_strips > 0
+                         ? std::min(first + settings.max_strips, strip_count)
+                         : strip_count;
+    stats.resumed_strips = first;
+
+    Pipeline pipeline(job, settings);
+    auto opened = OpenImage(pipeline, first);
+    if (!opened) {
+        return std::unexpected(opened.error());
+    }
+    const double strip_mib =
+        static_cast<double>(pipeline.strips.front().buffer.GetSize()) *
+        static_cast<double>(sizeof(float) + sizeof(PackedColor)) /
+        (1024.0 * 1024.0);
+    TraceLog(LOG_INFO,
+             "MANDELBROT_SET: Poster rendering strips %d..%d of %d on %zu "
+             "threads, %zu strips of %.1f MiB in memory",
+             first + 1, last, strip_count, pipeline.engine.GetThreadCount(),
+             pipeline.strips.size(), strip_mib);
+
+    {
+        const std::jthread writer(
+            [this, &pipeline, &stats]() { WriteLoop(pipeline, stats); });
+        RenderLoop(pipeline, first, last, stats);
+    }
+    pipeline.image.close();
+    if (pipeline.error.has_value()) {
+        return std::unexpected(*pipeline.error);
+    }
+
+    // NOTE: A complete image needs no progress, running the job again
+    // renders a new one
+    stats.complete = stats.resumed_strips + stats.strips == strip_count;
+    if (stats.complete) {
+        std::error_code error_code;
+        std::filesystem::remove(ProgressPath(job.GetFile()), error_code);
+    }
+    stats.duration = std::chrono::steady_clock::now() - start;
+
+    const double seconds =
+        std::chrono::duration<double>(stats.duration).count();
+    TraceLog(LOG_INFO,
+             "MANDELBROT_SET: Poster %s, %d strips in %.2f s (render %.2f s, "
+             "write %.2f s), %d/%d strips in the image",
+             stats.complete ? "finished" : "stopped", stats.strips, seconds,
+             std::chrono::duration<double>(stats.render).count(),
+             std::chrono::duration<double>(stats.write).count(),
+             stats.resumed_strips + stats.strips, strip_count);
+    return stats;
+}
+
+void PosterRenderer::RenderLoop(Pipeline &pipeline, int first, int last,
+                                PosterStats &stats) {
+    const auto stop = pipeline.stop.get_token();
+    const auto &palette_settings = job.GetPaletteSettings();
+    for (int strip = first; strip < last; ++strip) {
+        // Take free storage, waits while the writer holds all of it
+        const auto index = pipeline.free_strips.Pop(stop);
+        if (!index) {
+            return;
+        }
+
+        const auto render_start = std::chrono::steady_clock::now();
+        // NOTE: Anti-aliased strips include rows of their neighbours, so
+        // the edges of the seam rows are found like in a single image. The
+        // last strip may be lower, its storage only shrinks
+        auto &colored = pipeline.strips[*index];
+        const bool overlap = job.GetAntialias() > 1;
+        const int above = overlap && strip > 0 ? EDGE_OVERLAP_ROWS : 0;
+        const int below =
+            overlap && strip + 1 < job.GetStripCount() ? EDGE_OVERLAP_ROWS : 0;
+        const int rows = above + job.StripRows(strip) + below;
+        colored.strip = strip;
+        colored.first_row = above;
+        colored.pixels.resize(static_cast<std::size_t>(job.GetWidth()) *
+                              static_cast<std::size_t>(rows));
+        const auto view = job.RowsView(job.StripRow(strip) - above, rows);
+        const auto render_stats =
+            job.GetAntialias() > 1
+                ? pipeline.engine.RenderAntialiased(
+                      view, colored.buffer, pipeline.palette,
+                      palette_settings.density, palette_settings.offset,
+                      colored.pixels,
+                      AntialiasSettings{.grid = job.GetAntialias()})
+                : pipeline.engine.RenderDeep(view, colored.buffer);
+        if (render_stats.cancelled) {
+            return;
+        }
+        if (job.GetAntialias() == 1) {
+            pipeline.engine.Colorize(colored.buffer, pipeline.palette,
+                                     palette_settings.density,
+                                     palette_settings.offset, colored.pixels);
+        }
+        const auto render_end = std::chrono::steady_clock::now();
+        stats.render += render_end - render_start;
+        stats.pixels += render_stats.pixels;
+        stats.iterations += render_stats.iterations;
+
+        if (!pipeline.write_queue.Push(*index, stop)) {
+            return;
+        }
+        TraceLog(LOG_INFO,
+                 "MANDELBROT_SET: Strip %d/%d rendered in %.1f ms (%s)",
+                 strip + 1, job.GetStripCount(),
+                 std::chrono::duration<double, std::milli>(render_end -
+                                                           render_start)
+                     .count(),
+                 PRECISION_STR.at(static_cast<size_t>(render_stats.precision))
+                     .data());
+    }
+    pipeline.write_queue.Push(END_OF_STRIPS, stop);
+}
+
+void PosterRenderer::WriteLoop(Pipeline &pipeline, PosterStats &stats) {
+    const auto stop = pipeline.stop.get_token();
+    const auto width = static_cast<std::size_t>(job.GetWidth());
+    std::vector<char> row(width * PPM_PIXEL_BYTES);
+    while (true) {
+        const auto index = pipeline.write_queue.Pop(stop);
+        if (!index || *index == END_OF_STRIPS) {
+            break;
+        }
+
+        // Drop the alpha of every pixel and the overlap rows
+        // NOTE: Packed colors hold the bytes in RGBA order
+        const auto write_start = std::chrono::steady_clock::now();
+        const auto &colored = pipeline.strips[*index];
+        const int last_row = colored.first_row + job.StripRows(colored.strip);
+        for (int y = colored.first_row; y < last_row; ++y) {
+            const auto *pixel =
+                colored.pixels.data() + (static_cast<std::size_t>(y) * width);
+            for (std::size_t x = 0; x < width; ++x, ++pixel) {
+                std::memcpy(&row[x * PPM_PIXEL_BYTES], pixel, PPM_PIXEL_BYTES);
+            }
+            pipeline.image.write(row.data(),
+                                 static_cast<std::streamsize>(row.size()));
+        }
+
+        // The progress only counts strips that reached the file
+        if (!pipeline.image.flush()) {
+            auto error_msg = std::format("Failed to write poster image -> {}",
+                                         job.GetFile().string());
+            pipeline.Fail(
+                MandelbrotError(MandelbrotError::Code::WriteError, error_msg));
+            break;
+        }
+        auto saved = WriteProgress(colored.strip + 1);
+        if (!saved) {
+            pipeline.Fail(std::move(saved.error()));
+            break;
+        }
+        stats.write += std::chrono::steady_clock::now() - write_start;
+        ++stats.strips;
+        pipeline.free_strips.Push(*index, stop);
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+
+#include "mandelbrot_error.hpp"
+#include "poster_job.hpp"
+
+// Settings of the PosterRenderer
+struct PosterSettings {
+    // Render worker threads, 0 uses all hardware threads
+    std::size_t thread_count{0};
+    // Colored strips waiting for the writer, the renderer only waits for it
+    // when the queue is full
+    std::size_t queue_capacity{2};
+    // Strips rendered by one run, 0 renders every remaining strip
+    int max_strips{0};
+};
+
+// Statistics of a poster run
+struct PosterStats {
+    // Strips written by this run and strips kept from a previous one
+    int strips{};
+    int resumed_strips{};
+    // The image holds every strip
+    bool complete{};
+    std::chrono::nanoseconds duration{};
+    // Time spent rendering and coloring, and writing the strips
+    std::chrono::nanoseconds render{};
+    std::chrono::nanoseconds write{};
+    std::uint64_t pixels{};
+    std::uint64_t iterations{};
+};
+
+// Renders a PosterJob strip by strip with the CPU engine and appends every
+// finished strip to the image file
+// NOTE: Only a few strips are in memory at once, a writer thread takes them
+// from a lock-free bounded queue in order. After every strip the number of
+// strips in the image is saved next to it, a run that was stopped continues
+// behind the last complete strip
+class PosterRenderer {
+  public:
+    explicit PosterRenderer(PosterJob job, PosterSettings settings = {});
+
+    // Delete copy operations
+    PosterRenderer(const PosterRenderer &) = delete;
+    PosterRenderer &operator=(const PosterRenderer &) = delete;
+
+    // Delete move operations
+    PosterRenderer(PosterRenderer &&) noexcept = delete;
+    PosterRenderer &operator=(PosterRenderer &&) = delete;
+
+    ~PosterRenderer() = default;
+
+    // Render the missing strips, stops at the first strip that cannot be
+    // written
+    std::expected<PosterStats, MandelbrotError> Run();
+
+    // Header of a binary PPM image of the size
+    [[nodiscard]] static std::string PpmHeader(int width, int height);
+
+    // File with the progress of the image, removed once it is complete
+    [[nodiscard]] static std::filesystem::path
+    ProgressPath(const std::filesystem::path &file);
+
+  private:
+    PosterJob job;
+    PosterSettings settings;
+
+    // Strip buffers, queues and results shared by the render and write
+    // threads of a run
+    struct Pipeline;
+
+    // Strips a previous run of the same job completed, 0 when there is no
+    // image to continue
+    [[nodiscard]] int ReadProgress() const;
+    [[nodiscard]] std::expected<void, MandelbrotError>
+    WriteProgress(int strips) const;
+
+    // Bytes of the image up to the end of the strips
+    [[nodiscard]] std::uintmax_t ImageSize(int strips) const;
+
+    // Open the image behind the completed strips, a new image starts with
+    // the header
+    [[nodiscard]] std::expected<void, MandelbrotError>
+    OpenImage(Pipeline &pipeline, int completed) const;
+
+    // Render and color the strips [first, last), runs on the calling thread
+    void RenderLoop(Pipeline &pipeline, int first, int last,
+                    PosterStats &stats);
+    // Append the colored strips to the image until the end marker
+    void WriteLoop(Pipeline &pipeline, PosterStats &stats);
+};
@@ -0,0 +1,311 @@
+#include "render_thread.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <utility>
+
+#include "raylib-cpp.hpp"
+
+#include "engine.hpp"
+#include "frame_governor.hpp"
+#include "iteration_buffer.hpp"
+#include "palette.hpp"
+#include "resample.hpp"
+#include "tile_cache.hpp"
+#include "tile_store.hpp"
+#include "viewport.hpp"
+
+RenderThread::RenderThread(RenderThreadSettings settings)
+    : settings(std::move(settings)),
+      palette(this->settings.palette.Generate()),
+      thread([this](const std::stop_token &stop) { Run(stop); }) {}
+
+std::uint64_t RenderThread::SetView(const DeepViewport &view) {
+    std::uint64_t view_generation = 0;
+    {
+        const std::scoped_lock lock(mutex);
+        requested_view = view;
+        view_pending = true;
+        view_generation = ++generation;
+        view_stop.request_stop();
+    }
+    view_cv.notify_one();
+    return view_generation;
+}
+
+const RenderedFrame *RenderThread::AcquireFrame() {
+    if (!frames.Acquire()) {
+        return nullptr;
+    }
+    return &frames.Front();
+}
+
+RenderMetrics RenderThread::GetMetrics() const {
+    const std::scoped_lock lock(mutex);
+    return metrics;
+}
+
+void RenderThread::Run(const std::stop_token &stop) {
+    const int full_max_iter = settings.engine.max_iter;
+    auto governor_settings = settings.governor;
+    governor_settings.max_iter = full_max_iter;
+
+    Engine engine(settings.engine);
+    FrameGovernor governor(governor_settings);
+    const auto colorize = SelectColorizeKernel(engine.GetIsa());
+    // Last finished frame, and the frame being rendered, which replaces it
+    // once it is finished
+    // NOTE: A cancelled frame leaves the last finished one untouched, so the
+    // next view can still start from it
+    IterationBuffer buffer;
+    IterationBuffer next;
+    DeepViewport view;
+    std::uint64_t view_generation = 0;
+    // View of the finished frame, max_iter is 0 while it is only a preview
+    DeepViewport rendered_view;
+    int rendered_max_iter = 0;
+    // Pixels of the frame being rendered still showing a resampled preview
+    PendingMask pending;
+    // Undecided orbits of the finished frame while its iteration limit is
+    // being refined
+    ResumeState resume;
+    TileCache cache(settings.tile_cache_bytes);
+    // NOTE: A store that cannot be opened only disables itself
+    std::optional<TileStore> store;
+    if (!settings.tile_store.empty()) {
+        const auto capacity = std::min<std::size_t>(
+            settings.tile_store_bytes / TileStore::TILE_BYTES,
+            std::numeric_limits<std::uint32_t>::max());
+        auto opened = TileStore::Open(settings.tile_store,
+                                      static_cast<std::uint32_t>(capacity));
+        if (opened) {
+            store.emplace(std::move(*opened));
+        } else {
+            TraceLog(LOG_WARNING, "MANDELBROT_SET: Tile store disabled -> %s",
+                     opened.error().GetMessage().c_str());
+        }
+    }
+    // The last frame was rendered below full quality
+    bool refining = false;
+    std::uint64_t sequence = 0;
+
+    // NOTE: Stopping the thread also cancels the frame being rendered
+    const std::stop_callback cancel_frame(stop, [this]() {
+        const std::scoped_lock lock(mutex);
+        view_stop.request_stop();
+    });
+
+    // Counts of the current metrics interval
+    RenderMetrics counts;
+    auto interval_start = std::chrono::steady_clock::now();
+
+    while (!stop.stop_requested()) {
+        if (const auto now = std::chrono::steady_clock::now();
+            now - interval_start >= METRICS_INTERVAL) {
+            ReportMetrics(counts, now - interval_start);
+            counts = {};
+            interval_start = now;
+        }
+
+        // Wait for a new view, or refine the current one
+        // NOTE: Idle waits time out, so the metrics fall to zero
+        bool view_changed = false;
+        {
+            std::unique_lock lock(mutex);
+            const bool ready =
+                view_cv.wait_for(lock, stop, METRICS_INTERVAL, [&]() {
+                    return view_pending || refining;
+                });
+            if (!ready) {
+                continue;
+            }
+            if (view_pending) {
+                view = requested_view;
+                view_generation = generation;
+                view_pending = false;
+                view_changed = true;
+                view_stop = std::stop_source();
+                engine.SetStopToken(view_stop.get_token());
+            }
+        }
+        if (view_changed) {
+            governor.NewView();
+        }
+
+        // Color a frame into the back buffer and publish it, progressive
+        // passes publish their block size
+        // NOTE: Colors are mapped like at full quality, so they do not change
+        // while the iteration limit is refined
+        const auto quality = governor.GetQuality();
+        const auto publish = [&](const IterationBuffer &rendered,
+                                 int block_size, std::size_t reused,
+                                 std::size_t pending_pixels) {
+            auto &frame = frames.Back();
+            frame.width = rendered.GetWidth();
+            frame.height = rendered.GetHeight();
+            frame.pixels.resize(rendered.GetSize());
+            const ColorizeParams params{
+                .palette = palette.GetColors(),
+                .max_iter = static_cast<float>(quality.max_iter),
+                .density = settings.palette.density *
+                           static_cast<float>(quality.max_iter) /
+                           static_cast<float>(full_max_iter),
+                .offset = settings.palette.offset,
+                .interior = PackColor(RGB{})};
+            colorize(params, rendered.Values(), frame.pixels);
+            frame.quality = quality;
+            frame.quality.block_size = block_size;
+            frame.reused_pixels = reused;
+            frame.pending_pixels = pending_pixels;
+            frame.sequence = ++sequence;
+            frame.generation = view_generation;
+            counts.frames += 1.0;
+            if (!frames.Publish()) {
+                counts.dropped_frames += 1.0;
+            }
+        };
+
+        // Render at the quality picked by the governor
+        DeepViewport scaled = view;
+        scaled.width = std::max(
+            static_cast<int>(std::lround(view.width * quality.scale)), 1);
+        scaled.height = std::max(
+            static_cast<int>(std::lround(view.height * quality.scale)), 1);
+        engine.SetMaxIter(quality.max_iter);
+        const auto start = std::chrono::steady_clock::now();
+
+        // A higher iteration limit on the same view continues the undecided
+        // orbits of the last frame, a view moved by whole pixels keeps its
+        // pixels and other new views copy the samples they share with it
+        // NOTE: Only full resolution passes of double precision frames of the
+        // plain Mandelbrot set are moved, see Engine::RenderPan() and
+        // Engine::RenderPending(). Full resolution frames below the full
+        // iteration limit keep their orbits, the governor raises the limit
+        // last
+        const bool resumable = quality.block_size == 1 &&
+                               quality.scale == 1.0 &&
+                               (quality.max_iter < full_max_iter ||
+                                (!view_changed && resume.max_iter > 0 &&
+                                 resume.max_iter == rendered_max_iter));
+        const auto double_view = scaled.ToViewport();
+        const auto previous_view = rendered_view.ToViewport();
+        const bool reusable =
+            rendered_max_iter == quality.max_iter && quality.block_size == 1 &&
+            settings.engine.fractal.IsPlainMandelbrot() &&
+            engine.ResolvePrecision(double_view.PixelWidth()) ==
+                Precision::Double;
+        RenderStats stats;
+        std::size_t reused = 0;
+        if (resumable) {
+            next = buffer;
+            stats = engine.RenderResumable(scaled, next, resume);
+        } else {
+            resume.Clear();
+            if (reusable && PanOffset(previous_view, double_view)) {
+                next = buffer;
+                stats = engine.RenderPan(previous_view, double_view, next);
+                reused = next.GetSize() -
+                         std::min<std::size_t>(stats.pixels, next.GetSize());
+            } else if (reusable && view_changed) {
+                reused = ResampleFrame(previous_view, buffer, double_view,
+                                       next, pending);
+            }
+        }
+        // NOTE: The cache only holds double precision tiles, deeper views
+        // render progressively
+        const bool cached =
+            !resumable && reused == 0 &&
+            (settings.tile_cache_bytes > 0 || store.has_value()) &&
+            quality.block_size == 1 &&
+            (!settings.engine.fractal.IsPlainMandelbrot() ||
+             engine.ResolvePrecision(double_view.PixelWidth()) ==
+                 Precision::Double) &&
+            PlaceInPyramid(double_view).has_value();
+        if (cached) {
+            stats = engine.RenderCached(double_view, next, cache,
+                                        store ? &*store : nullptr);
+        } else if (reused == 0 && !resumable) {
+            // Every pass but the last one, which is the finished frame
+            stats = engine.RenderProgressive(
+                scaled, next,
+                [&](const IterationBuffer &rendered, int block_size) {
+                    if (block_size > quality.block_size) {
+                        publish(rendered, block_size, 0, 0);
+                    }
+                },
+                quality.block_size);
+        } else if (!pending.empty()) {
+            // The preview first, then the pending pixels in passes of one
+            // frame budget each
+            auto remaining = static_cast<std::size_t>(
+                std::ranges::count(pending, std::uint8_t{1}));
+            while (remaining > 0) {
+                publish(next, 1, reused, remaining);
+                const auto pass = engine.RenderPending(
+                    double_view, next, pending, governor.GetBudget());
+                stats.pixels += pass.pixels;
+                stats.iterations += pass.iterations;
+                stats.cancelled_pixels += pass.cancelled_pixels;
+                if (pass.cancelled) {
+                    stats.cancelled = true;
+                    break;
+                }
+                remaining = static_cast<std::size_t>(
+                    std::ranges::count(pending, std::uint8_t{1}));
+            }
+        }
+        pending.clear();
+
+        // NOTE: A newer view is pending, its frame starts right away and the
+        // cost of the partial frame is not reported to the governor
+        if (stats.cancelled) {
+            counts.cancelled_frames += 1.0;
+            counts.wasted_pixels +=
+                static_cast<double>(stats.pixels - stats.cancelled_pixels);
+            counts.wasted_iterations += static_cast<double>(stats.iterations);
+            counts.cancelled_pixels +=
+                static_cast<double>(stats.cancelled_pixels);
+            continue;
+        }
+
+        std::swap(buffer, next);
+        rendered_view = scaled;
+        rendered_max_iter = quality.block_size == 1 ? quality.max_iter : 0;
+        publish(buffer, quality.block_size, reused, 0);
+
+        refining = !governor.IsFullQuality();
+        governor.Update(std::chrono::steady_clock::now() - start,
+                        view_changed);
+    }
+}
+
+void RenderThread::ReportMetrics(const RenderMetrics &counts,
+                                 std::chrono::steady_clock::duration interval) {
+    const double seconds = std::chrono::duration<double>(interval).count();
+    const RenderMetrics rates{
+        .frames = counts.frames / seconds,
+        .cancelled_frames = counts.cancelled_frames / seconds,
+        .dropped_frames = counts.dropped_frames / seconds,
+        .wasted_pixels = counts.wasted_pixels / seconds,
+        .wasted_iterations = counts.wasted_iterations / seconds,
+        .cancelled_pixels = counts.cancelled_pixels / seconds};
+    {
+        const std::scoped_lock lock(mutex);
+        metrics = rates;
+    }
+    if (counts.cancelled_frames > 0.0) {
+        TraceLog(LOG_INFO,
+                 "MANDELBROT_SET: Render thread %.1f frames/s, cancelled "
+                 "%.1f frames/s (%.3g wasted, %.3g skipped pixels/s), "
+                 "dropped %.1f frames/s",
+                 rates.frames, rates.cancelled_frames, rates.wasted_pixels,
+                 rates.cancelled_pixels, rates.dropped_frames);
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "engine.hpp"
+#include "frame_governor.hpp"
+#include "palette.hpp"
+#include "triple_buffer.hpp"
+#include "viewport.hpp"
+
+// Colored frame published by the RenderThread
+struct RenderedFrame {
+    // Size of the rendered buffer, the window size times the quality scale
+    int width{};
+    int height{};
+    std::vector<PackedColor> pixels;
+    FrameQuality quality;
+    // Pixels taken from the previous frame instead of rendered
+    std::size_t reused_pixels{};
+    // Pixels still showing a preview resampled from the previous frame, see
+    // ResampleFrame()
+    std::size_t pending_pixels{};
+    // Number of the frame, counted from 1
+    std::uint64_t sequence{};
+    // Generation of the view, see RenderThread::SetView()
+    std::uint64_t generation{};
+};
+
+// Work of the RenderThread per second, measured over the last full second
+struct RenderMetrics {
+    // Published frames and frames cancelled because their view was left
+    double frames{};
+    double cancelled_frames{};
+    // Published frames replaced before the window took them
+    double dropped_frames{};
+    // Pixels and iterations rendered for cancelled frames, thrown away
+    double wasted_pixels{};
+    double wasted_iterations{};
+    // Pixels cancelled frames never rendered
+    double cancelled_pixels{};
+};
+
+// Settings of the RenderThread
+struct RenderThreadSettings {
+    EngineSettings engine;
+    // NOTE: max_iter is taken from the engine settings
+    GovernorSettings governor;
+    PaletteSettings palette;
+    // Memory of the tile cache, 0 renders without it, see TileCache
+    std::size_t tile_cache_bytes{0};
+    // File keeping tiles between runs, empty renders without it, and the
+    // tile data of a new file, see TileStore
+    std::filesystem::path tile_store{};
+    std::size_t tile_store_bytes{0};
+};
+
+// Thread rendering the requested view with the CPU engine, so slow frames
+// never block the window thread
+// NOTE: Frames are rendered at the quality picked by a FrameGovernor and
+// refined while the view stays the same. Progressive passes and finished
+// frames are colored and exchanged through a lock-free triple buffer, a
+// higher iteration limit continues the orbits of the last frame
+// NOTE: Every view starts a new generation, a new view cancels the frame of
+// the previous one between tiles, so stale frames are never finished
+// NOTE: The last finished frame is kept, a view moved by whole pixels only
+// renders the strips it exposes. Other views sharing samples with it, e.g.
+// zoomed by 2, start from a resampled preview whose pending pixels are
+// refined and published within the frame budget
+// NOTE: Full quality views aligned to the tile pyramid are assembled from
+// cached and stored tiles when the tile cache or store is enabled, see
+// Engine::RenderCached()
+class RenderThread {
+  public:
+    explicit RenderThread(RenderThreadSettings settings);
+
+    // Delete copy operations
+    RenderThread(const RenderThread &) = delete;
+    RenderThread &operator=(const RenderThread &) = delete;
+
+    // Delete move operations
+    RenderThread(RenderThread &&) noexcept = delete;
+    RenderThread &operator=(RenderThread &&) = delete;
+
+    // Cancels the frame being rendered and stops the thread
+    ~RenderThread() = default;
+
+    // Request a view, the frame of the previous view is cancelled, returns
+    // the generation of the new view
+    std::uint64_t SetView(const DeepViewport &view);
+
+    // Newest finished frame, nullptr when none was published since the last
+    // call
+    // NOTE: Only the consumer thread may call it, the frame stays valid until
+    // the next call
+    [[nodiscard]] const RenderedFrame *AcquireFrame();
+
+    [[nodiscard]] RenderMetrics GetMetrics() const;
+
+  private:
+    RenderThreadSettings settings;
+    Palette palette;
+
+    // View requested by SetView(), guarded by mutex
+    mutable std::mutex mutex;
+    std::condition_variable_any view_cv;
+    DeepViewport requested_view;
+    bool view_pending{false};
+    std::uint64_t generation{0};
+    // Cancels the frames of the view being rendered
+    std::stop_source view_stop;
+    RenderMetrics metrics;
+
+    // Interval of the metrics
+    static constexpr std::chrono::seconds METRICS_INTERVAL{1};
+
+    TripleBuffer<RenderedFrame> frames;
+
+    // NOTE: Declared last, so the thread stops before the members it uses
+    // are destroyed
+    std::jthread thread;
+
+    void Run(const std::stop_token &stop);
+    // Turn the counts of the finished interval into rates
+    void ReportMetrics(const RenderMetrics &counts,
+                       std::chrono::steady_clock::duration interval);
+};
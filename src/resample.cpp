@@ -0,0 +1,116 @@
+#include "resample.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "iteration_buffer.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Position of a pixel of the view along one axis of the previous frame
+struct Sample {
+    // Previous pixels to interpolate between and the weight of the second
+    int first;
+    int second;
+    float weight;
+    // Same point as the first previous pixel
+    bool exact;
+};
+
+// Samples of all pixels along one axis, in pixels of the previous frame
+// NOTE: Positions outside of the previous frame are clamped to its edge
+std::vector<Sample> AxisSamples(double origin, double step, int count,
+                                double previous_origin, double previous_step,
+                                int previous_count) {
+    std::vector<Sample> samples(static_cast<std::size_t>(count));
+    const auto last = static_cast<double>(previous_count - 1);
+    for (int i = 0; i < count; ++i) {
+        const double point = origin + (static_cast<double>(i) * step);
+        const double position = (point - previous_origin) / previous_step;
+        const double nearest = std::round(position);
+        const double clamped = std::clamp(position, 0.0, last);
+        const double first = std::floor(clamped);
+
+        auto &sample = samples[static_cast<std::size_t>(i)];
+        sample.exact = std::fabs(position - nearest) <= RESAMPLE_TOLERANCE &&
+                       nearest >= 0.0 && nearest <= last;
+        sample.first = static_cast<int>(sample.exact ? nearest : first);
+        sample.second = std::min(sample.first + 1, previous_count - 1);
+        sample.weight =
+            sample.exact ? 0.0F : static_cast<float>(clamped - first);
+    }
+    return samples;
+}
+}  // namespace
+
+std::optional<std::array<int, 2>> PanOffset(const Viewport &previous,
+                                            const Viewport &view) {
+    if (view.width != previous.width || view.height != previous.height ||
+        view.span_x != previous.span_x || view.span_y != previous.span_y ||
+        view.width <= 0 || view.height <= 0) {
+        return std::nullopt;
+    }
+    const double offset_x =
+        (view.center_x - previous.center_x) / view.PixelWidth();
+    const double offset_y =
+        (view.center_y - previous.center_y) / view.PixelHeight();
+    const double round_x = std::round(offset_x);
+    const double round_y = std::round(offset_y);
+    if (std::fabs(offset_x - round_x) > PAN_TOLERANCE ||
+        std::fabs(offset_y - round_y) > PAN_TOLERANCE ||
+        std::fabs(round_x) >= static_cast<double>(view.width) ||
+        std::fabs(round_y) >= static_cast<double>(view.height)) {
+        return std::nullopt;
+    }
+    return std::array{static_cast<int>(round_x), static_cast<int>(round_y)};
+}
+
+std::size_t ResampleFrame(const Viewport &previous,
+                          const IterationBuffer &previous_buffer,
+                          const Viewport &view, IterationBuffer &buffer,
+                          PendingMask &pending) {
+    buffer.Resize(view.width, view.height);
+    pending.assign(buffer.GetSize(), 1);
+    if (previous_buffer.GetWidth() != previous.width ||
+        previous_buffer.GetHeight() != previous.height ||
+        previous_buffer.GetSize() == 0) {
+        std::ranges::fill(buffer.Values(), 0.0F);
+        return 0;
+    }
+
+    const auto columns =
+        AxisSamples(view.OriginX(), view.PixelWidth(), view.width,
+                    previous.OriginX(), previous.PixelWidth(), previous.width);
+    const auto rows = AxisSamples(view.OriginY(), view.PixelHeight(),
+                                  view.height, previous.OriginY(),
+                                  previous.PixelHeight(), previous.height);
+
+    std::size_t copied = 0;
+    for (int y = 0; y < view.height; ++y) {
+        const auto &row = rows[static_cast<std::size_t>(y)];
+        const auto first_row = previous_buffer.Row(row.first);
+        const auto second_row = previous_buffer.Row(row.second);
+        auto out = buffer.Row(y);
+        for (std::size_t x = 0; x < out.size(); ++x) {
+            const auto &column = columns[x];
+            const auto first = static_cast<std::size_t>(column.first);
+            const auto second = static_cast<std::size_t>(column.second);
+            if (row.exact && column.exact) {
+                out[x] = first_row[first];
+                pending[(static_cast<std::size_t>(y) * out.size()) + x] = 0;
+                ++copied;
+                continue;
+            }
+            const float top = std::lerp(first_row[first], first_row[second],
+                                        column.weight);
+            const float bottom = std::lerp(second_row[first],
+                                           second_row[second], column.weight);
+            out[x] = std::lerp(top, bottom, row.weight);
+        }
+    }
+    return copied;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "iteration_buffer.hpp"
+#include "viewport.hpp"
+
+// Pixels of a frame whose value is only a preview, 1 for pending pixels
+using PendingMask = std::vector<std::uint8_t>;
+
+// Largest distance in pixels between two samples treated as the same point
+constexpr double RESAMPLE_TOLERANCE = 1e-3;
+
+// Largest distance in pixels from a whole number of pixels still treated as
+// a pan, see PanOffset()
+constexpr double PAN_TOLERANCE = 1e-3;
+
+// Whole pixel offset of the view from the previous one, empty unless both
+// have the same pixel grid and overlap
+// NOTE: Pixel (x, y) of the view samples pixel (x + offset_x, y + offset_y)
+// of the previous one, see Engine::RenderPan()
+[[nodiscard]] std::optional<std::array<int, 2>>
+PanOffset(const Viewport &previous, const Viewport &view);
+
+// Seed the buffer of the view from the frame of the previous view
+// Pixels sampling the same point as a previous pixel are copied, the others
+// get a bilinear preview from the previous frame and are flagged as pending.
+// Returns the number of copied pixels
+// NOTE: Zooming by 2 with Viewport::ZoomAt() keeps every other row and
+// column, a quarter of the frame
+std::size_t ResampleFrame(const Viewport &previous,
+                          const IterationBuffer &previous_buffer,
+                          const Viewport &view, IterationBuffer &buffer,
+                          PendingMask &pending);
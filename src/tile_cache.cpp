@@ -0,0 +1,147 @@
+#include "tile_cache.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+
+#include "formula.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Largest distance from the grid, in pixels, still treated as aligned
+constexpr double ALIGN_TOLERANCE = 1e-6;
+
+// Combine a value into a hash
+// Source: boost::hash_combine
+template <typename T> void HashCombine(std::size_t &seed, const T &value) {
+    seed ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ULL + (seed << 6U) +
+            (seed >> 2U);
+}
+}  // namespace
+
+std::optional<PyramidPlacement> PlaceInPyramid(const Viewport &view) {
+    if (view.width <= 0 || view.height <= 0 ||
+        view.PixelWidth() != view.PixelHeight()) {
+        return std::nullopt;
+    }
+    const double level = -std::log2(view.PixelWidth());
+    if (std::round(level) != level) {
+        return std::nullopt;
+    }
+
+    // Grid index of the first pixel, its sample point is i 2^-l
+    const double first_x = view.OriginX() / view.PixelWidth();
+    const double first_y = view.OriginY() / view.PixelHeight();
+    if (std::fabs(first_x - std::round(first_x)) > ALIGN_TOLERANCE ||
+        std::fabs(first_y - std::round(first_y)) > ALIGN_TOLERANCE) {
+        return std::nullopt;
+    }
+    return PyramidPlacement{
+        .level = static_cast<int>(level),
+        .first_x = static_cast<std::int64_t>(std::round(first_x)),
+        .first_y = static_cast<std::int64_t>(std::round(first_y))};
+}
+
+Viewport SnapToPyramid(const Viewport &view) {
+    const double spacing =
+        std::exp2(-std::round(-std::log2(view.PixelWidth())));
+    const double half_x = static_cast<double>(view.width) / 2.0;
+    const double half_y = static_cast<double>(view.height) / 2.0;
+
+    // Grid index of the first pixel, then the center of the aligned view
+    // NOTE: Pixels sample their centers, the first one is half a pixel inside
+    // the view
+    const double first_x =
+        std::round((view.center_x / spacing) - half_x + 0.5);
+    const double first_y =
+        std::round((view.center_y / spacing) - half_y + 0.5);
+    Viewport snapped = view;
+    snapped.span_x = spacing * static_cast<double>(view.width);
+    snapped.span_y = spacing * static_cast<double>(view.height);
+    snapped.center_x = (first_x + half_x - 0.5) * spacing;
+    snapped.center_y = (first_y + half_y - 0.5) * spacing;
+    return snapped;
+}
+
+Viewport PyramidTileViewport(int level, std::int64_t tile_x,
+                             std::int64_t tile_y) {
+    // NOTE: The first pixel samples the corner of the tile
+    const double spacing = std::exp2(-level);
+    const double span = spacing * PYRAMID_TILE_SIZE;
+    const auto center = [&](std::int64_t tile) {
+        return (static_cast<double>(tile * PYRAMID_TILE_SIZE) +
+                ((PYRAMID_TILE_SIZE - 1) / 2.0)) *
+               spacing;
+    };
+    return {.center_x = center(tile_x),
+            .center_y = center(tile_y),
+            .span_x = span,
+            .span_y = span,
+            .width = PYRAMID_TILE_SIZE,
+            .height = PYRAMID_TILE_SIZE};
+}
+
+bool TileKey::operator==(const TileKey &other) const {
+    return level == other.level && tile_x == other.tile_x &&
+           tile_y == other.tile_y && max_iter == other.max_iter &&
+           escape == other.escape && fractal.formula == other.fractal.formula &&
+           fractal.scalar == other.fractal.scalar &&
+           fractal.power == other.fractal.power &&
+           fractal.julia_x == other.fractal.julia_x &&
+           fractal.julia_y == other.fractal.julia_y &&
+           interior_check == other.interior_check;
+}
+
+std::size_t TileKeyHash::operator()(const TileKey &key) const {
+    std::size_t seed = 0;
+    HashCombine(seed, key.level);
+    HashCombine(seed, key.tile_x);
+    HashCombine(seed, key.tile_y);
+    HashCombine(seed, key.max_iter);
+    HashCombine(seed, key.escape);
+    HashCombine(seed, key.fractal.formula);
+    HashCombine(seed, key.fractal.scalar);
+    HashCombine(seed, key.fractal.power);
+    HashCombine(seed, key.fractal.julia_x);
+    HashCombine(seed, key.fractal.julia_y);
+    HashCombine(seed, key.interior_check);
+    return seed;
+}
+
+TileCache::TileCache(std::size_t memory_budget)
+    : memory_budget(memory_budget) {}
+
+TileCache::Tile TileCache::Find(const TileKey &key) {
+    const auto found = index.find(key);
+    if (found == index.end()) {
+        ++stats.misses;
+        return nullptr;
+    }
+    ++stats.hits;
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->tile;
+}
+
+void TileCache::Insert(const TileKey &key, Tile tile) {
+    if (const auto found = index.find(key); found != index.end()) {
+        found->second->tile = std::move(tile);
+        entries.splice(entries.begin(), entries, found->second);
+        return;
+    }
+    entries.push_front({.key = key, .tile = std::move(tile)});
+    index.emplace(key, entries.begin());
+
+    while (!entries.empty() && GetMemoryUsage() > memory_budget) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+        ++stats.evictions;
+    }
+}
+
+void TileCache::Clear() {
+    entries.clear();
+    index.clear();
+}
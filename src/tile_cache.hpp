@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+
+#include "formula.hpp"
+#include "iteration_buffer.hpp"
+#include "viewport.hpp"
+
+// Tile pyramid: level l samples the plane on a global grid of square pixels
+// 2^-l wide, pixel (i, j) samples (i 2^-l, j 2^-l) and tile (x, y) holds the
+// pixels [x, x + 1) * PYRAMID_TILE_SIZE of both axes
+// NOTE: Every sample point is a dyadic number, so tiles are bit-exact with a
+// full render of any view aligned to the grid. Pixel (i, j) of level l is
+// pixel (2i, 2j) of level l + 1, so zooming an aligned view by 2 around a
+// pixel keeps it aligned
+constexpr int PYRAMID_TILE_SIZE = 64;
+
+// Position of a viewport in the tile pyramid
+struct PyramidPlacement {
+    int level;
+    // Global grid index of the first pixel of the view
+    std::int64_t first_x;
+    std::int64_t first_y;
+};
+
+// Placement of a view aligned to the pyramid grid, empty for other views
+[[nodiscard]] std::optional<PyramidPlacement>
+PlaceInPyramid(const Viewport &view);
+
+// Closest view of the same size aligned to the pyramid grid
+[[nodiscard]] Viewport SnapToPyramid(const Viewport &view);
+
+// Viewport of a single pyramid tile
+[[nodiscard]] Viewport PyramidTileViewport(int level, std::int64_t tile_x,
+                                           std::int64_t tile_y);
+
+// Identity of the iteration data of a tile
+// NOTE: fractal holds FractalSettings::Normalized(), options the formula
+// ignores do not split the cache
+struct TileKey {
+    int level;
+    std::int64_t tile_x;
+    std::int64_t tile_y;
+    int max_iter;
+    double escape;
+    FractalSettings fractal;
+    // Interior checks end orbits early, see EngineSettings::interior_check
+    bool interior_check;
+
+    [[nodiscard]] bool operator==(const TileKey &other) const;
+};
+
+struct TileKeyHash {
+    [[nodiscard]] std::size_t operator()(const TileKey &key) const;
+};
+
+// Counters of a tile cache
+struct TileCacheStats {
+    std::uint64_t hits{};
+    std::uint64_t misses{};
+    std::uint64_t evictions{};
+};
+
+// In-memory cache of pyramid tiles, the least recently used tiles are
+// evicted once the memory budget is exceeded
+// NOTE: Not thread-safe, the engine only uses it from the rendering thread
+class TileCache {
+  public:
+    // Iteration data of a tile, PYRAMID_TILE_SIZE pixels square
+    using Tile = std::shared_ptr<const IterationBuffer>;
+
+    // Memory of a tile counted against the budget
+    static constexpr std::size_t TILE_BYTES =
+        (sizeof(float) * PYRAMID_TILE_SIZE * PYRAMID_TILE_SIZE) +
+        sizeof(IterationBuffer) + sizeof(TileKey);
+
+    explicit TileCache(std::size_t memory_budget);
+
+    // Cached tile, moved to the front of the LRU list, counts a hit or miss
+    [[nodiscard]] Tile Find(const TileKey &key);
+
+    // Add or replace a tile, evicts tiles until the cache fits the budget
+    // NOTE: A budget smaller than one tile keeps nothing
+    void Insert(const TileKey &key, Tile tile);
+
+    // Drop every tile, the counters are kept
+    void Clear();
+
+    // Getters
+    [[nodiscard]] const TileCacheStats &GetStats() const noexcept {
+        return stats;
+    }
+    [[nodiscard]] std::size_t GetTileCount() const noexcept {
+        return entries.size();
+    }
+    [[nodiscard]] std::size_t GetMemoryUsage() const noexcept {
+        return entries.size() * TILE_BYTES;
+    }
+    [[nodiscard]] std::size_t GetMemoryBudget() const noexcept {
+        return memory_budget;
+    }
+
+  private:
+    struct Entry {
+        TileKey key;
+        Tile tile;
+    };
+    // Most recently used tiles first
+    std::list<Entry> entries;
+    std::unordered_map<TileKey, std::list<Entry>::iterator, TileKeyHash>
+        index;
+    std::size_t memory_budget;
+    TileCacheStats stats;
+};
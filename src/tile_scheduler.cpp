@@ -0,0 +1,157 @@
+#include "tile_scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <vector>
+
+double SchedulerStats::Efficiency() const {
+    if (workers.empty() || wall.count() == 0) {
+        return 1.0;
+    }
+    std::chrono::nanoseconds busy{};
+    for (const auto &worker : workers) {
+        busy += worker.busy;
+    }
+    const auto available =
+        static_cast<double>(wall.count()) * static_cast<double>(workers.size());
+    return std::clamp(static_cast<double>(busy.count()) / available, 0.0, 1.0);
+}
+
+TileScheduler::TileScheduler(std::size_t thread_count)
+    : worker_stats(std::max<std::size_t>(thread_count, 1)) {
+    queues.resize(worker_stats.size());
+    for (auto &queue : queues) {
+        queue = std::make_unique<TaskQueue>();
+    }
+
+    // Worker 0 is the thread calling Run
+    threads.reserve(queues.size() - 1);
+    for (std::size_t worker = 1; worker < queues.size(); ++worker) {
+        threads.emplace_back([this, worker](const std::stop_token &stop) {
+            WorkerLoop(stop, worker);
+        });
+    }
+}
+
+TileScheduler::~TileScheduler() {
+    for (auto &thread : threads) {
+        thread.request_stop();
+    }
+    start_cv.notify_all();
+}
+
+SchedulerStats TileScheduler::Run(std::size_t task_count, const Task &task) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto worker_count = queues.size();
+
+    // Every worker starts with a contiguous block of tasks, neighbouring tiles
+    // share cache lines and usually have a similar cost
+    for (std::size_t worker = 0; worker < worker_count; ++worker) {
+        const auto first = task_count * worker / worker_count;
+        const auto last = task_count * (worker + 1) / worker_count;
+        std::scoped_lock lock(queues[worker]->mutex);
+        for (auto index = first; index < last; ++index) {
+            queues[worker]->tasks.push_back(index);
+        }
+    }
+
+    // Wake up the other workers
+    {
+        std::scoped_lock lock(mutex);
+        std::ranges::fill(worker_stats, WorkerStats{});
+        current_task = &task;
+        pending_workers = worker_count - 1;
+        ++generation;
+    }
+    start_cv.notify_all();
+
+    Work(0);
+
+    // Wait until every worker ran out of tasks
+    std::unique_lock lock(mutex);
+    done_cv.wait(lock, [this]() { return pending_workers == 0; });
+    current_task = nullptr;
+
+    SchedulerStats stats;
+    stats.wall = std::chrono::steady_clock::now() - start;
+    stats.workers = worker_stats;
+    for (auto &worker : stats.workers) {
+        worker.idle = std::max(stats.wall - worker.busy,
+                               std::chrono::nanoseconds::zero());
+    }
+    return stats;
+}
+
+void TileScheduler::WorkerLoop(const std::stop_token &stop,
+                               std::size_t worker) {
+    std::uint64_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            const bool started = start_cv.wait(lock, stop, [&]() {
+                return generation != seen_generation;
+            });
+            if (!started) {
+                return;
+            }
+            seen_generation = generation;
+        }
+
+        Work(worker);
+
+        std::scoped_lock lock(mutex);
+        if (--pending_workers == 0) {
+            done_cv.notify_one();
+        }
+    }
+}
+
+void TileScheduler::Work(std::size_t worker) {
+    auto &stats = worker_stats[worker];
+    while (true) {
+        auto index = Pop(worker);
+        if (!index.has_value()) {
+            index = Steal(worker);
+            if (!index.has_value()) {
+                // NOTE: Tasks never add tasks, so empty deques stay empty
+                return;
+            }
+            ++stats.steals;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        (*current_task)(*index, worker);
+        stats.busy += std::chrono::steady_clock::now() - start;
+        ++stats.tasks;
+    }
+}
+
+std::optional<std::size_t> TileScheduler::Pop(std::size_t worker) {
+    auto &queue = *queues[worker];
+    std::scoped_lock lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return std::nullopt;
+    }
+    const auto index = queue.tasks.front();
+    queue.tasks.pop_front();
+    return index;
+}
+
+std::optional<std::size_t> TileScheduler::Steal(std::size_t worker) {
+    // Visit the other workers starting with the next one
+    for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+        auto &queue = *queues[(worker + offset) % queues.size()];
+        std::scoped_lock lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            const auto index = queue.tasks.back();
+            queue.tasks.pop_back();
+            return index;
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+// Statistics of a single worker thread during one run
+struct WorkerStats {
+    // Time spent running tasks and waiting for the rest of the run
+    std::chrono::nanoseconds busy{};
+    std::chrono::nanoseconds idle{};
+    std::uint64_t tasks{};
+    // Tasks taken from other workers
+    std::uint64_t steals{};
+};
+
+// Statistics of one run of the scheduler
+struct SchedulerStats {
+    std::chrono::nanoseconds wall{};
+    std::vector<WorkerStats> workers;
+
+    // Share of the available thread time spent running tasks, in [0, 1]
+    [[nodiscard]] double Efficiency() const;
+};
+
+// Work-stealing scheduler running independent tasks (tiles) on a fixed set of
+// threads
+// NOTE: Every worker owns a deque, takes tasks from its front and steals from
+// the back of the other deques when it runs dry
+class TileScheduler {
+  public:
+    // Task receives its index and the index of the worker running it
+    using Task = std::function<void(std::size_t task, std::size_t worker)>;
+
+    explicit TileScheduler(std::size_t thread_count);
+
+    // Delete copy operations
+    TileScheduler(const TileScheduler &) = delete;
+    TileScheduler &operator=(const TileScheduler &) = delete;
+
+    // Delete move operations
+    TileScheduler(TileScheduler &&) noexcept = delete;
+    TileScheduler &operator=(TileScheduler &&) = delete;
+
+    ~TileScheduler();
+
+    // Run the task for every index in [0, task_count), blocks until all are
+    // done
+    // NOTE: The calling thread is worker 0
+    SchedulerStats Run(std::size_t task_count, const Task &task);
+
+    [[nodiscard]] std::size_t GetThreadCount() const noexcept {
+        return queues.size();
+    }
+
+  private:
+    // Deque of task indices owned by one worker
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<WorkerStats> worker_stats;
+
+    // Start and completion of a run
+    std::mutex mutex;
+    std::condition_variable_any start_cv;
+    std::condition_variable done_cv;
+    std::uint64_t generation{0};
+    std::size_t pending_workers{0};
+    const Task *current_task{nullptr};
+
+    // NOTE: Declared last, so threads stop before the state they use is gone
+    std::vector<std::jthread> threads;
+
+    void WorkerLoop(const std::stop_token &stop, std::size_t worker);
+    void Work(std::size_t worker);
+    std::optional<std::size_t> Pop(std::size_t worker);
+    std::optional<std::size_t> Steal(std::size_t worker);
+};
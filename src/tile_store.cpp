@@ -0,0 +1,311 @@
+#include "tile_store.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <expected>
+#include <filesystem>
+#include <format>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#include "raylib-cpp.hpp"
+
+#include "mandelbrot_error.hpp"
+#include "tile_cache.hpp"
+
+namespace {
+constexpr std::array<char, 8> MAGIC{'M', 'B', 'T', 'I', 'L', 'E', 'S', '\0'};
+// Index starts after the header, tile data on the next page boundary
+constexpr std::size_t INDEX_OFFSET = 64;
+constexpr std::size_t PAGE_SIZE = 4096;
+constexpr std::size_t TILE_FLOATS =
+    static_cast<std::size_t>(PYRAMID_TILE_SIZE) * PYRAMID_TILE_SIZE;
+
+// CRC-32 lookup table, IEEE polynomial
+constexpr auto CRC_TABLE = [] {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < table.size(); ++i) {
+        std::uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1U) != 0 ? (crc >> 1U) ^ 0xEDB88320U : crc >> 1U;
+        }
+        table[i] = crc;
+    }
+    return table;
+}();
+
+std::uint32_t Crc32(std::span<const float> values) {
+    std::uint32_t crc = 0xFFFFFFFFU;
+    for (const auto byte : std::as_bytes(values)) {
+        crc = CRC_TABLE[(crc ^ static_cast<std::uint32_t>(byte)) & 0xFFU] ^
+              (crc >> 8U);
+    }
+    return ~crc;
+}
+
+// Hash of the key fields, the same in every build
+// Source: FNV-1a, http://www.isthe.com/chongo/tech/comp/fnv/
+std::uint64_t HashKey(const TileKey &key) {
+    constexpr std::uint64_t offset_basis = 0xcbf29ce484222325ULL;
+    constexpr std::uint64_t prime = 0x100000001b3ULL;
+    std::uint64_t hash = offset_basis;
+    const auto add = [&hash](const auto &value) {
+        for (const auto byte :
+             std::bit_cast<std::array<std::uint8_t, sizeof(value)>>(value)) {
+            hash ^= byte;
+            hash *= prime;
+        }
+    };
+    add(key.level);
+    add(key.tile_x);
+    add(key.tile_y);
+    add(key.max_iter);
+    add(key.escape);
+    add(static_cast<std::uint8_t>(key.fractal.formula));
+    add(static_cast<std::uint8_t>(key.fractal.scalar));
+    add(key.fractal.power);
+    add(key.fractal.julia_x);
+    add(key.fractal.julia_y);
+    add(static_cast<std::uint8_t>(key.interior_check));
+    return hash;
+}
+
+std::size_t DataOffset(std::uint32_t capacity) {
+    const auto index_end = INDEX_OFFSET + (capacity * std::size_t{64});
+    return (index_end + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+}
+
+std::size_t FileSize(std::uint32_t capacity) {
+    return DataOffset(capacity) + (capacity * TILE_FLOATS * sizeof(float));
+}
+
+MandelbrotError StoreError(std::string_view what,
+                           const std::filesystem::path &path) {
+    return MandelbrotError(MandelbrotError::Code::StoreError,
+                           std::format("{} -> {}", what, path.string()));
+}
+}  // namespace
+
+std::expected<TileStore, MandelbrotError>
+TileStore::Open(const std::filesystem::path &path, std::uint32_t capacity) {
+    if (capacity == 0) {
+        return std::unexpected(MandelbrotError(
+            MandelbrotError::Code::InvalidValue,
+            std::format("Tile store capacity must be positive -> {}",
+                        path.string())));
+    }
+
+    const int file = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (file < 0) {
+        return std::unexpected(StoreError("Failed to open tile store", path));
+    }
+    struct stat status {};
+    if (::fstat(file, &status) != 0) {
+        ::close(file);
+        return std::unexpected(StoreError("Failed to read tile store", path));
+    }
+
+    // New files are sized for the capacity, the kernel fills them with zeros
+    const bool created = status.st_size == 0;
+    auto size = static_cast<std::size_t>(status.st_size);
+    if (created) {
+        size = FileSize(capacity);
+        if (::ftruncate(file, static_cast<off_t>(size)) != 0) {
+            ::close(file);
+            return std::unexpected(
+                StoreError("Failed to allocate tile store", path));
+        }
+    }
+
+    void *mapping =
+        ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (mapping == MAP_FAILED) {
+        ::close(file);
+        return std::unexpected(StoreError("Failed to map tile store", path));
+    }
+    auto *bytes = static_cast<std::byte *>(mapping);
+
+    Header header{};
+    if (created) {
+        header = {.magic = MAGIC,
+                  .version = VERSION,
+                  .tile_size = PYRAMID_TILE_SIZE,
+                  .capacity = capacity,
+                  .reserved = 0};
+        std::memcpy(bytes, &header, sizeof(header));
+    } else if (size >= sizeof(header)) {
+        std::memcpy(&header, bytes, sizeof(header));
+    }
+    if (header.magic != MAGIC || header.version != VERSION ||
+        header.tile_size != PYRAMID_TILE_SIZE || header.capacity == 0 ||
+        FileSize(header.capacity) != size) {
+        ::munmap(mapping, size);
+        ::close(file);
+        return std::unexpected(
+            StoreError("Unsupported or damaged tile store", path));
+    }
+    return TileStore(file, bytes, size, header.capacity);
+}
+
+TileStore::TileStore(int file, std::byte *mapping, std::size_t size,
+                     std::uint32_t capacity)
+    : file(file), mapping(mapping), size(size), capacity(capacity),
+      verified(capacity, 0) {
+    tile_count = static_cast<std::uint32_t>(std::ranges::count_if(
+        std::span(Entries(), capacity),
+        [](const IndexEntry &entry) { return entry.used != 0; }));
+}
+
+TileStore::TileStore(TileStore &&other) noexcept
+    : file(std::exchange(other.file, -1)),
+      mapping(std::exchange(other.mapping, nullptr)),
+      size(std::exchange(other.size, 0)),
+      capacity(std::exchange(other.capacity, 0)),
+      tile_count(std::exchange(other.tile_count, 0)),
+      verified(std::move(other.verified)), stats(other.stats) {}
+
+TileStore &TileStore::operator=(TileStore &&other) noexcept {
+    if (this != &other) {
+        Close();
+        file = std::exchange(other.file, -1);
+        mapping = std::exchange(other.mapping, nullptr);
+        size = std::exchange(other.size, 0);
+        capacity = std::exchange(other.capacity, 0);
+        tile_count = std::exchange(other.tile_count, 0);
+        verified = std::move(other.verified);
+        stats = other.stats;
+    }
+    return *this;
+}
+
+TileStore::~TileStore() { Close(); }
+
+std::optional<std::span<const float>> TileStore::Find(const TileKey &key) {
+    const auto slot = Probe(key);
+    if (!slot || Entries()[*slot].used == 0) {
+        ++stats.misses;
+        return std::nullopt;
+    }
+
+    const std::span<const float> values(TileData(*slot), TILE_FLOATS);
+    if (verified[*slot] == 0) {
+        if (Crc32(values) != Entries()[*slot].checksum) {
+            ++stats.corrupted;
+            ++stats.misses;
+            return std::nullopt;
+        }
+        verified[*slot] = 1;
+    }
+    ++stats.hits;
+    return values;
+}
+
+void TileStore::Insert(const TileKey &key, std::span<const float> values) {
+    assert(values.size() == TILE_FLOATS);
+    auto slot = Probe(key);
+    if (!slot) {
+        // NOTE: The replaced slot stays used, so probes of other keys still
+        // walk past it
+        if (stats.evictions == 0) {
+            TraceLog(LOG_WARNING,
+                     "MANDELBROT_SET: Tile store of %u tiles is full, "
+                     "replacing stored tiles",
+                     capacity);
+        }
+        ++stats.evictions;
+        slot = HomeSlot(key);
+    }
+
+    // NOTE: The entry is marked used last, so an interrupted write leaves an
+    // empty slot or a checksum mismatch
+    auto &entry = Entries()[*slot];
+    const bool added = entry.used == 0;
+    std::ranges::copy(values, TileData(*slot));
+    entry = {.used = 0,
+             .checksum = Crc32(values),
+             .level = key.level,
+             .max_iter = key.max_iter,
+             .tile_x = key.tile_x,
+             .tile_y = key.tile_y,
+             .escape = key.escape,
+             .julia_x = key.fractal.julia_x,
+             .julia_y = key.fractal.julia_y,
+             .formula = static_cast<std::uint8_t>(key.fractal.formula),
+             .scalar = static_cast<std::uint8_t>(key.fractal.scalar),
+             .interior_check = static_cast<std::uint8_t>(key.interior_check),
+             .padding = 0,
+             .power = key.fractal.power};
+    entry.used = 1;
+    verified[*slot] = 1;
+    if (added) {
+        ++tile_count;
+    }
+}
+
+void TileStore::Flush() {
+    if (mapping != nullptr) {
+        ::msync(mapping, size, MS_SYNC);
+    }
+}
+
+TileStore::IndexEntry *TileStore::Entries() const {
+    // NOTE: The mapping is page aligned and entries are 64 bytes apart
+    return reinterpret_cast<IndexEntry *>(mapping + INDEX_OFFSET);
+}
+
+float *TileStore::TileData(std::uint32_t slot) const {
+    return reinterpret_cast<float *>(mapping + DataOffset(capacity) +
+                                     (slot * TILE_FLOATS * sizeof(float)));
+}
+
+std::uint32_t TileStore::HomeSlot(const TileKey &key) const {
+    return static_cast<std::uint32_t>(HashKey(key) % capacity);
+}
+
+std::optional<std::uint32_t> TileStore::Probe(const TileKey &key) const {
+    const auto *entries = Entries();
+    const std::size_t start = HomeSlot(key);
+    for (std::uint32_t i = 0; i < std::min(capacity, MAX_PROBES); ++i) {
+        const auto slot = static_cast<std::uint32_t>((start + i) % capacity);
+        const auto &entry = entries[slot];
+        if (entry.used == 0) {
+            return slot;
+        }
+        if (entry.level == key.level && entry.tile_x == key.tile_x &&
+            entry.tile_y == key.tile_y && entry.max_iter == key.max_iter &&
+            entry.escape == key.escape &&
+            entry.formula == static_cast<std::uint8_t>(key.fractal.formula) &&
+            entry.scalar == static_cast<std::uint8_t>(key.fractal.scalar) &&
+            entry.power == key.fractal.power &&
+            entry.julia_x == key.fractal.julia_x &&
+            entry.julia_y == key.fractal.julia_y &&
+            entry.interior_check ==
+                static_cast<std::uint8_t>(key.interior_check)) {
+            return slot;
+        }
+    }
+    return std::nullopt;
+}
+
+void TileStore::Close() {
+    if (mapping != nullptr) {
+        ::munmap(mapping, size);
+        mapping = nullptr;
+    }
+    if (file >= 0) {
+        ::close(file);
+        file = -1;
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "mandelbrot_error.hpp"
+#include "tile_cache.hpp"
+
+// Counters of a tile store
+struct TileStoreStats {
+    std::uint64_t hits{};
+    std::uint64_t misses{};
+    // Tiles whose checksum did not match, treated as misses
+    std::uint64_t corrupted{};
+    // Tiles replaced by a tile whose probe window was full
+    std::uint64_t evictions{};
+};
+
+// Pyramid tiles persisted in a memory-mapped file
+// Layout, in host byte order:
+// - Header, see TileStore::Header
+// - Index of `capacity` fixed-size entries, an open-addressing hash table of
+//   TileKey with linear probing over at most MAX_PROBES slots, hashed with
+//   FNV-1a so every build finds the same slots
+// - Tile data, entry i owns the PYRAMID_TILE_SIZE^2 floats of slot i,
+//   starting on a page boundary
+// NOTE: Found tiles are read in place from the mapping, which the kernel
+// serves from the page cache
+class TileStore {
+  public:
+    // Format version, files of other versions are rejected
+    static constexpr std::uint32_t VERSION = 3;
+    // Slots searched for a key, when all of them hold other tiles the first
+    // one is replaced
+    static constexpr std::uint32_t MAX_PROBES = 16;
+    // Memory of the data of a tile, the file holds `capacity` of them
+    static constexpr std::size_t TILE_BYTES =
+        sizeof(float) * PYRAMID_TILE_SIZE * PYRAMID_TILE_SIZE;
+
+    // Open the store, creating a file with room for `capacity` tiles when it
+    // does not exist
+    // NOTE: Existing files keep their capacity
+    static std::expected<TileStore, MandelbrotError>
+    Open(const std::filesystem::path &path, std::uint32_t capacity);
+
+    // Delete copy operations
+    TileStore(const TileStore &) = delete;
+    TileStore &operator=(const TileStore &) = delete;
+
+    TileStore(TileStore &&other) noexcept;
+    TileStore &operator=(TileStore &&other) noexcept;
+
+    ~TileStore();
+
+    // Values of the stored tile, rows one after another
+    // NOTE: The checksum of a tile is verified on its first read only
+    [[nodiscard]] std::optional<std::span<const float>>
+    Find(const TileKey &key);
+
+    // Store or replace a tile, a full probe window evicts the tile in the
+    // first slot of the key
+    // NOTE: Spans returned by Find() may then point to the new tile
+    void Insert(const TileKey &key, std::span<const float> values);
+
+    // Write the mapping back to the file
+    void Flush();
+
+    // Getters
+    [[nodiscard]] const TileStoreStats &GetStats() const noexcept {
+        return stats;
+    }
+    [[nodiscard]] std::uint32_t GetCapacity() const noexcept {
+        return capacity;
+    }
+    [[nodiscard]] std::uint32_t GetTileCount() const noexcept {
+        return tile_count;
+    }
+
+  private:
+    // Start of the file
+    struct Header {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t tile_size;
+        std::uint32_t capacity;
+        std::uint32_t reserved;
+    };
+
+    // One slot of the index
+    struct IndexEntry {
+        // 0 for empty slots
+        std::uint32_t used;
+        // CRC-32 of the tile data
+        std::uint32_t checksum;
+        std::int32_t level;
+        std::int32_t max_iter;
+        std::int64_t tile_x;
+        std::int64_t tile_y;
+        double escape;
+        double julia_x;
+        double julia_y;
+        std::uint8_t formula;
+        std::uint8_t scalar;
+        std::uint8_t interior_check;
+        std::uint8_t padding;
+        std::int32_t power;
+    };
+    static_assert(sizeof(Header) == 24);
+    static_assert(sizeof(IndexEntry) == 64);
+
+    TileStore(int file, std::byte *mapping, std::size_t size,
+              std::uint32_t capacity);
+
+    int file{-1};
+    std::byte *mapping{nullptr};
+    std::size_t size{};
+    std::uint32_t capacity{};
+    std::uint32_t tile_count{};
+    // Slots whose checksum was verified in this session
+    std::vector<std::uint8_t> verified;
+    TileStoreStats stats;
+
+    [[nodiscard]] IndexEntry *Entries() const;
+    [[nodiscard]] float *TileData(std::uint32_t slot) const;
+    // First slot of the probe window of the key
+    [[nodiscard]] std::uint32_t HomeSlot(const TileKey &key) const;
+    // Slot holding the key, or the empty slot where it belongs, empty when the
+    // key is missing and its probe window is full
+    [[nodiscard]] std::optional<std::uint32_t> Probe(const TileKey &key) const;
+    void Close();
+};
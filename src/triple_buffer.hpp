@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free exchange of frames between one producer and one consumer thread
+// NOTE: The producer fills its back slot and swaps it with the middle slot,
+// the consumer swaps the middle slot with its front slot when it holds a
+// newer frame. Neither side waits, the consumer skips frames it was too slow
+// to take
+template <typename T> class TripleBuffer {
+  public:
+    // Slot the producer writes the next frame into
+    [[nodiscard]] T &Back() noexcept { return slots[back]; }
+
+    // Hand the back slot to the consumer, the producer continues with the
+    // slot it gets back
+    // Returns false when the replaced frame was never acquired
+    bool Publish() noexcept {
+        const auto previous = middle.exchange(
+            static_cast<std::uint8_t>(back | FRESH), std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+        return (previous & FRESH) == 0;
+    }
+
+    // Take the newest published frame into the front slot, returns false when
+    // nothing was published since the last call
+    bool Acquire() noexcept {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        const auto previous =
+            middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & INDEX_MASK;
+        return true;
+    }
+
+    // Frame taken by the last Acquire()
+    [[nodiscard]] const T &Front() const noexcept { return slots[front]; }
+
+  private:
+    // Middle slot flag set by Publish() and cleared by Acquire()
+    static constexpr std::uint8_t FRESH = 0x4;
+    static constexpr std::uint8_t INDEX_MASK = 0x3;
+
+    std::array<T, 3> slots{};
+    // Slot indices, each slot is owned by exactly one of them
+    std::uint8_t back{0};
+    std::uint8_t front{1};
+    std::atomic<std::uint8_t> middle{2};
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+
+#include "big_fixed.hpp"
+
+// Region of the complex plane mapped onto a grid of pixels
+struct Viewport {
+    // Default view, the same bounds as in mandelbrot_set.frag
+    // X in [-2.5, 1.0], Y in [-1.25, 1.25]
+    static constexpr double DEFAULT_CENTER_X = -0.75;
+    static constexpr double DEFAULT_CENTER_Y = 0.0;
+    static constexpr double DEFAULT_SPAN_X = 3.5;
+    static constexpr double DEFAULT_SPAN_Y = 2.5;
+
+    // Center of the view in the complex plane
+    double center_x{DEFAULT_CENTER_X};
+    double center_y{DEFAULT_CENTER_Y};
+    // Size of the view in the complex plane
+    double span_x{DEFAULT_SPAN_X};
+    double span_y{DEFAULT_SPAN_Y};
+    // Size of the view in pixels
+    int width{};
+    int height{};
+
+    // Distance between two neighbouring pixels
+    [[nodiscard]] constexpr double PixelWidth() const {
+        return span_x / static_cast<double>(width);
+    }
+    [[nodiscard]] constexpr double PixelHeight() const {
+        return span_y / static_cast<double>(height);
+    }
+
+    // Lower bounds of the view
+    [[nodiscard]] constexpr double MinX() const {
+        return center_x - (span_x / 2.0);
+    }
+    [[nodiscard]] constexpr double MinY() const {
+        return center_y - (span_y / 2.0);
+    }
+
+    // Coordinates of the first pixel center
+    // NOTE: Pixels are sampled in their centers, like fragTexCoord
+    [[nodiscard]] constexpr double OriginX() const {
+        return MinX() + (0.5 * PixelWidth());
+    }
+    [[nodiscard]] constexpr double OriginY() const {
+        return MinY() + (0.5 * PixelHeight());
+    }
+
+    // Point of the complex plane sampled by the pixel
+    [[nodiscard]] constexpr double PixelX(int x) const {
+        return OriginX() + (static_cast<double>(x) * PixelWidth());
+    }
+    [[nodiscard]] constexpr double PixelY(int y) const {
+        return OriginY() + (static_cast<double>(y) * PixelHeight());
+    }
+
+    // View magnified by the factor, the pixel keeps sampling the same point
+    // NOTE: With an integer factor every factor-th row and column of the new
+    // view samples the points of the old pixels, see ResampleFrame()
+    [[nodiscard]] constexpr Viewport ZoomAt(int x, int y, double factor) const {
+        Viewport zoomed = *this;
+        zoomed.span_x = span_x / factor;
+        zoomed.span_y = span_y / factor;
+        const double half_x = static_cast<double>(width) / 2.0;
+        const double half_y = static_cast<double>(height) / 2.0;
+        zoomed.center_x = PixelX(x) - ((static_cast<double>(x) + 0.5 - half_x) *
+                                       zoomed.PixelWidth());
+        zoomed.center_y = PixelY(y) - ((static_cast<double>(y) + 0.5 - half_y) *
+                                       zoomed.PixelHeight());
+        return zoomed;
+    }
+};
+
+// Viewport with a high precision center for deep zooms
+// NOTE: Only the center needs high precision, offsets of pixels from the
+// center fit into a double at any zoom
+struct DeepViewport {
+    BigFixed center_x{
+        BigFixed::FromDouble(Viewport::DEFAULT_CENTER_X,
+                             BigFixed::DEFAULT_FRACTION_LIMBS)};
+    BigFixed center_y{
+        BigFixed::FromDouble(Viewport::DEFAULT_CENTER_Y,
+                             BigFixed::DEFAULT_FRACTION_LIMBS)};
+    double span_x{Viewport::DEFAULT_SPAN_X};
+    double span_y{Viewport::DEFAULT_SPAN_Y};
+    int width{};
+    int height{};
+
+    // Create from a double precision viewport
+    [[nodiscard]] static DeepViewport FromViewport(const Viewport &view) {
+        const auto limbs = BigFixed::LimbsForResolution(view.PixelWidth());
+        return {.center_x = BigFixed::FromDouble(view.center_x, limbs),
+                .center_y = BigFixed::FromDouble(view.center_y, limbs),
+                .span_x = view.span_x,
+                .span_y = view.span_y,
+                .width = view.width,
+                .height = view.height};
+    }
+
+    // Double precision approximation of the view
+    [[nodiscard]] Viewport ToViewport() const {
+        return {.center_x = center_x.ToDouble(),
+                .center_y = center_y.ToDouble(),
+                .span_x = span_x,
+                .span_y = span_y,
+                .width = width,
+                .height = height};
+    }
+
+    // Magnification relative to the default view
+    [[nodiscard]] double Zoom() const {
+        return Viewport::DEFAULT_SPAN_X / span_x;
+    }
+
+    // Distance between two neighbouring pixels
+    [[nodiscard]] double PixelWidth() const {
+        return span_x / static_cast<double>(width);
+    }
+    [[nodiscard]] double PixelHeight() const {
+        return span_y / static_cast<double>(height);
+    }
+
+    // Fraction limbs needed for the center at this zoom
+    [[nodiscard]] std::size_t RequiredLimbs() const {
+        return BigFixed::LimbsForResolution(PixelWidth());
+    }
+
+    // Offset of the pixel center from the view center
+    [[nodiscard]] double OffsetX(int x) const {
+        const double half = static_cast<double>(width) / 2.0;
+        return (static_cast<double>(x) + 0.5 - half) * PixelWidth();
+    }
+    [[nodiscard]] double OffsetY(int y) const {
+        const double half = static_cast<double>(height) / 2.0;
+        return (static_cast<double>(y) + 0.5 - half) * PixelHeight();
+    }
+
+    // View magnified by the factor, the pixel keeps sampling the same point,
+    // see Viewport::ZoomAt()
+    // NOTE: The center gains fraction limbs as the pixels get smaller
+    [[nodiscard]] DeepViewport ZoomAt(int x, int y, double factor) const {
+        DeepViewport zoomed = *this;
+        zoomed.span_x = span_x / factor;
+        zoomed.span_y = span_y / factor;
+        const auto limbs =
+            std::max(center_x.GetFractionLimbs(), zoomed.RequiredLimbs());
+        zoomed.center_x =
+            center_x.WithLimbs(limbs) +
+            BigFixed::FromDouble(OffsetX(x) - zoomed.OffsetX(x), limbs);
+        zoomed.center_y =
+            center_y.WithLimbs(limbs) +
+            BigFixed::FromDouble(OffsetY(y) - zoomed.OffsetY(y), limbs);
+        return zoomed;
+    }
+
+    // View moved by whole pixels, positive offsets move the center right and
+    // down
+    [[nodiscard]] DeepViewport MovedBy(int dx, int dy) const {
+        DeepViewport moved = *this;
+        moved.center_x =
+            center_x +
+            BigFixed::FromDouble(static_cast<double>(dx) * PixelWidth(),
+                                 center_x.GetFractionLimbs());
+        moved.center_y =
+            center_y +
+            BigFixed::FromDouble(static_cast<double>(dy) * PixelHeight(),
+                                 center_y.GetFractionLimbs());
+        return moved;
+    }
+};
+
+// Band of rows of a log-polar strip around a high precision center, the
+// exponential map of a zoom into that center
+// NOTE: Row y samples the circle of Radius(y) at the angles of the columns.
+// The radius shrinks by the angle step from row to row, so every sample
+// covers a square of the plane and the strip continues below the band
+struct ExpMapView {
+    BigFixed center_x;
+    BigFixed center_y;
+    // Radius of row 0
+    double radius{1.0};
+    // Samples around the circle and rows of the band
+    int width{};
+    int height{};
+
+    // Angle between two columns, also the logarithm of the radius ratio of
+    // two rows
+    [[nodiscard]] double Step() const {
+        return 2.0 * std::numbers::pi / static_cast<double>(width);
+    }
+
+    [[nodiscard]] double Radius(int y) const {
+        return radius * std::exp(-Step() * static_cast<double>(y));
+    }
+    [[nodiscard]] double Angle(int x) const {
+        return Step() * static_cast<double>(x);
+    }
+
+    // Distance between two neighbouring samples of the row
+    [[nodiscard]] double Spacing(int y) const { return Radius(y) * Step(); }
+
+    // Fraction limbs needed for the center at the innermost row
+    [[nodiscard]] std::size_t RequiredLimbs() const {
+        return BigFixed::LimbsForResolution(Spacing(height - 1));
+    }
+};
@@ -0,0 +1,135 @@
+#include <cmath>
+#include <filesystem>
+#include <string_view>
+
+#include "doctest.h"
+
+#include "batch_job.hpp"
+#include "mandelbrot_error.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Job file of the test configs
+std::filesystem::path JobPath(std::string_view name) {
+    return std::filesystem::path(PROJECT_ROOT_PATH) / "tests/configs" / name;
+}
+}  // namespace
+
+TEST_CASE("01 - BatchJob::Load - valid job loads correctly") {
+    auto result = BatchJob::Load(JobPath("batch_valid.toml"));
+
+    REQUIRE(result.has_value());
+
+    const auto &job = result.value();
+    CHECK_EQ(job.GetWidth(), 64);
+    CHECK_EQ(job.GetHeight(), 48);
+    CHECK_EQ(job.GetFrameCount(), 5);
+    CHECK_EQ(job.GetFormat(), ImageFormat::Bmp);
+    CHECK_EQ(job.GetDirectory(), JobPath("frames"));
+    CHECK_EQ(job.FramePath(3), JobPath("frames/test_00003.bmp"));
+    CHECK_EQ(job.GetPaletteSettings().size, 256U);
+    CHECK(job.GetFractalSettings().IsPlainMandelbrot());
+    CHECK_FALSE(job.IsExpMap());
+
+    REQUIRE_EQ(job.GetKeyframes().size(), 2U);
+    const auto &last = job.GetKeyframes().back();
+    CHECK_EQ(last.frame, 4);
+    CHECK_EQ(last.zoom, 10000.0);
+    CHECK_EQ(last.max_iter, 1600);
+    // Digits past double precision are kept
+    CHECK_EQ(last.center_x.ToString(30), "-0.743643887037158704752191506114");
+}
+
+TEST_CASE("02 - BatchJob::Load - invalid jobs") {
+    SUBCASE("Missing job file") {
+        auto result = BatchJob::Load(JobPath("does_not_exist.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(),
+                 MandelbrotError::Code::FileNotFound);
+        MESSAGE(result.error().GetMessage());
+    }
+    SUBCASE("Missing output table") {
+        auto result = BatchJob::Load(JobPath("batch_no_output.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(), MandelbrotError::Code::ParseError);
+        MESSAGE(result.error().GetMessage());
+    }
+    SUBCASE("No keyframes") {
+        auto result = BatchJob::Load(JobPath("batch_invalid1.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(),
+                 MandelbrotError::Code::MissingOption);
+        MESSAGE(result.error().GetMessage());
+    }
+    SUBCASE("Keyframes out of order") {
+        auto result = BatchJob::Load(JobPath("batch_invalid2.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(),
+                 MandelbrotError::Code::InvalidValue);
+        MESSAGE(result.error().GetMessage());
+    }
+    SUBCASE("Center not a decimal number") {
+        auto result = BatchJob::Load(JobPath("batch_invalid3.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(),
+                 MandelbrotError::Code::InvalidValue);
+        MESSAGE(result.error().GetMessage());
+    }
+    SUBCASE("Unknown image format") {
+        auto result = BatchJob::Load(JobPath("batch_invalid4.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(),
+                 MandelbrotError::Code::InvalidValue);
+        MESSAGE(result.error().GetMessage());
+    }
+    SUBCASE("Keyframe without zoom") {
+        auto result = BatchJob::Load(JobPath("batch_invalid5.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(),
+                 MandelbrotError::Code::MissingOption);
+        MESSAGE(result.error().GetMessage());
+    }
+    SUBCASE("Exponential map with a moving center") {
+        auto result = BatchJob::Load(JobPath("batch_invalid6.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(),
+                 MandelbrotError::Code::InvalidValue);
+        MESSAGE(result.error().GetMessage());
+    }
+}
+
+TEST_CASE("03 - BatchJob::FrameView - keyframes are interpolated") {
+    auto result = BatchJob::Load(JobPath("batch_valid.toml"));
+    REQUIRE(result.has_value());
+    const auto &job = result.value();
+    const auto &first = job.GetKeyframes().front();
+    const auto &last = job.GetKeyframes().back();
+
+    // Keyframes are hit exactly
+    const auto first_view = job.FrameView(0);
+    CHECK_EQ(first_view.width, 64);
+    CHECK_EQ(first_view.height, 48);
+    CHECK_EQ(first_view.span_x, Viewport::DEFAULT_SPAN_X);
+    CHECK_EQ(first_view.span_y, Viewport::DEFAULT_SPAN_X * 48.0 / 64.0);
+    CHECK_EQ(first_view.center_x.ToDouble(), first.center_x.ToDouble());
+    const auto last_view = job.FrameView(4);
+    CHECK_EQ(last_view.Zoom(), doctest::Approx(last.zoom));
+    CHECK_EQ(last_view.center_x.ToString(30), last.center_x.ToString(30));
+    CHECK_EQ(last_view.center_y.ToString(30), last.center_y.ToString(30));
+    CHECK_EQ(job.FrameMaxIter(0), 100);
+    CHECK_EQ(job.FrameMaxIter(4), 1600);
+    CHECK_EQ(job.GetPeakMaxIter(), 1600);
+
+    // Zoom and iterations grow by the same factor every frame
+    const auto middle = job.FrameView(2);
+    CHECK_EQ(middle.Zoom(), doctest::Approx(100.0));
+    CHECK_EQ(job.FrameMaxIter(2), 400);
+
+    // The center covers the same share of its way as the span
+    const double progress = (first_view.span_x - middle.span_x) /
+                            (first_view.span_x - last_view.span_x);
+    const double expected_x =
+        first.center_x.ToDouble() +
+        ((last.center_x.ToDouble() - first.center_x.ToDouble()) * progress);
+    CHECK_EQ(middle.center_x.ToDouble(), doctest::Approx(expected_x));
+}
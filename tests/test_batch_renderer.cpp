@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#include "batch_job.hpp"
+#include "batch_renderer.hpp"
+#include "bounded_queue.hpp"
+#include "engine.hpp"
+#include "iteration_buffer.hpp"
+#include "mandelbrot_error.hpp"
+#include "palette.hpp"
+
+TEST_CASE("01 - BatchRenderer::Run - every frame reaches the sink") {
+    auto result = BatchJob::Load(std::filesystem::path(PROJECT_ROOT_PATH) /
+                                 "tests/configs/batch_valid.toml");
+    REQUIRE(result.has_value());
+    const auto job = result.value();
+
+    // Encoders run in parallel, frames arrive in any order
+    std::mutex mutex;
+    std::vector<BatchFrame> frames(static_cast<std::size_t>(
+        job.GetFrameCount()));
+    BatchRenderer renderer(
+        job, BatchSettings{.thread_count = 2, .encoder_count = 2,
+                           .queue_capacity = 1},
+        [&](const BatchFrame &frame) -> std::expected<void, MandelbrotError> {
+            const std::scoped_lock lock(mutex);
+            frames.at(static_cast<std::size_t>(frame.frame)) = frame;
+            return {};
+        });
+    const auto stats = renderer.Run();
+    REQUIRE(stats.has_value());
+    CHECK_EQ(stats->frames, job.GetFrameCount());
+
+    // Frames match a plain render of their view
+    Engine engine(EngineSettings{.max_iter = job.GetPeakMaxIter()});
+    const auto &palette_settings = job.GetPaletteSettings();
+    const auto palette = palette_settings.Generate();
+    IterationBuffer buffer;
+    for (int frame = 0; frame < job.GetFrameCount(); ++frame) {
+        const int max_iter = job.FrameMaxIter(frame);
+        engine.SetMaxIter(max_iter);
+        engine.RenderDeep(job.FrameView(frame), buffer);
+        std::vector<PackedColor> expected(buffer.GetSize());
+        engine.Colorize(buffer, palette,
+                        palette_settings.density *
+                            static_cast<float>(max_iter) /
+                            static_cast<float>(job.GetPeakMaxIter()),
+                        palette_settings.offset, expected);
+
+        const auto &rendered = frames[static_cast<std::size_t>(frame)];
+        CHECK_EQ(rendered.frame, frame);
+        CHECK_EQ(rendered.width, job.GetWidth());
+        CHECK_EQ(rendered.height, job.GetHeight());
+        CHECK(rendered.pixels == expected);
+    }
+}
+
+TEST_CASE("02 - BatchRenderer::Run - sink errors stop the run") {
+    auto result = BatchJob::Load(std::filesystem::path(PROJECT_ROOT_PATH) /
+                                 "tests/configs/batch_valid.toml");
+    REQUIRE(result.has_value());
+
+    BatchRenderer renderer(
+        result.value(), BatchSettings{.thread_count = 2},
+        [](const BatchFrame &frame) -> std::expected<void, MandelbrotError> {
+            if (frame.frame == 1) {
+                return std::unexpected(MandelbrotError(
+                    MandelbrotError::Code::WriteError, "Disk full"));
+            }
+            return {};
+        });
+    const auto stats = renderer.Run();
+    REQUIRE_FALSE(stats.has_value());
+    CHECK_EQ(stats.error().GetCode(), MandelbrotError::Code::WriteError);
+    CHECK_EQ(stats.error().GetMessage(), "Disk full");
+}
+
+TEST_CASE("03 - BoundedQueue::Pop - values arrive once and in order") {
+    BoundedQueue<int> queue(2);
+    CHECK_FALSE(queue.TryPop().has_value());
+    CHECK(queue.TryPush(1));
+    CHECK(queue.TryPush(2));
+    CHECK_FALSE(queue.TryPush(3));
+    CHECK_EQ(queue.Size(), 2U);
+    CHECK_EQ(queue.TryPop(), 1);
+    CHECK(queue.TryPush(3));
+    CHECK_EQ(queue.TryPop(), 2);
+    CHECK_EQ(queue.TryPop(), 3);
+    CHECK_EQ(queue.Size(), 0U);
+
+    // Producers and consumers block on a small queue
+    constexpr int producer_count = 2;
+    constexpr int value_count = 20000;
+    BoundedQueue<int> shared(3);
+    std::vector<int> seen(producer_count * value_count, 0);
+    std::mutex mutex;
+    {
+        std::vector<std::jthread> threads;
+        for (int producer = 0; producer < producer_count; ++producer) {
+            threads.emplace_back([&, producer]() {
+                for (int i = 0; i < value_count; ++i) {
+                    shared.Push((producer * value_count) + i, {});
+                }
+            });
+        }
+        for (int consumer = 0; consumer < 2; ++consumer) {
+            threads.emplace_back([&]() {
+                std::vector<int> taken;
+                for (int i = 0; i < value_count; ++i) {
+                    taken.push_back(*shared.Pop({}));
+                }
+                const std::scoped_lock lock(mutex);
+                for (const int value : taken) {
+                    ++seen[static_cast<std::size_t>(value)];
+                }
+            });
+        }
+    }
+    CHECK(std::ranges::all_of(seen, [](int count) { return count == 1; }));
+
+    // A stop request wakes a blocked call
+    BoundedQueue<int> empty(1);
+    std::stop_source stop;
+    std::optional<int> popped{0};
+    std::jthread waiter([&]() { popped = empty.Pop(stop.get_token()); });
+    stop.request_stop();
+    waiter.join();
+    CHECK_FALSE(popped.has_value());
+}
+
+TEST_CASE("04 - BatchRenderer::Run - every stage reports its work") {
+    auto result = BatchJob::Load(std::filesystem::path(PROJECT_ROOT_PATH) /
+                                 "tests/configs/batch_valid.toml");
+    REQUIRE(result.has_value());
+    const int frame_count = result->GetFrameCount();
+
+    const BatchSettings settings{.thread_count = 2,
+                                 .colorizer_count = 2,
+                                 .encoder_count = 3,
+                                 .queue_capacity = 2};
+    BatchRenderer renderer(
+        result.value(), settings,
+        [](const BatchFrame &) -> std::expected<void, MandelbrotError> {
+            return {};
+        });
+    const auto stats = renderer.Run();
+    REQUIRE(stats.has_value());
+    CHECK_EQ(stats->frames, frame_count);
+
+    const auto &compute = stats->Stage(BatchStage::Compute);
+    const auto &colorize = stats->Stage(BatchStage::Colorize);
+    const auto &encode = stats->Stage(BatchStage::Encode);
+    CHECK_EQ(compute.threads, 1U);
+    CHECK_EQ(colorize.threads, settings.colorizer_count);
+    CHECK_EQ(encode.threads, settings.encoder_count);
+    for (const auto &stage : stats->stages) {
+        CHECK_EQ(stage.frames, frame_count);
+        CHECK_GT(stage.Throughput(), 0.0);
+    }
+
+    // Only the stages behind a queue sample it
+    CHECK_EQ(compute.input_queue.capacity, 0U);
+    CHECK_EQ(colorize.input_queue.capacity, settings.queue_capacity);
+    CHECK_LE(colorize.input_queue.peak, settings.queue_capacity);
+    CHECK_LE(encode.input_queue.average,
+             static_cast<double>(settings.queue_capacity));
+    CHECK_GT(stats->pixels, 0U);
+}
@@ -0,0 +1,101 @@
+#include <string_view>
+
+#include "doctest.h"
+
+#include "big_fixed.hpp"
+#include "viewport.hpp"
+
+TEST_CASE("01 - BigFixed::FromString - decimal strings") {
+    SUBCASE("Valid numbers") {
+        const auto value = BigFixed::FromString("-1.25", 4);
+        REQUIRE(value.has_value());
+        CHECK(value->IsNegative());
+        CHECK_EQ(value->ToDouble(), -1.25);
+        CHECK_EQ(value->ToString(4), "-1.2500");
+
+        const auto integer = BigFixed::FromString("3", 4);
+        REQUIRE(integer.has_value());
+        CHECK_EQ(integer->ToDouble(), 3.0);
+
+        const auto fraction = BigFixed::FromString(".5", 4);
+        REQUIRE(fraction.has_value());
+        CHECK_EQ(fraction->ToDouble(), 0.5);
+    }
+    SUBCASE("Digits past double precision are kept") {
+        constexpr std::string_view text =
+            "0.1234567890123456789012345678901234567890";
+        const auto value = BigFixed::FromString(text, 8);
+        REQUIRE(value.has_value());
+        // NOTE: ToString() truncates, so trailing zeros may read as 9s
+        CHECK_EQ(value->ToString(38), text.substr(0, 40));
+    }
+    SUBCASE("Invalid numbers") {
+        CHECK_FALSE(BigFixed::FromString("", 4).has_value());
+        CHECK_FALSE(BigFixed::FromString("-", 4).has_value());
+        CHECK_FALSE(BigFixed::FromString("1.2.3", 4).has_value());
+        CHECK_FALSE(BigFixed::FromString("1e5", 4).has_value());
+        CHECK_FALSE(BigFixed::FromString("99999999999", 4).has_value());
+    }
+}
+
+TEST_CASE("02 - BigFixed - arithmetic matches double") {
+    const double values[] = {0.0, 1.0, -0.75, 0.1, -1.999, 2.5e-7};
+    for (const double lhs : values) {
+        for (const double rhs : values) {
+            const auto big_lhs = BigFixed::FromDouble(lhs, 4);
+            const auto big_rhs = BigFixed::FromDouble(rhs, 4);
+
+            // Sums of doubles in this range are exact in 128 fraction bits
+            CHECK_EQ((big_lhs + big_rhs).ToDouble(), lhs + rhs);
+            CHECK_EQ((big_lhs - big_rhs).ToDouble(), lhs - rhs);
+            CHECK_EQ((big_lhs * big_rhs).ToDouble(),
+                     doctest::Approx(lhs * rhs).epsilon(1e-15));
+        }
+    }
+}
+
+TEST_CASE("03 - BigFixed - precision beyond double") {
+    // 1/3 * 3 is 1 up to the last limb
+    const auto third = BigFixed::FromString(
+        "0.33333333333333333333333333333333333333333333333333", 6);
+    const auto three = BigFixed::FromDouble(3.0, 6);
+    REQUIRE(third.has_value());
+
+    const auto one = *third * three;
+    CHECK_EQ(one.ToString(40), "0.9999999999999999999999999999999999999999");
+
+    // Offsets far below double resolution survive additions
+    const auto base = BigFixed::FromDouble(-0.75, 6);
+    const auto offset = BigFixed::FromDouble(1e-40, 6);
+    const auto difference = (base + offset) - base;
+    CHECK_EQ(difference.ToDouble(), doctest::Approx(1e-40).epsilon(1e-9));
+
+    CHECK_GE(BigFixed::LimbsForResolution(1e-100), 12);
+}
+
+TEST_CASE("04 - DeepViewport::ZoomAt - zooms like the double viewport") {
+    const Viewport view{.width = 160, .height = 120};
+    const auto deep = DeepViewport::FromViewport(view);
+
+    const auto zoomed = deep.ZoomAt(37, 58, 3.0).ToViewport();
+    const auto expected = view.ZoomAt(37, 58, 3.0);
+    CHECK_EQ(zoomed.center_x, doctest::Approx(expected.center_x));
+    CHECK_EQ(zoomed.center_y, doctest::Approx(expected.center_y));
+    CHECK_EQ(zoomed.span_x, expected.span_x);
+    CHECK_EQ(zoomed.span_y, expected.span_y);
+
+    // Zooming far past double resolution adds fraction limbs
+    auto deeper = deep;
+    for (int i = 0; i < 40; ++i) {
+        deeper = deeper.ZoomAt(11, 7, 16.0);
+    }
+    CHECK_GT(deeper.center_x.GetFractionLimbs(),
+             BigFixed::DEFAULT_FRACTION_LIMBS);
+
+    // Moving by pixels shifts the center by whole pixel sizes
+    const auto moved = deep.MovedBy(10, -4).ToViewport();
+    CHECK_EQ(moved.center_x,
+             doctest::Approx(view.center_x + (10.0 * view.PixelWidth())));
+    CHECK_EQ(moved.center_y,
+             doctest::Approx(view.center_y - (4.0 * view.PixelHeight())));
+}
@@ -369,3 +369,154 @@ TEST_CASE("10 - Config::GetShaderPath - Shaders paths from valid config") {
             config.GetShaderPath(Config::ShaderType::Fragment));
     }
 }
+
+TEST_CASE("11 - Config::GetFractalSettings - fractal table") {
+    SUBCASE("Defaults without the table") {
+        auto result = Config::Load("tests/configs/config_valid1.toml");
+
+        REQUIRE(result.has_value());
+
+        const auto &fractal = result.value().GetFractalSettings();
+
+        CHECK(fractal.IsPlainMandelbrot());
+        CHECK_EQ(fractal.power, FractalSettings::MIN_POWER);
+    }
+    SUBCASE("Values from the table") {
+        auto result = Config::Load("tests/configs/config_valid_fractal.toml");
+
+        REQUIRE(result.has_value());
+
+        const auto &fractal = result.value().GetFractalSettings();
+
+        CHECK_EQ(fractal.formula, Formula::Multibrot);
+        CHECK_EQ(fractal.scalar, Scalar::DoubleDouble);
+        CHECK_EQ(fractal.power, 3);
+        CHECK_EQ(fractal.julia_x, doctest::Approx(0.285));
+        CHECK_EQ(fractal.julia_y, doctest::Approx(0.01));
+    }
+    SUBCASE("Unknown formula") {
+        auto result =
+            Config::Load("tests/configs/config_invalid_fractal1.toml");
+
+        REQUIRE_FALSE(result.has_value());
+
+        const auto &error = result.error();
+        CHECK_EQ(error.GetCode(), MandelbrotError::Code::InvalidValue);
+        MESSAGE(error.GetMessage());
+    }
+    SUBCASE("Power out of range") {
+        auto result =
+            Config::Load("tests/configs/config_invalid_fractal2.toml");
+
+        REQUIRE_FALSE(result.has_value());
+
+        const auto &error = result.error();
+        CHECK_EQ(error.GetCode(), MandelbrotError::Code::InvalidValue);
+        MESSAGE(error.GetMessage());
+    }
+    SUBCASE("Julia constant as string") {
+        auto result =
+            Config::Load("tests/configs/config_invalid_fractal3.toml");
+
+        REQUIRE_FALSE(result.has_value());
+
+        const auto &error = result.error();
+        CHECK_EQ(error.GetCode(), MandelbrotError::Code::InvalidValue);
+        MESSAGE(error.GetMessage());
+    }
+}
+
+TEST_CASE("12 - Config::GetPaletteSettings - palette table") {
+    SUBCASE("Defaults without the table") {
+        auto result = Config::Load("tests/configs/config_valid1.toml");
+
+        REQUIRE(result.has_value());
+
+        const auto &palette = result.value().GetPaletteSettings();
+
+        CHECK_EQ(palette.type, PaletteType::Hsv);
+        CHECK_EQ(palette.size, Palette::DEFAULT_SIZE);
+        CHECK_EQ(palette.Generate().GetSize(), Palette::DEFAULT_SIZE);
+    }
+    SUBCASE("Values from the table") {
+        auto result = Config::Load("tests/configs/config_valid_palette.toml");
+
+        REQUIRE(result.has_value());
+
+        const auto &palette = result.value().GetPaletteSettings();
+
+        CHECK_EQ(palette.type, PaletteType::Gradient);
+        CHECK_EQ(palette.size, 512U);
+        CHECK_EQ(palette.stops.size(), 5U);
+        CHECK_EQ(palette.density, doctest::Approx(4.0));
+        CHECK_EQ(palette.offset, doctest::Approx(0.25));
+        CHECK_EQ(palette.Generate().GetColors()[0],
+                 PackColor(palette.stops.front()));
+    }
+    SUBCASE("Unknown palette type") {
+        auto result =
+            Config::Load("tests/configs/config_invalid_palette1.toml");
+
+        REQUIRE_FALSE(result.has_value());
+
+        const auto &error = result.error();
+        CHECK_EQ(error.GetCode(), MandelbrotError::Code::InvalidValue);
+        MESSAGE(error.GetMessage());
+    }
+    SUBCASE("Color not written as hex") {
+        auto result =
+            Config::Load("tests/configs/config_invalid_palette2.toml");
+
+        REQUIRE_FALSE(result.has_value());
+
+        const auto &error = result.error();
+        CHECK_EQ(error.GetCode(), MandelbrotError::Code::InvalidValue);
+        MESSAGE(error.GetMessage());
+    }
+    SUBCASE("Gradient with a single color") {
+        auto result =
+            Config::Load("tests/configs/config_invalid_palette3.toml");
+
+        REQUIRE_FALSE(result.has_value());
+
+        const auto &error = result.error();
+        CHECK_EQ(error.GetCode(), MandelbrotError::Code::MissingOption);
+        MESSAGE(error.GetMessage());
+    }
+}
+
+TEST_CASE("13 - Config::GetRenderSettings - render table") {
+    SUBCASE("Defaults without the table") {
+        auto result = Config::Load("tests/configs/config_valid1.toml");
+
+        REQUIRE(result.has_value());
+
+        const auto &render = result.value().GetRenderSettings();
+
+        CHECK_EQ(render.max_iter, RenderSettings{}.max_iter);
+        CHECK_EQ(render.tile_cache, RenderSettings{}.tile_cache);
+        CHECK(render.tile_store.empty());
+    }
+    SUBCASE("Values from the table") {
+        auto result = Config::Load("tests/configs/config_valid_render.toml");
+
+        REQUIRE(result.has_value());
+
+        const auto &render = result.value().GetRenderSettings();
+
+        CHECK_EQ(render.max_iter, 5000);
+        CHECK_EQ(render.tile_cache, 0);
+        CHECK_EQ(render.tile_store,
+                 std::filesystem::path(Config::ROOT_SV) / "build/tiles.bin");
+        CHECK_EQ(render.tile_store_size, 64);
+    }
+    SUBCASE("Iterations out of range") {
+        auto result = Config::Load("tests/configs/config_invalid_render1.toml");
+
+        REQUIRE_FALSE(result.has_value());
+
+        const auto &error = result.error();
+        CHECK_EQ(error.GetCode(), MandelbrotError::Code::InvalidValue);
+        MESSAGE(error.GetMessage());
+    }
+}
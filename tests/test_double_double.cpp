@@ -0,0 +1,154 @@
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "doctest.h"
+
+#include "big_fixed.hpp"
+#include "double_double.hpp"
+#include "engine.hpp"
+#include "iteration_buffer.hpp"
+#include "kernels.hpp"
+#include "viewport.hpp"
+
+TEST_CASE("01 - DoubleDouble - arithmetic keeps 100 bits") {
+    constexpr std::size_t limbs = 8;
+    const auto a = *BigFixed::FromString("1.2345678901234567890123456789012345",
+                                         limbs);
+    const auto b = *BigFixed::FromString("-0.987654321098765432109876543210987",
+                                         limbs);
+    const auto dd_a = DoubleDouble::FromBigFixed(a);
+    const auto dd_b = DoubleDouble::FromBigFixed(b);
+
+    // Error of the double-double result relative to the exact one
+    const auto error = [&](const DoubleDouble &actual,
+                           const BigFixed &expected) {
+        const auto difference =
+            expected - BigFixed::FromDouble(actual.hi, limbs) -
+            BigFixed::FromDouble(actual.lo, limbs);
+        return std::fabs(difference.ToDouble() / expected.ToDouble());
+    };
+
+    // A double keeps only 53 bits
+    CHECK_GT(std::fabs((a - BigFixed::FromDouble(a.ToDouble(), limbs))
+                           .ToDouble()),
+             1e-20);
+
+    CHECK_LT(error(dd_a, a), 0x1p-100);
+    CHECK_LT(error(dd_a + dd_b, a + b), 0x1p-100);
+    CHECK_LT(error(dd_a - dd_b, a - b), 0x1p-100);
+    CHECK_LT(error(dd_a * dd_b, a * b), 0x1p-100);
+    CHECK_LT(error(dd_a * 3.0, a * BigFixed::FromDouble(3.0, limbs)),
+             0x1p-100);
+}
+
+TEST_CASE("02 - SelectDdRowKernel - vector kernel is bit-exact with scalar") {
+    // c = i at a zoom double precision cannot resolve
+    DeepViewport view;
+    view.center_x = *BigFixed::FromString("0.0", 8);
+    view.center_y = *BigFixed::FromString("1.0", 8);
+    view.span_x = 3.5e-20;
+    view.span_y = 2.5e-20;
+    // NOTE: Odd width, so the last vector is only partially used
+    view.width = 83;
+    view.height = 9;
+
+    const auto center_x = DoubleDouble::FromBigFixed(view.center_x);
+    const auto center_y = DoubleDouble::FromBigFixed(view.center_y);
+    for (std::size_t i = 0; i < ISA_COUNT; ++i) {
+        const auto isa = static_cast<Isa>(i);
+        if (!IsIsaSupported(isa)) {
+            MESSAGE("Skipping unsupported " << ISA_STR.at(i));
+            continue;
+        }
+        const auto kernel = SelectDdRowKernel(isa);
+
+        for (const bool check_interior : {false, true}) {
+            for (int y = 0; y < view.height; ++y) {
+                const DdRowParams params{
+                    .center_x = center_x,
+                    .offset_x = view.OffsetX(0),
+                    .step_x = view.PixelWidth(),
+                    .first_x = 0,
+                    .c_y = center_y + view.OffsetY(y),
+                    .max_iter = 500,
+                    .escape = 4.0,
+                    .check_interior = check_interior,
+                    .period_tolerance = view.PixelWidth() * 0x1p-10};
+                std::vector<float> expected(
+                    static_cast<std::size_t>(view.width));
+                std::vector<float> actual(static_cast<std::size_t>(view.width));
+
+                const auto expected_count =
+                    EscapeRowDdScalar(params, expected);
+                const auto actual_count = kernel(params, actual);
+
+                REQUIRE_EQ(actual_count.iterations, expected_count.iterations);
+                REQUIRE_EQ(actual_count.skipped, expected_count.skipped);
+                REQUIRE(actual == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("03 - Engine::RenderDeep - precision follows the pixel spacing") {
+    CHECK_EQ(AutoPrecision(3.5 / 800.0), Precision::Double);
+    CHECK_EQ(AutoPrecision(1e-15), Precision::DoubleDouble);
+    CHECK_EQ(AutoPrecision(1e-27), Precision::DoubleDouble);
+    CHECK_EQ(AutoPrecision(1e-30), Precision::Perturbation);
+
+    DeepViewport view;
+    view.center_x = *BigFixed::FromString("-0.75", 8);
+    view.center_y = *BigFixed::FromString("0.1", 8);
+    view.width = 16;
+    view.height = 16;
+
+    Engine engine(EngineSettings{.max_iter = 100});
+    IterationBuffer buffer;
+    view.span_x = view.span_y = 1e-3;
+    CHECK_EQ(engine.RenderDeep(view, buffer).precision, Precision::Double);
+    view.span_x = view.span_y = 1e-18;
+    CHECK_EQ(engine.RenderDeep(view, buffer).precision,
+             Precision::DoubleDouble);
+    view.span_x = view.span_y = 1e-40;
+    CHECK_EQ(engine.RenderDeep(view, buffer).precision,
+             Precision::Perturbation);
+
+    // Forced precision ignores the spacing
+    Engine forced(EngineSettings{.max_iter = 100,
+                                 .precision = Precision::DoubleDouble});
+    view.span_x = view.span_y = 1.0;
+    CHECK_EQ(forced.RenderDeep(view, buffer).precision,
+             Precision::DoubleDouble);
+}
+
+TEST_CASE("04 - Engine::RenderDeep - double-double matches perturbation") {
+    // c = i is a boundary point with detail at every zoom level
+    DeepViewport view;
+    view.center_x = *BigFixed::FromString("0.0", 8);
+    view.center_y = *BigFixed::FromString("1.0", 8);
+    view.span_x = 3.5e-20;
+    view.span_y = 2.5e-20;
+    view.width = 70;
+    view.height = 50;
+
+    Engine double_double(EngineSettings{.max_iter = 1000});
+    Engine perturbation(EngineSettings{.max_iter = 1000,
+                                       .precision = Precision::Perturbation});
+    IterationBuffer expected;
+    IterationBuffer actual;
+    perturbation.RenderDeep(view, expected);
+    const auto stats = double_double.RenderDeep(view, actual);
+    CHECK_EQ(stats.precision, Precision::DoubleDouble);
+
+    // Pixels must differ from each other, a double render would be one block
+    CHECK_NE(actual.At(0, 0), actual.At(69, 49));
+
+    std::size_t matching = 0;
+    for (std::size_t i = 0; i < expected.GetSize(); ++i) {
+        if (std::fabs(actual.Values()[i] - expected.Values()[i]) <= 1e-3F) {
+            ++matching;
+        }
+    }
+    CHECK_GE(matching, expected.GetSize() * 99 / 100);
+}
@@ -0,0 +1,548 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+#include "doctest.h"
+
+#include "big_fixed.hpp"
+#include "engine.hpp"
+#include "escape_time.hpp"
+#include "iteration_buffer.hpp"
+#include "palette.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Small default view used by the tests
+Viewport TestViewport() {
+    Viewport view;
+    view.width = 140;
+    view.height = 100;
+    return view;
+}
+
+// Mean difference of the color components of two frames
+double ColorError(std::span<const PackedColor> lhs,
+                  std::span<const PackedColor> rhs) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        const auto left = std::bit_cast<std::array<std::uint8_t, 4>>(lhs[i]);
+        const auto right = std::bit_cast<std::array<std::uint8_t, 4>>(rhs[i]);
+        for (std::size_t c = 0; c < 3; ++c) {
+            sum += std::abs(static_cast<int>(left[c]) -
+                            static_cast<int>(right[c]));
+        }
+    }
+    return sum / static_cast<double>(lhs.size() * 3);
+}
+
+// Colors of the view rendered at factor x factor samples per pixel and
+// averaged, brute-force supersampling
+std::vector<PackedColor> Supersampled(Engine &engine, const DeepViewport &view,
+                                      const Palette &palette, int factor) {
+    DeepViewport large = view;
+    large.width *= factor;
+    large.height *= factor;
+    IterationBuffer buffer;
+    engine.RenderDeep(large, buffer);
+    std::vector<PackedColor> colors(buffer.GetSize());
+    engine.Colorize(buffer, palette, 1.0F, 0.0F, colors);
+
+    std::vector<PackedColor> averaged;
+    const auto samples = static_cast<std::uint32_t>(factor * factor);
+    for (int y = 0; y < view.height; ++y) {
+        for (int x = 0; x < view.width; ++x) {
+            std::array<std::uint32_t, 3> sum{};
+            for (int s_y = 0; s_y < factor; ++s_y) {
+                for (int s_x = 0; s_x < factor; ++s_x) {
+                    const auto color =
+                        std::bit_cast<std::array<std::uint8_t, 4>>(
+                            colors[static_cast<std::size_t>(
+                                ((y * factor + s_y) * large.width) +
+                                (x * factor) + s_x)]);
+                    for (std::size_t c = 0; c < sum.size(); ++c) {
+                        sum[c] += color[c];
+                    }
+                }
+            }
+            averaged.push_back(std::bit_cast<PackedColor>(
+                std::array<std::uint8_t, 4>{
+                    static_cast<std::uint8_t>(sum[0] / samples),
+                    static_cast<std::uint8_t>(sum[1] / samples),
+                    static_cast<std::uint8_t>(sum[2] / samples), 255}));
+        }
+    }
+    return averaged;
+}
+}  // namespace
+
+TEST_CASE("01 - Engine::Render - matches the scalar escape algorithm") {
+    const auto view = TestViewport();
+    Engine engine(EngineSettings{.max_iter = 50, .escape = 4.0});
+
+    IterationBuffer buffer;
+    const auto stats = engine.Render(view, buffer);
+
+    REQUIRE_EQ(buffer.GetWidth(), view.width);
+    REQUIRE_EQ(buffer.GetHeight(), view.height);
+    CHECK_EQ(stats.pixels, buffer.GetSize());
+    CHECK_GT(stats.iterations, 0);
+
+    for (int y = 0; y < view.height; y += 7) {
+        for (int x = 0; x < view.width; x += 5) {
+            const auto result =
+                EscapeTime(view.PixelX(x), view.PixelY(y), 50, 4.0);
+            const float expected =
+                SmoothIteration(result.iter, result.z_x, result.z_y, 50);
+            CHECK_EQ(buffer.At(x, y), expected);
+        }
+    }
+}
+
+TEST_CASE("02 - Engine::Render - interior and exterior points") {
+    Viewport view;
+    view.width = 3;
+    view.height = 1;
+    // Pixels sample -2.5, 0.0 and 2.5 on the real axis
+    view.center_x = 0.0;
+    view.span_x = 7.5;
+    view.span_y = 0.1;
+
+    Engine engine(EngineSettings{.max_iter = 100});
+    IterationBuffer buffer;
+    engine.Render(view, buffer);
+
+    // Outside of the set
+    CHECK_LT(buffer.At(0, 0), 100.0F);
+    CHECK_LT(buffer.At(2, 0), 100.0F);
+    // Origin never escapes
+    CHECK_EQ(buffer.At(1, 0), 100.0F);
+}
+
+TEST_CASE("03 - Engine::Render - result does not depend on thread count") {
+    const auto view = TestViewport();
+    Engine single(EngineSettings{.thread_count = 1});
+    Engine multi(EngineSettings{.thread_count = 4});
+
+    REQUIRE_EQ(single.GetThreadCount(), 1);
+    REQUIRE_EQ(multi.GetThreadCount(), 4);
+
+    IterationBuffer single_buffer;
+    IterationBuffer multi_buffer;
+    const auto single_stats = single.Render(view, single_buffer);
+    const auto multi_stats = multi.Render(view, multi_buffer);
+
+    CHECK_EQ(single_stats.iterations, multi_stats.iterations);
+    CHECK(std::ranges::equal(single_buffer.Values(), multi_buffer.Values()));
+}
+
+TEST_CASE("04 - Engine::Render - result does not depend on tile size") {
+    const auto view = TestViewport();
+    Engine small_tiles(EngineSettings{.thread_count = 3, .tile_size = 7});
+    Engine large_tiles(EngineSettings{.thread_count = 3, .tile_size = 512});
+
+    IterationBuffer small_buffer;
+    IterationBuffer large_buffer;
+    const auto small_stats = small_tiles.Render(view, small_buffer);
+    const auto large_stats = large_tiles.Render(view, large_buffer);
+
+    CHECK_EQ(small_stats.iterations, large_stats.iterations);
+    CHECK(std::ranges::equal(small_buffer.Values(), large_buffer.Values()));
+
+    // Every worker reports its time
+    REQUIRE_EQ(small_stats.scheduling.workers.size(), 3);
+    std::uint64_t tiles = 0;
+    for (const auto &worker : small_stats.scheduling.workers) {
+        tiles += worker.tasks;
+    }
+    // 140x100 pixels in 7x7 tiles
+    CHECK_EQ(tiles, 20 * 15);
+}
+
+TEST_CASE("05 - Engine::Render - interior checks skip iterations") {
+    auto view = TestViewport();
+    Engine checked(EngineSettings{.max_iter = 1000, .interior_check = true});
+    Engine full(EngineSettings{.max_iter = 1000, .interior_check = false});
+
+    IterationBuffer checked_buffer;
+    IterationBuffer full_buffer;
+    const auto checked_stats = checked.Render(view, checked_buffer);
+    const auto full_stats = full.Render(view, full_buffer);
+
+    // Same image and the same iteration count, most of it skipped
+    CHECK(std::ranges::equal(checked_buffer.Values(), full_buffer.Values()));
+    CHECK_EQ(checked_stats.iterations, full_stats.iterations);
+    CHECK_EQ(full_stats.skipped_iterations, 0);
+    CHECK_GT(checked_stats.skipped_iterations, full_stats.iterations / 2);
+    MESSAGE("Skipped " << checked_stats.skipped_iterations << " of "
+                       << checked_stats.iterations << " iterations");
+}
+
+TEST_CASE("06 - Engine::Render - Mariani-Silver matches brute force") {
+    // Elephant valley, along the edge of the main cardioid
+    Viewport elephants;
+    elephants.width = 160;
+    elephants.height = 120;
+    elephants.center_x = 0.275;
+    elephants.center_y = 0.0;
+    elephants.span_x = 0.04;
+    elephants.span_y = 0.03;
+
+    Viewport deep;
+    deep.width = 96;
+    deep.height = 64;
+    deep.center_x = -0.75;
+    deep.center_y = 0.1;
+    deep.span_x = 1.5e-14;
+    deep.span_y = 1e-14;
+
+    for (const auto &view : {TestViewport(), elephants, deep}) {
+        for (const bool interior_check : {false, true}) {
+            // NOTE: Odd tile size, so some tiles are too small to subdivide
+            const EngineSettings settings{.max_iter = 500,
+                                          .tile_size = 37,
+                                          .interior_check = interior_check};
+            auto subdivided_settings = settings;
+            subdivided_settings.render_mode = RenderMode::MarianiSilver;
+            Engine brute_force(settings);
+            Engine subdivided(subdivided_settings);
+
+            IterationBuffer expected;
+            IterationBuffer actual;
+            const auto expected_stats = brute_force.Render(view, expected);
+            const auto actual_stats = subdivided.Render(view, actual);
+
+            CHECK_EQ(actual_stats.precision, expected_stats.precision);
+            CHECK(std::ranges::equal(actual.Values(), expected.Values()));
+            // Filled pixels are not iterated
+            CHECK_LT(actual_stats.iterations - actual_stats.skipped_iterations,
+                     expected_stats.iterations -
+                         expected_stats.skipped_iterations);
+        }
+    }
+}
+
+TEST_CASE("07 - Engine::RenderPan - renders only the exposed strips") {
+    // NOTE: Pixels are 1/32 wide, so every pixel coordinate is exact and the
+    // shifted values are bit-exact with a full render
+    Viewport view;
+    view.width = 128;
+    view.height = 96;
+    view.span_x = 4.0;
+    view.span_y = 3.0;
+
+    Engine engine(EngineSettings{.max_iter = 200, .tile_size = 32});
+    IterationBuffer buffer;
+    IterationBuffer expected;
+    engine.Render(view, buffer);
+
+    for (const auto &[offset_x, offset_y] :
+         {std::array{5, -3}, std::array{-17, 0}, std::array{0, 40},
+          std::array{-127, -95}, std::array{0, 0}}) {
+        const auto previous = view;
+        view.center_x += offset_x * view.PixelWidth();
+        view.center_y += offset_y * view.PixelHeight();
+
+        const auto stats = engine.RenderPan(previous, view, buffer);
+        engine.Render(view, expected);
+
+        const auto kept = static_cast<std::uint64_t>(
+            (view.width - std::abs(offset_x)) *
+            (view.height - std::abs(offset_y)));
+        CHECK_EQ(stats.pixels, expected.GetSize() - kept);
+        CHECK(std::ranges::equal(buffer.Values(), expected.Values()));
+    }
+
+    // Zooms and moves by a fraction of a pixel render the full frame
+    auto zoomed = view;
+    zoomed.span_x /= 2.0;
+    zoomed.span_y /= 2.0;
+    CHECK_EQ(engine.RenderPan(view, zoomed, buffer).pixels, buffer.GetSize());
+    auto moved = zoomed;
+    moved.center_x += 0.5 * moved.PixelWidth();
+    CHECK_EQ(engine.RenderPan(zoomed, moved, buffer).pixels, buffer.GetSize());
+}
+
+TEST_CASE("08 - Engine::RenderProgressive - passes refine to the frame") {
+    DeepViewport shallow = DeepViewport::FromViewport(TestViewport());
+    // NOTE: Odd size, so the last blocks are cut off
+    shallow.width = 77;
+    shallow.height = 45;
+    DeepViewport double_double = shallow;
+    double_double.center_x = *BigFixed::FromString("-0.75", 8);
+    double_double.center_y = *BigFixed::FromString("0.1", 8);
+    double_double.span_x = double_double.span_y = 1e-18;
+    DeepViewport perturbation = shallow;
+    perturbation.center_x = *BigFixed::FromString("0.0", 8);
+    perturbation.center_y = *BigFixed::FromString("1.0", 8);
+    perturbation.span_x = perturbation.span_y = 1e-40;
+
+    Engine engine(EngineSettings{.max_iter = 300});
+    for (const auto &view : {shallow, double_double, perturbation}) {
+        IterationBuffer expected;
+        const auto expected_stats = engine.RenderDeep(view, expected);
+
+        IterationBuffer buffer;
+        std::vector<int> blocks;
+        bool preview_in_blocks = true;
+        const auto stats = engine.RenderProgressive(
+            view, buffer, [&](const IterationBuffer &pass, int block) {
+                blocks.push_back(block);
+                if (block == 8) {
+                    preview_in_blocks = pass.At(7, 7) == pass.At(0, 0) &&
+                                        pass.At(76, 44) == pass.At(72, 40);
+                }
+            });
+
+        CHECK_EQ(stats.precision, expected_stats.precision);
+        CHECK(blocks == std::vector<int>({8, 4, 2, 1}));
+        CHECK(preview_in_blocks);
+        // Every pixel is rendered once
+        CHECK_EQ(stats.pixels, buffer.GetSize());
+        CHECK(std::ranges::equal(buffer.Values(), expected.Values()));
+    }
+
+    // The reference escapes early while the left part of the view lies
+    // inside the set, so every pass has glitched samples
+    Viewport glitched;
+    glitched.width = 70;
+    glitched.height = 50;
+    glitched.center_x = 0.26;
+    glitched.center_y = 0.0;
+    glitched.span_x = 0.035;
+    glitched.span_y = 0.025;
+    const auto view = DeepViewport::FromViewport(glitched);
+    Engine engine_glitched(EngineSettings{
+        .max_iter = 500, .precision = Precision::Perturbation});
+    for (const int last_block_size : {8, 1}) {
+        // Stale values of an earlier frame must not reach any pass
+        IterationBuffer buffer(view.width, view.height);
+        std::ranges::fill(buffer.Values(),
+                          std::numeric_limits<float>::quiet_NaN());
+        const auto is_stale = [](float value) { return std::isnan(value); };
+        bool stale = false;
+        const auto stats = engine_glitched.RenderProgressive(
+            view, buffer,
+            [&](const IterationBuffer &pass, int) {
+                stale = stale || std::ranges::any_of(pass.Values(), is_stale);
+            },
+            last_block_size);
+
+        CHECK_FALSE(stale);
+        CHECK_GT(stats.glitched_pixels, 0);
+    }
+}
+
+TEST_CASE("09 - Engine::RenderResumable - raised limit continues undecided "
+          "pixels") {
+    // Elephant valley, with interior and slowly escaping pixels
+    DeepViewport view;
+    view.center_x = *BigFixed::FromString("0.275", 8);
+    view.center_y = *BigFixed::FromString("0.0", 8);
+    view.span_x = view.span_y = 0.04;
+    view.width = 64;
+    view.height = 48;
+
+    for (const auto precision : {Precision::Double, Precision::DoubleDouble}) {
+        for (const bool interior_check : {false, true}) {
+            Engine low(EngineSettings{.max_iter = 200,
+                                      .precision = precision,
+                                      .interior_check = interior_check});
+            Engine high(EngineSettings{.max_iter = 2000,
+                                       .precision = precision,
+                                       .interior_check = interior_check});
+            IterationBuffer expected;
+            const auto expected_stats = high.RenderDeep(view, expected);
+
+            ResumeState state;
+            IterationBuffer buffer;
+            const auto low_stats = low.RenderResumable(view, buffer, state);
+            const auto undecided = state.orbits.size();
+            REQUIRE_GT(undecided, 0);
+            CHECK_LT(undecided, buffer.GetSize());
+
+            // Only the kept orbits continue, none of their first 200
+            // iterations are repeated
+            const auto stats = high.RenderResumable(view, buffer, state);
+            MESSAGE("Continued " << stats.pixels << " pixels with "
+                                 << stats.iterations << " of "
+                                 << expected_stats.iterations
+                                 << " iterations");
+            CHECK_EQ(stats.precision, precision);
+            CHECK_EQ(stats.pixels, undecided);
+            CHECK_LE(low_stats.iterations + stats.iterations,
+                     expected_stats.iterations);
+            CHECK_LE(state.orbits.size(), undecided);
+            CHECK_EQ(state.max_iter, 2000);
+            CHECK(std::ranges::equal(buffer.Values(), expected.Values()));
+
+            // A changed view starts from z = 0
+            view.span_x = view.span_y = 0.05;
+            const auto moved_stats = low.RenderResumable(view, buffer, state);
+            CHECK_EQ(moved_stats.pixels, buffer.GetSize());
+            view.span_x = view.span_y = 0.04;
+        }
+    }
+}
+
+TEST_CASE("10 - Engine::SetStopToken - cancelled renders stop early") {
+    const auto shallow = DeepViewport::FromViewport(TestViewport());
+    DeepViewport perturbation = shallow;
+    perturbation.center_x = *BigFixed::FromString("0.0", 8);
+    perturbation.center_y = *BigFixed::FromString("1.0", 8);
+    perturbation.span_x = perturbation.span_y = 1e-40;
+
+    Engine engine(EngineSettings{.max_iter = 300});
+    std::stop_source source;
+    engine.SetStopToken(source.get_token());
+    source.request_stop();
+
+    // No tile is rendered once a stop is requested
+    for (const auto &view : {shallow, perturbation}) {
+        IterationBuffer buffer;
+        const auto stats = engine.RenderDeep(view, buffer);
+        CHECK(stats.cancelled);
+        CHECK_EQ(stats.cancelled_pixels, stats.pixels);
+        CHECK_EQ(stats.iterations, 0);
+        CHECK_EQ(stats.extra_references, 0);
+    }
+
+    // Cancelled passes are not published
+    IterationBuffer buffer;
+    int passes = 0;
+    const auto progressive = engine.RenderProgressive(
+        shallow, buffer, [&](const IterationBuffer &, int) { ++passes; });
+    CHECK(progressive.cancelled);
+    CHECK_EQ(passes, 0);
+
+    // Cancelled orbits are not kept
+    ResumeState state;
+    const auto resumable = engine.RenderResumable(shallow, buffer, state);
+    CHECK(resumable.cancelled);
+    CHECK_EQ(state.max_iter, 0);
+    CHECK(state.orbits.empty());
+
+    // A new token renders again
+    engine.SetStopToken({});
+    const auto stats = engine.RenderDeep(shallow, buffer);
+    CHECK_FALSE(stats.cancelled);
+    CHECK_EQ(stats.cancelled_pixels, 0);
+}
+
+TEST_CASE("11 - Engine::RenderAntialiased - only edges are supersampled") {
+    const auto view = DeepViewport::FromViewport(TestViewport());
+    Engine engine(EngineSettings{.max_iter = 100, .thread_count = 2});
+    const auto palette = PaletteSettings{}.Generate();
+
+    IterationBuffer single;
+    engine.RenderDeep(view, single);
+    std::vector<PackedColor> single_colors(single.GetSize());
+    engine.Colorize(single, palette, 1.0F, 0.0F, single_colors);
+
+    // The buffer holds the single samples, only edge pixels change color
+    IterationBuffer buffer;
+    std::vector<PackedColor> colors(single.GetSize());
+    const auto stats = engine.RenderAntialiased(view, buffer, palette, 1.0F,
+                                                0.0F, colors);
+    CHECK(std::ranges::equal(buffer.Values(), single.Values()));
+    CHECK_GT(stats.antialiased_pixels, 0U);
+    CHECK_LT(stats.antialiased_pixels, single.GetSize() / 2);
+    CHECK_EQ(stats.pixels, single.GetSize() + (stats.antialiased_pixels * 16));
+    // NOTE: Brute force takes 16 samples of every pixel
+    CHECK_LT(stats.pixels, single.GetSize() * 4);
+    std::size_t changed = 0;
+    for (std::size_t i = 0; i < colors.size(); ++i) {
+        changed += colors[i] != single_colors[i] ? 1U : 0U;
+    }
+    CHECK_LE(changed, stats.antialiased_pixels);
+
+    // Closer to brute-force supersampling than the single samples
+    const auto reference = Supersampled(engine, view, palette, 4);
+    const double single_error = ColorError(single_colors, reference);
+    const double error = ColorError(colors, reference);
+    CHECK_LT(error, 0.5 * single_error);
+
+    // A grid of 1 keeps the single samples
+    const auto off = engine.RenderAntialiased(
+        view, buffer, palette, 1.0F, 0.0F, colors,
+        AntialiasSettings{.grid = 1});
+    CHECK_EQ(off.antialiased_pixels, 0U);
+    CHECK(colors == single_colors);
+}
+
+TEST_CASE("12 - Engine::RenderAntialiased - every precision") {
+    DeepViewport view = DeepViewport::FromViewport(TestViewport());
+    view.center_x = *BigFixed::FromString("0.0", 8);
+    view.center_y = *BigFixed::FromString("1.0", 8);
+    Engine engine(EngineSettings{.max_iter = 400, .thread_count = 2});
+    const auto palette = PaletteSettings{}.Generate();
+
+    for (const auto &[span, precision] :
+         {std::pair{1e-3, Precision::Double},
+          std::pair{1e-14, Precision::DoubleDouble},
+          std::pair{1e-40, Precision::Perturbation}}) {
+        view.span_x = span;
+        view.span_y = span * 100.0 / 140.0;
+        IterationBuffer buffer;
+        std::vector<PackedColor> colors(
+            static_cast<std::size_t>(view.width * view.height));
+        const auto stats = engine.RenderAntialiased(view, buffer, palette,
+                                                    1.0F, 0.0F, colors);
+        CHECK_EQ(stats.precision, precision);
+        CHECK_FALSE(stats.cancelled);
+        CHECK_GT(stats.antialiased_pixels, 0U);
+
+        std::vector<PackedColor> single_colors(colors.size());
+        engine.Colorize(buffer, palette, 1.0F, 0.0F, single_colors);
+        const auto reference = Supersampled(engine, view, palette, 4);
+        const double single_error = ColorError(single_colors, reference);
+        const double error = ColorError(colors, reference);
+        CHECK_LT(error, single_error);
+    }
+}
+
+TEST_CASE("13 - Engine::RenderAntialiased - glitched sub-samples are "
+          "corrected") {
+    // The reference escapes after a few dozen iterations while the left part
+    // of the view lies inside the set, so many samples outlive it
+    Viewport shallow = TestViewport();
+    shallow.center_x = 0.26;
+    shallow.span_x = 0.035;
+    shallow.span_y = 0.025;
+    const auto view = DeepViewport::FromViewport(shallow);
+    const auto palette = PaletteSettings{}.Generate();
+
+    Engine expected_engine(EngineSettings{.max_iter = 500});
+    IterationBuffer buffer;
+    std::vector<PackedColor> expected(
+        static_cast<std::size_t>(view.width * view.height));
+    expected_engine.RenderAntialiased(view, buffer, palette, 1.0F, 0.0F,
+                                      expected);
+
+    Engine engine(EngineSettings{.max_iter = 500,
+                                 .thread_count = 2,
+                                 .precision = Precision::Perturbation});
+    const auto single = engine.RenderDeep(view, buffer);
+    std::vector<PackedColor> colors(expected.size());
+    const auto stats =
+        engine.RenderAntialiased(view, buffer, palette, 1.0F, 0.0F, colors);
+    CHECK_EQ(stats.precision, Precision::Perturbation);
+    CHECK_GT(stats.antialiased_pixels, 0U);
+    // Glitched sub-samples are counted on top of the single samples
+    CHECK_GT(stats.glitched_pixels, single.glitched_pixels);
+    CHECK_GT(stats.extra_references, single.extra_references);
+
+    // NOTE: Rounding differs, so a few pixels near the boundary may differ
+    std::size_t matching = 0;
+    for (std::size_t i = 0; i < colors.size(); ++i) {
+        matching += colors[i] == expected[i] ? 1U : 0U;
+    }
+    CHECK_GE(matching, colors.size() * 99 / 100);
+}
@@ -0,0 +1,146 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <numbers>
+
+#include "doctest.h"
+
+#include "batch_job.hpp"
+#include "big_fixed.hpp"
+#include "engine.hpp"
+#include "escape_time.hpp"
+#include "exp_map.hpp"
+#include "iteration_buffer.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Smooth iteration count iterated fully in high precision, the ground truth
+// of deep samples
+float BigFixedIteration(const BigFixed &c_x, const BigFixed &c_y,
+                        int max_iter) {
+    constexpr double escape = 4.0;
+    BigFixed z_x(c_x.GetFractionLimbs());
+    BigFixed z_y(c_x.GetFractionLimbs());
+    for (int iter = 0; iter < max_iter; ++iter) {
+        const double x = z_x.ToDouble();
+        const double y = z_y.ToDouble();
+        if ((x * x) + (y * y) > escape) {
+            const double next_x = (x * x) - (y * y) + c_x.ToDouble();
+            const double next_y = (2.0 * x * y) + c_y.ToDouble();
+            return SmoothIteration(iter + 1, next_x, next_y, max_iter);
+        }
+        const auto z2_x = z_x * z_x;
+        const auto z2_y = z_y * z_y;
+        const auto z_xy = z_x * z_y;
+        z_y = z_xy + z_xy + c_y;
+        z_x = z2_x - z2_y + c_x;
+    }
+    return static_cast<float>(max_iter);
+}
+}  // namespace
+
+TEST_CASE("01 - ExpMapZoom::RenderFrame - frames match direct renders") {
+    auto result = BatchJob::Load(std::filesystem::path(PROJECT_ROOT_PATH) /
+                                 "tests/configs/batch_exp_map.toml");
+    REQUIRE(result.has_value());
+    const auto &job = result.value();
+    REQUIRE(job.IsExpMap());
+
+    Engine engine(EngineSettings{.max_iter = job.GetPeakMaxIter()});
+    ExpMapZoom zoom(job);
+    IterationBuffer mapped;
+    IterationBuffer direct;
+    for (int frame = 0; frame < job.GetFrameCount(); ++frame) {
+        const auto stats = zoom.RenderFrame(engine, frame, mapped);
+        CHECK_FALSE(stats.cancelled);
+        engine.SetMaxIter(job.GetPeakMaxIter());
+        engine.RenderDeep(job.FrameView(frame), direct);
+        REQUIRE_EQ(mapped.GetWidth(), direct.GetWidth());
+        REQUIRE_EQ(mapped.GetHeight(), direct.GetHeight());
+
+        // NOTE: Samples sit between the pixels, only pixels on fine detail
+        // differ
+        std::size_t close = 0;
+        for (std::size_t i = 0; i < direct.GetSize(); ++i) {
+            if (std::fabs(mapped.Values()[i] - direct.Values()[i]) < 1.0F) {
+                ++close;
+            }
+        }
+        CHECK_GT(static_cast<double>(close),
+                 0.9 * static_cast<double>(direct.GetSize()));
+    }
+}
+
+TEST_CASE("02 - ExpMapZoom::RenderFrame - every band is rendered once") {
+    auto result = BatchJob::Load(std::filesystem::path(PROJECT_ROOT_PATH) /
+                                 "tests/configs/batch_exp_map.toml");
+    REQUIRE(result.has_value());
+    const auto &job = result.value();
+
+    Engine engine(EngineSettings{.max_iter = job.GetPeakMaxIter()});
+    ExpMapZoom zoom(job);
+    IterationBuffer buffer;
+    std::uint64_t pixels = 0;
+    for (int frame = 0; frame < job.GetFrameCount(); ++frame) {
+        pixels += zoom.RenderFrame(engine, frame, buffer).pixels;
+    }
+
+    // The strip reaches from the corners of the first frame to half a pixel
+    // of the last, plus the partial bands at both ends
+    const auto band_pixels = static_cast<std::uint64_t>(zoom.GetBandRows()) *
+                             static_cast<std::uint64_t>(zoom.GetSamples());
+    const double step = 2.0 * std::numbers::pi /
+                        static_cast<double>(zoom.GetSamples());
+    const double corner = std::hypot(job.GetWidth() / 2.0,
+                                     job.GetHeight() / 2.0);
+    const double rows =
+        std::log(job.GetKeyframes().back().zoom * corner / 0.5) / step;
+    CHECK_EQ(pixels % band_pixels, 0U);
+    CHECK_LE(pixels, static_cast<std::uint64_t>(
+                         (rows + (3.0 * zoom.GetBandRows())) *
+                         static_cast<double>(zoom.GetSamples())));
+
+    // Frames of kept bands only remap
+    CHECK_EQ(zoom.RenderFrame(engine, job.GetFrameCount() - 1, buffer).pixels,
+             0U);
+}
+
+TEST_CASE("03 - Engine::RenderExpMap - deep glitches get new references") {
+    // Rows around a Misiurewicz point far past double precision, samples
+    // whose orbit passes closer to 0 than the one at the center glitch
+    constexpr std::size_t limbs = 4;
+    const ExpMapView view{
+        .center_x = *BigFixed::FromString("-0.1010963638456221", limbs),
+        .center_y = *BigFixed::FromString("0.9562865108091415", limbs),
+        .radius = 1e-15,
+        .width = 64,
+        .height = 8};
+    constexpr int max_iter = 1000;
+    Engine engine(EngineSettings{.max_iter = max_iter});
+    IterationBuffer buffer;
+    const auto stats = engine.RenderExpMap(view, buffer);
+
+    CHECK_EQ(stats.precision, Precision::Perturbation);
+    CHECK_GT(stats.glitched_pixels, 0U);
+    CHECK_GT(stats.extra_references, 0U);
+
+    std::size_t matching = 0;
+    for (int y = 0; y < view.height; ++y) {
+        for (int x = 0; x < view.width; ++x) {
+            const double radius = view.Radius(y);
+            const auto expected = BigFixedIteration(
+                view.center_x +
+                    BigFixed::FromDouble(radius * std::cos(view.Angle(x)),
+                                         limbs),
+                view.center_y +
+                    BigFixed::FromDouble(radius * std::sin(view.Angle(x)),
+                                         limbs),
+                max_iter);
+            if (std::fabs(buffer.At(x, y) - expected) < 1e-3F) {
+                ++matching;
+            }
+        }
+    }
+    CHECK_GE(matching, buffer.GetSize() * 99 / 100);
+}
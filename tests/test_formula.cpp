@@ -0,0 +1,154 @@
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "doctest.h"
+
+#include "double_double.hpp"
+#include "engine.hpp"
+#include "escape_time.hpp"
+#include "fixed_point.hpp"
+#include "formula.hpp"
+#include "iteration_buffer.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Render a row of the default view with the kernel
+std::vector<float> RenderRow(FormulaRowKernel kernel, double c_y,
+                             int max_iter) {
+    constexpr int width = 175;
+    const DeepViewport view{.width = width, .height = 1};
+    const FormulaRowParams params{
+        .center_x = DoubleDouble::FromBigFixed(view.center_x),
+        .offset_x = view.OffsetX(0),
+        .step_x = view.PixelWidth(),
+        .first_x = 0,
+        .c_y = DoubleDouble(c_y),
+        .julia_x = FractalSettings::DEFAULT_JULIA_X,
+        .julia_y = FractalSettings::DEFAULT_JULIA_Y,
+        .max_iter = max_iter,
+        .escape = 4.0};
+    std::vector<float> row(static_cast<std::size_t>(width));
+    kernel(params, row);
+    return row;
+}
+}  // namespace
+
+TEST_CASE("01 - FormulaEscapeTime - double Mandelbrot matches EscapeTime") {
+    for (double c_y = -1.25; c_y <= 1.25; c_y += 0.0625) {
+        for (double c_x = -2.5; c_x <= 1.0; c_x += 0.0625) {
+            const auto expected = EscapeTime(c_x, c_y, 100, 4.0);
+            const auto actual = FormulaEscapeTime<double, MandelbrotFormula>(
+                MandelbrotFormula::Start(c_x, c_y, 0.0, 0.0), 100, 4.0);
+            REQUIRE_EQ(actual.iter, expected.iter);
+            REQUIRE_EQ(actual.z_x, expected.z_x);
+            REQUIRE_EQ(actual.z_y, expected.z_y);
+        }
+    }
+
+    // Power 2 Multibrot is the Mandelbrot set
+    const auto mandelbrot = FormulaEscapeTime<double, MandelbrotFormula>(
+        MandelbrotFormula::Start(-0.75, 0.1, 0.0, 0.0), 100, 4.0);
+    const auto multibrot = FormulaEscapeTime<double, MultibrotFormula<2>>(
+        MultibrotFormula<2>::Start(-0.75, 0.1, 0.0, 0.0), 100, 4.0);
+    CHECK_EQ(multibrot.iter, mandelbrot.iter);
+}
+
+TEST_CASE("02 - SelectFormulaKernel - scalar types agree") {
+    constexpr int max_iter = 200;
+    const auto expected = RenderRow(
+        SelectFormulaKernel({.scalar = Scalar::Double}), 0.3, max_iter);
+
+    for (std::size_t i = 0; i < SCALAR_COUNT; ++i) {
+        const auto scalar = static_cast<Scalar>(i);
+        const auto actual =
+            RenderRow(SelectFormulaKernel({.scalar = scalar}), 0.3, max_iter);
+
+        // NOTE: Float loses precision along the orbit, so it only roughly
+        // follows the other types
+        const float tolerance = scalar == Scalar::Float ? 1e-1F : 1e-3F;
+        std::size_t matching = 0;
+        for (std::size_t x = 0; x < expected.size(); ++x) {
+            if (std::fabs(actual[x] - expected[x]) <= tolerance) {
+                ++matching;
+            }
+        }
+        MESSAGE(SCALAR_STR.at(i) << " matching " << matching);
+        CHECK_GE(matching, expected.size() * 9 / 10);
+    }
+}
+
+TEST_CASE("03 - SelectFormulaKernel - formulas have their known shapes") {
+    SUBCASE("Julia with c = 0 is the unit disc") {
+        constexpr int max_iter = 100;
+        const auto inside = FormulaEscapeTime<double, JuliaFormula>(
+            JuliaFormula::Start(0.6, 0.6, 0.0, 0.0), max_iter, 4.0);
+        const auto outside = FormulaEscapeTime<double, JuliaFormula>(
+            JuliaFormula::Start(0.8, 0.8, 0.0, 0.0), max_iter, 4.0);
+        CHECK_EQ(inside.iter, max_iter);
+        CHECK_LT(outside.iter, max_iter);
+    }
+    SUBCASE("Odd Multibrot powers are symmetric under c -> -c") {
+        const auto kernel = SelectFormulaKernel(
+            {.formula = Formula::Multibrot, .scalar = Scalar::Fixed,
+             .power = 3});
+        const FormulaRowParams params{.center_x = DoubleDouble(0.0),
+                                      .offset_x = -1.5,
+                                      .step_x = 0.03125,
+                                      .first_x = 0,
+                                      .c_y = DoubleDouble(0.0),
+                                      .julia_x = 0.0,
+                                      .julia_y = 0.0,
+                                      .max_iter = 100,
+                                      .escape = 4.0};
+        std::vector<float> row(97);
+        kernel(params, row);
+        for (std::size_t x = 0; x < row.size(); ++x) {
+            CHECK_EQ(row[x], row[row.size() - 1 - x]);
+        }
+    }
+    SUBCASE("Burning Ship is the Mandelbrot set on the real axis") {
+        const auto mandelbrot = RenderRow(SelectFormulaKernel({}), 0.0, 100);
+        const auto burning_ship = RenderRow(
+            SelectFormulaKernel({.formula = Formula::BurningShip}), 0.0, 100);
+        const auto off_axis = RenderRow(
+            SelectFormulaKernel({.formula = Formula::BurningShip}), 0.5, 100);
+        CHECK(burning_ship == mandelbrot);
+        CHECK(off_axis != RenderRow(SelectFormulaKernel({}), 0.5, 100));
+    }
+    SUBCASE("Powers outside the instantiated range are clamped") {
+        CHECK_EQ(SelectFormulaKernel({.formula = Formula::Multibrot,
+                                      .power = 100}),
+                 SelectFormulaKernel({.formula = Formula::Multibrot,
+                                      .power = FractalSettings::MAX_POWER}));
+    }
+}
+
+TEST_CASE("04 - Engine::Render - fractal settings select the formula") {
+    Viewport view;
+    view.width = 70;
+    view.height = 50;
+
+    Engine plain(EngineSettings{});
+    Engine templated(EngineSettings{
+        .fractal = {.formula = Formula::Mandelbrot,
+                    .scalar = Scalar::DoubleDouble}});
+    Engine julia(EngineSettings{.fractal = {.formula = Formula::Julia}});
+    IterationBuffer expected;
+    IterationBuffer actual;
+    IterationBuffer julia_buffer;
+    plain.Render(view, expected);
+    CHECK_EQ(templated.Render(view, actual).precision,
+             Precision::DoubleDouble);
+    julia.Render(view, julia_buffer);
+
+    std::size_t matching = 0;
+    for (std::size_t i = 0; i < expected.GetSize(); ++i) {
+        if (std::fabs(actual.Values()[i] - expected.Values()[i]) <= 1e-3F) {
+            ++matching;
+        }
+    }
+    CHECK_GE(matching, expected.GetSize() * 99 / 100);
+    CHECK(julia_buffer.Values().size() == expected.Values().size());
+    CHECK_NE(julia_buffer.At(35, 25), expected.At(35, 25));
+}
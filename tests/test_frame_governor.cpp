@@ -0,0 +1,84 @@
+#include <chrono>
+
+#include "doctest.h"
+
+#include "frame_governor.hpp"
+
+namespace {
+// Render time proportional to the samples and iterations of the frame, full
+// quality costs full_cost
+std::chrono::nanoseconds FrameCost(const FrameQuality &quality, int max_iter,
+                                   std::chrono::nanoseconds full_cost) {
+    const double block = quality.block_size;
+    const double share = (quality.scale * quality.scale) / (block * block) *
+                         quality.max_iter / max_iter;
+    return std::chrono::nanoseconds(
+        static_cast<std::chrono::nanoseconds::rep>(
+            static_cast<double>(full_cost.count()) * share));
+}
+}  // namespace
+
+TEST_CASE("01 - FrameGovernor::Update - expensive views fit the budget") {
+    const GovernorSettings settings{.fps = 50, .max_iter = 1000};
+    FrameGovernor governor(settings);
+    CHECK_EQ(governor.GetBudget(), std::chrono::milliseconds(16));
+
+    // Full quality takes 10 frames worth of time
+    const auto full_cost = std::chrono::milliseconds(200);
+    for (int frame = 0; frame < 10; ++frame) {
+        governor.Update(
+            FrameCost(governor.GetQuality(), settings.max_iter, full_cost),
+            true);
+    }
+
+    const auto &quality = governor.GetQuality();
+    MESSAGE("Scale " << quality.scale << ", max_iter " << quality.max_iter
+                     << ", block " << quality.block_size);
+    CHECK_FALSE(governor.IsFullQuality());
+    CHECK_LE(FrameCost(quality, settings.max_iter, full_cost),
+             governor.GetBudget());
+    // Resolution is lowered before the iterations
+    CHECK_GE(quality.scale, settings.min_scale);
+    CHECK_LT(quality.scale, 1.0);
+    CHECK_EQ(quality.max_iter, settings.max_iter);
+}
+
+TEST_CASE("02 - FrameGovernor::Update - idle frames refine to full quality") {
+    const GovernorSettings settings{.fps = 60, .max_iter = 4000};
+    FrameGovernor governor(settings);
+    const auto full_cost = std::chrono::seconds(1);
+
+    // Degraded while the view moves
+    governor.Update(
+        FrameCost(governor.GetQuality(), settings.max_iter, full_cost), true);
+    REQUIRE_FALSE(governor.IsFullQuality());
+
+    // Every idle frame takes one step, never lowering the quality
+    int frames = 0;
+    auto previous = governor.GetQuality();
+    while (!governor.IsFullQuality() && frames < 20) {
+        const auto &quality = governor.Update(
+            FrameCost(governor.GetQuality(), settings.max_iter, full_cost),
+            false);
+        CHECK_GE(quality.scale, previous.scale);
+        CHECK_GE(quality.max_iter, previous.max_iter);
+        CHECK_LE(quality.block_size, previous.block_size);
+        previous = quality;
+        ++frames;
+    }
+    CHECK(governor.IsFullQuality());
+    CHECK_LT(frames, 20);
+}
+
+TEST_CASE("03 - FrameGovernor::Update - cheap views render at full quality") {
+    const GovernorSettings settings{.fps = 30, .max_iter = 500};
+    FrameGovernor governor(settings);
+    CHECK_FALSE(governor.IsFullQuality());
+
+    // Full quality takes a tenth of the budget
+    const auto full_cost = std::chrono::milliseconds(3);
+    governor.Update(
+        FrameCost(governor.GetQuality(), settings.max_iter, full_cost), true);
+    CHECK(governor.IsFullQuality());
+    CHECK_EQ(governor.GetQuality().max_iter, settings.max_iter);
+}
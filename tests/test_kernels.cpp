@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "doctest.h"
+
+#include "engine.hpp"
+#include "escape_time.hpp"
+#include "kernels.hpp"
+#include "viewport.hpp"
+
+TEST_CASE("01 - DetectIsa - widest instruction set is supported") {
+    CHECK(IsIsaSupported(Isa::Scalar));
+    CHECK(IsIsaSupported(DetectIsa()));
+    CHECK(IsIsaSupported(SupportedIsa(Isa::Avx512)));
+    MESSAGE(ISA_STR.at(static_cast<std::size_t>(DetectIsa())));
+}
+
+TEST_CASE("02 - SelectRowKernel - vector kernels are bit-exact with scalar") {
+    Viewport view;
+    // NOTE: Odd width, so the last vector is only partially used
+    view.width = 203;
+    view.height = 61;
+
+    for (std::size_t i = 0; i < ISA_COUNT; ++i) {
+        const auto isa = static_cast<Isa>(i);
+        if (!IsIsaSupported(isa)) {
+            MESSAGE("Skipping unsupported " << ISA_STR.at(i));
+            continue;
+        }
+        const auto kernel = SelectRowKernel(isa);
+
+        for (const bool check_interior : {false, true}) {
+            for (int y = 0; y < view.height; ++y) {
+                const RowParams params{.origin_x = view.OriginX(),
+                                       .step_x = view.PixelWidth(),
+                                       .first_x = 0,
+                                       .c_y = view.PixelY(y),
+                                       .max_iter = 200,
+                                       .escape = 4.0,
+                                       .check_interior = check_interior,
+                                       .period_tolerance = 1e-5};
+                std::vector<float> expected(
+                    static_cast<std::size_t>(view.width));
+                std::vector<float> actual(static_cast<std::size_t>(view.width));
+
+                const auto expected_count = EscapeRowScalar(params, expected);
+                const auto actual_count = kernel(params, actual);
+
+                REQUIRE_EQ(actual_count.iterations, expected_count.iterations);
+                REQUIRE_EQ(actual_count.skipped, expected_count.skipped);
+                REQUIRE(actual == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("03 - Engine::Render - instruction set can be forced") {
+    Viewport view;
+    view.width = 70;
+    view.height = 50;
+
+    Engine scalar(EngineSettings{.isa = Isa::Scalar});
+    Engine widest(EngineSettings{});
+
+    CHECK_EQ(scalar.GetIsa(), Isa::Scalar);
+    CHECK_EQ(widest.GetIsa(), DetectIsa());
+
+    IterationBuffer scalar_buffer;
+    IterationBuffer widest_buffer;
+    scalar.Render(view, scalar_buffer);
+    widest.Render(view, widest_buffer);
+
+    CHECK(std::ranges::equal(scalar_buffer.Values(), widest_buffer.Values()));
+}
+
+TEST_CASE("04 - EscapeTimeInterior - interior points stop early") {
+    constexpr int max_iter = 1000;
+    constexpr double tolerance = 1e-10;
+
+    SUBCASE("Cardioid and bulb need no iterations") {
+        CHECK(InCardioidOrBulb(0.0, 0.0));
+        CHECK(InCardioidOrBulb(-1.0, 0.1));
+        CHECK_FALSE(InCardioidOrBulb(0.3, 0.0));
+        CHECK_FALSE(InCardioidOrBulb(-0.1, 0.9));
+
+        const auto result = EscapeTimeInterior(0.1, 0.1, max_iter, 4.0, 0.0);
+        CHECK_EQ(result.iter, max_iter);
+        CHECK_EQ(result.skipped, max_iter);
+    }
+    SUBCASE("Periodic orbits outside of the cardioid and bulb") {
+        // Inside the period-3 bulb around -0.1226 + 0.7449i
+        const auto result =
+            EscapeTimeInterior(-0.12, 0.75, max_iter, 4.0, tolerance);
+        CHECK_EQ(result.iter, max_iter);
+        CHECK_GT(result.skipped, max_iter / 2);
+        CHECK_EQ(EscapeTime(-0.12, 0.75, max_iter, 4.0).iter, max_iter);
+    }
+    SUBCASE("Exterior points are not changed") {
+        for (double c_x = -2.0; c_x <= 0.5; c_x += 0.01) {
+            const auto expected = EscapeTime(c_x, 0.65, max_iter, 4.0);
+            const auto actual =
+                EscapeTimeInterior(c_x, 0.65, max_iter, 4.0, tolerance);
+            REQUIRE_EQ(actual.iter, expected.iter);
+            if (expected.iter < max_iter) {
+                CHECK_EQ(actual.skipped, 0);
+                CHECK_EQ(actual.z_x, expected.z_x);
+            }
+        }
+    }
+}
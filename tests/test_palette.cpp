@@ -0,0 +1,110 @@
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "doctest.h"
+
+#include "engine.hpp"
+#include "iteration_buffer.hpp"
+#include "kernels.hpp"
+#include "palette.hpp"
+#include "rgb.hpp"
+#include "viewport.hpp"
+
+TEST_CASE("01 - Palette::Hsv - runtime palette matches the compile time one") {
+    constexpr std::size_t size = 1024;
+    static constexpr auto expected = RGB::GenPaletteHSV<size>();
+    const auto palette = Palette::Hsv(size);
+
+    REQUIRE_EQ(palette.GetSize(), size);
+    for (std::size_t i = 0; i < size; ++i) {
+        REQUIRE_EQ(palette.GetColors()[i], PackColor(expected.at(i)));
+    }
+}
+
+TEST_CASE("02 - Palette::Gradient - stops blend and wrap around") {
+    const auto black = Palette::ParseColor("#000000");
+    const auto white = Palette::ParseColor("#ffffff");
+    REQUIRE(black.has_value());
+    REQUIRE(white.has_value());
+    CHECK_FALSE(Palette::ParseColor("ffffff").has_value());
+    CHECK_FALSE(Palette::ParseColor("#fffffg").has_value());
+
+    const std::array stops{*black, *white};
+    const auto palette = Palette::Gradient(stops, 8);
+
+    // Stops sit at 0 and 4, the second half blends back to black
+    CHECK_EQ(palette.GetColors()[0], PackColor(*black));
+    CHECK_EQ(palette.GetColors()[4], PackColor(*white));
+    CHECK_EQ(palette.GetColors()[2], PackColor(RGB{0.5F, 0.5F, 0.5F}));
+    CHECK_EQ(palette.GetColors()[6], palette.GetColors()[2]);
+}
+
+TEST_CASE("03 - SelectColorizeKernel - vector kernel is bit-exact with "
+          "scalar") {
+    const auto palette = Palette::Hsv(1000);
+    // NOTE: Odd size, so the last vector is only partially used, values
+    // include interior pixels and values past a palette repetition
+    std::vector<float> values(1001);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<float>(i) * 0.37F;
+    }
+
+    for (std::size_t i = 0; i < ISA_COUNT; ++i) {
+        const auto isa = static_cast<Isa>(i);
+        if (!IsIsaSupported(isa)) {
+            MESSAGE("Skipping unsupported " << ISA_STR.at(i));
+            continue;
+        }
+        const auto kernel = SelectColorizeKernel(isa);
+
+        for (const float offset : {0.0F, 0.25F, 0.999F}) {
+            const ColorizeParams params{.palette = palette.GetColors(),
+                                        .max_iter = 300.0F,
+                                        .density = 3.0F,
+                                        .offset = offset,
+                                        .interior = PackColor(RGB{})};
+            std::vector<PackedColor> expected(values.size());
+            std::vector<PackedColor> actual(values.size());
+
+            ColorizeScalar(params, values, expected);
+            kernel(params, values, actual);
+
+            REQUIRE(actual == expected);
+            CHECK_EQ(actual.back(), params.interior);
+        }
+    }
+}
+
+TEST_CASE("04 - Engine::Colorize - palette cycling keeps the iterations") {
+    Viewport view;
+    view.width = 64;
+    view.height = 48;
+
+    Engine engine(EngineSettings{.max_iter = 200});
+    IterationBuffer buffer;
+    engine.Render(view, buffer);
+    const auto rendered = std::vector<float>(buffer.Values().begin(),
+                                             buffer.Values().end());
+
+    // Half a turn of the palette maps every exterior pixel to the color
+    // half the palette away
+    const auto palette = Palette::Hsv(256);
+    std::vector<PackedColor> colors(buffer.GetSize());
+    std::vector<PackedColor> cycled(buffer.GetSize());
+    engine.Colorize(buffer, palette, 1.0F, 0.0F, colors);
+    engine.Colorize(buffer, palette, 1.0F, 0.5F, cycled);
+
+    std::size_t changed = 0;
+    for (std::size_t i = 0; i < buffer.GetSize(); ++i) {
+        if (buffer.Values()[i] >= 200.0F) {
+            CHECK_EQ(colors[i], PackColor(RGB{}));
+            CHECK_EQ(cycled[i], colors[i]);
+        } else if (cycled[i] != colors[i]) {
+            ++changed;
+        }
+    }
+    CHECK_GT(changed, 0);
+    CHECK(std::vector<float>(buffer.Values().begin(), buffer.Values().end()) ==
+          rendered);
+}
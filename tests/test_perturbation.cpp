@@ -0,0 +1,238 @@
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+#include "doctest.h"
+
+#include "big_fixed.hpp"
+#include "engine.hpp"
+#include "escape_time.hpp"
+#include "iteration_buffer.hpp"
+#include "perturbation.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Escape time iterated fully in high precision, used as the ground truth
+EscapeResult BigFixedEscapeTime(const BigFixed &c_x, const BigFixed &c_y,
+                                int max_iter, double escape) {
+    BigFixed z_x(c_x.GetFractionLimbs());
+    BigFixed z_y(c_x.GetFractionLimbs());
+    for (int iter = 0; iter < max_iter; ++iter) {
+        const double x = z_x.ToDouble();
+        const double y = z_y.ToDouble();
+        if ((x * x) + (y * y) > escape) {
+            const double next_x = (x * x) - (y * y) + c_x.ToDouble();
+            const double next_y = (2.0 * x * y) + c_y.ToDouble();
+            return {iter + 1, next_x, next_y};
+        }
+        const auto z2_x = z_x * z_x;
+        const auto z2_y = z_y * z_y;
+        const auto z_xy = z_x * z_y;
+        z_y = z_xy + z_xy + c_y;
+        z_x = z2_x - z2_y + c_x;
+    }
+    return {max_iter, z_x.ToDouble(), z_y.ToDouble()};
+}
+}  // namespace
+
+TEST_CASE("01 - ReferenceOrbit::Compute - orbit of known points") {
+    SUBCASE("Interior point runs to max_iter") {
+        const auto orbit = ReferenceOrbit::Compute(
+            BigFixed::FromDouble(-1.0, 4), BigFixed::FromDouble(0.0, 4), 100,
+            4.0);
+        CHECK_EQ(orbit.GetSize(), 101);
+        // 0, -1, 0, -1, ...
+        CHECK_EQ(orbit.points[1].x, -1.0);
+        CHECK_EQ(orbit.points[2].x, 0.0);
+    }
+    SUBCASE("Exterior point stops after escaping") {
+        const auto orbit = ReferenceOrbit::Compute(
+            BigFixed::FromDouble(1.0, 4), BigFixed::FromDouble(0.0, 4), 100,
+            4.0);
+        // 0, 1, 2, 5
+        CHECK_EQ(orbit.GetSize(), 4);
+        CHECK_EQ(orbit.points.back().x, 5.0);
+    }
+}
+
+TEST_CASE("02 - Engine::RenderDeep - matches double rendering when shallow") {
+    Viewport view;
+    view.width = 140;
+    view.height = 100;
+    view.center_x = -0.745;
+    view.center_y = 0.11;
+    view.span_x = 0.035;
+    view.span_y = 0.025;
+
+    Engine engine(EngineSettings{.max_iter = 300,
+                                 .precision = Precision::Perturbation});
+    IterationBuffer expected;
+    IterationBuffer actual;
+    engine.Render(view, expected);
+    engine.RenderDeep(DeepViewport::FromViewport(view), actual);
+
+    // Rounding differs, so a few pixels near the boundary may differ
+    std::size_t matching = 0;
+    for (std::size_t i = 0; i < expected.GetSize(); ++i) {
+        if (std::fabs(expected.Values()[i] - actual.Values()[i]) < 1e-3F) {
+            ++matching;
+        }
+    }
+    CHECK_GE(matching, expected.GetSize() * 99 / 100);
+}
+
+TEST_CASE("03 - Engine::RenderDeep - deep zoom matches high precision") {
+    // c = i is a boundary point with detail at every zoom level
+    DeepViewport view;
+    view.center_x = *BigFixed::FromString("0.0", 8);
+    view.center_y = *BigFixed::FromString("1.0", 8);
+    view.span_x = 3.5e-55;
+    view.span_y = 2.5e-55;
+    view.width = 35;
+    view.height = 25;
+
+    constexpr int max_iter = 1000;
+    Engine engine(EngineSettings{.max_iter = max_iter});
+    IterationBuffer buffer;
+    engine.RenderDeep(view, buffer);
+
+    // Pixels must differ from each other, a double render would be one block
+    CHECK_NE(buffer.At(0, 0), buffer.At(34, 24));
+
+    const auto limbs = view.RequiredLimbs();
+    const auto center_x = view.center_x.WithLimbs(limbs);
+    const auto center_y = view.center_y.WithLimbs(limbs);
+    for (int y = 0; y < view.height; y += 6) {
+        for (int x = 0; x < view.width; x += 8) {
+            const auto c_x =
+                center_x + BigFixed::FromDouble(view.OffsetX(x), limbs);
+            const auto c_y =
+                center_y + BigFixed::FromDouble(view.OffsetY(y), limbs);
+            const auto result = BigFixedEscapeTime(c_x, c_y, max_iter, 4.0);
+            const float expected =
+                SmoothIteration(result.iter, result.z_x, result.z_y, max_iter);
+            CHECK_EQ(buffer.At(x, y), doctest::Approx(expected).epsilon(1e-3));
+        }
+    }
+}
+
+TEST_CASE("04 - Engine::RenderDeep - glitched pixels get new references") {
+    // The reference escapes after a few dozen iterations while the left part
+    // of the view lies inside the set, so those pixels outlive the reference
+    Viewport view;
+    view.width = 70;
+    view.height = 50;
+    view.center_x = 0.26;
+    view.center_y = 0.0;
+    view.span_x = 0.035;
+    view.span_y = 0.025;
+
+    IterationBuffer expected;
+    Engine(EngineSettings{.max_iter = 500}).Render(view, expected);
+
+    SUBCASE("Glitches are corrected") {
+        Engine engine(EngineSettings{.max_iter = 500,
+                                     .precision = Precision::Perturbation});
+        IterationBuffer actual;
+        const auto stats =
+            engine.RenderDeep(DeepViewport::FromViewport(view), actual);
+
+        CHECK_GT(stats.glitched_pixels, 0);
+        CHECK_GT(stats.extra_references, 0);
+        CHECK_LE(stats.extra_references, 64);
+        MESSAGE("Glitched pixels: " << stats.glitched_pixels
+                                    << ", extra references: "
+                                    << stats.extra_references);
+
+        std::size_t matching = 0;
+        for (std::size_t i = 0; i < expected.GetSize(); ++i) {
+            if (std::fabs(expected.Values()[i] - actual.Values()[i]) < 1e-3F) {
+                ++matching;
+            }
+        }
+        CHECK_GE(matching, expected.GetSize() * 99 / 100);
+    }
+    SUBCASE("Without extra references every pixel is still rendered") {
+        Engine engine(EngineSettings{.max_iter = 500,
+                                     .precision = Precision::Perturbation,
+                                     .max_references = 0});
+        IterationBuffer actual;
+        const auto stats =
+            engine.RenderDeep(DeepViewport::FromViewport(view), actual);
+
+        CHECK_GT(stats.glitched_pixels, 0);
+        CHECK_EQ(stats.extra_references, 0);
+
+        // NOTE: Pixels outliving the reference are rebased onto its start
+        std::size_t matching = 0;
+        for (std::size_t i = 0; i < expected.GetSize(); ++i) {
+            CHECK_FALSE(std::isnan(actual.Values()[i]));
+            if (std::fabs(expected.Values()[i] - actual.Values()[i]) < 1e-3F) {
+                ++matching;
+            }
+        }
+        CHECK_GE(matching, expected.GetSize() * 99 / 100);
+    }
+}
+
+TEST_CASE("05 - Engine::RenderDeep - BLA skips iterations without changes") {
+    DeepViewport view;
+    view.center_x = *BigFixed::FromString("0.0", 8);
+    view.center_y = *BigFixed::FromString("1.0", 8);
+    view.span_x = 3.5e-55;
+    view.span_y = 2.5e-55;
+    view.width = 70;
+    view.height = 50;
+
+    Engine exact(EngineSettings{.max_iter = 1000, .bla = false});
+    Engine approximate(EngineSettings{.max_iter = 1000, .bla = true});
+    IterationBuffer expected;
+    IterationBuffer actual;
+    const auto exact_stats = exact.RenderDeep(view, expected);
+    const auto approximate_stats = approximate.RenderDeep(view, actual);
+
+    CHECK_EQ(exact_stats.skipped_iterations, 0);
+    CHECK_GT(approximate_stats.skipped_iterations,
+             approximate_stats.iterations / 2);
+    MESSAGE("Skipped " << approximate_stats.skipped_iterations << " of "
+                       << approximate_stats.iterations << " iterations");
+
+    std::size_t matching = 0;
+    for (std::size_t i = 0; i < expected.GetSize(); ++i) {
+        if (std::fabs(expected.Values()[i] - actual.Values()[i]) < 1e-3F) {
+            ++matching;
+        }
+    }
+    CHECK_GE(matching, expected.GetSize() * 99 / 100);
+}
+
+TEST_CASE("06 - PerturbEscapeTime - pixels outliving the reference are "
+          "rebased") {
+    // The reference escapes after a few dozen iterations
+    const auto ref_x = BigFixed::FromDouble(0.26, 4);
+    const auto ref_y = BigFixed::FromDouble(0.0, 4);
+    const auto orbit = ReferenceOrbit::Compute(ref_x, ref_y, 1000, 4.0);
+    REQUIRE_LT(orbit.GetSize(), 100);
+
+    // Inside the set, escaping long after the reference, and off the axis
+    for (const auto &[dc_x, dc_y] :
+         {std::pair{-0.06, 0.0}, std::pair{-0.0085, 0.0},
+          std::pair{-0.011, 0.004}}) {
+        const auto expected = BigFixedEscapeTime(
+            ref_x + BigFixed::FromDouble(dc_x, 4),
+            ref_y + BigFixed::FromDouble(dc_y, 4), 1000, 4.0);
+        const auto actual = PerturbEscapeTime(orbit, nullptr, dc_x, dc_y,
+                                              1000, 4.0, 0.0);
+        REQUIRE(actual.has_value());
+        CHECK_EQ(actual->iter, expected.iter);
+        if (expected.iter < 1000) {
+            CHECK_EQ(actual->z_x, doctest::Approx(expected.z_x));
+            CHECK_EQ(actual->z_y, doctest::Approx(expected.z_y));
+        }
+    }
+
+    // With the detection on, the same pixels are reported as glitched
+    CHECK_FALSE(
+        PerturbEscapeTime(orbit, nullptr, -0.06, 0.0, 1000, 4.0, 1e-3)
+            .has_value());
+}
@@ -0,0 +1,275 @@
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "doctest.h"
+
+#include "engine.hpp"
+#include "iteration_buffer.hpp"
+#include "mandelbrot_error.hpp"
+#include "palette.hpp"
+#include "poster_job.hpp"
+#include "poster_renderer.hpp"
+
+namespace {
+// Job file of the test configs
+std::filesystem::path JobPath(std::string_view name) {
+    return std::filesystem::path(PROJECT_ROOT_PATH) / "tests/configs" / name;
+}
+
+// Copy of the valid poster job in a temporary directory, the image is
+// written next to it
+struct TempPoster {
+    std::filesystem::path directory;
+    std::filesystem::path job_file;
+
+    explicit TempPoster(const char *name)
+        : directory(std::filesystem::temp_directory_path() / name),
+          job_file(directory / "poster.toml") {
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        std::filesystem::copy_file(JobPath("poster_valid.toml"), job_file);
+    }
+    TempPoster(const TempPoster &) = delete;
+    TempPoster &operator=(const TempPoster &) = delete;
+    TempPoster(TempPoster &&) = delete;
+    TempPoster &operator=(TempPoster &&) = delete;
+    ~TempPoster() { std::filesystem::remove_all(directory); }
+};
+
+// Bytes of a file
+std::string ReadFile(const std::filesystem::path &path) {
+    std::ifstream stream(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(stream),
+            std::istreambuf_iterator<char>()};
+}
+}  // namespace
+
+TEST_CASE("01 - PosterJob::Load - valid job loads correctly") {
+    auto result = PosterJob::Load(JobPath("poster_valid.toml"));
+
+    REQUIRE(result.has_value());
+
+    const auto &job = result.value();
+    CHECK_EQ(job.GetFile(), JobPath("poster.ppm"));
+    CHECK_EQ(job.GetWidth(), 64);
+    CHECK_EQ(job.GetHeight(), 50);
+    CHECK_EQ(job.GetStripHeight(), 16);
+    CHECK_EQ(job.GetMaxIter(), 800);
+    CHECK_EQ(job.GetAntialias(), 2);
+    CHECK_EQ(job.GetPaletteSettings().size, 256U);
+
+    // The last strip holds the remaining rows
+    CHECK_EQ(job.GetStripCount(), 4);
+    CHECK_EQ(job.StripRow(3), 48);
+    CHECK_EQ(job.StripRows(0), 16);
+    CHECK_EQ(job.StripRows(3), 2);
+    CHECK_EQ(job.GetView().Zoom(), doctest::Approx(2000.0));
+    // Digits past double precision are kept
+    CHECK_EQ(job.GetView().center_x.ToString(30),
+             "-0.743643887037158704752191506114");
+}
+
+TEST_CASE("02 - PosterJob::Load - invalid jobs") {
+    SUBCASE("Missing job file") {
+        auto result = PosterJob::Load(JobPath("does_not_exist.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(),
+                 MandelbrotError::Code::FileNotFound);
+        MESSAGE(result.error().GetMessage());
+    }
+    SUBCASE("Missing poster table") {
+        auto result = PosterJob::Load(JobPath("batch_valid.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(), MandelbrotError::Code::ParseError);
+        MESSAGE(result.error().GetMessage());
+    }
+    SUBCASE("Strips too large") {
+        auto result = PosterJob::Load(JobPath("poster_invalid1.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(),
+                 MandelbrotError::Code::InvalidValue);
+        MESSAGE(result.error().GetMessage());
+    }
+    SUBCASE("Center not a number") {
+        auto result = PosterJob::Load(JobPath("poster_invalid2.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(),
+                 MandelbrotError::Code::InvalidValue);
+        MESSAGE(result.error().GetMessage());
+    }
+    SUBCASE("Missing image file") {
+        auto result = PosterJob::Load(JobPath("poster_invalid3.toml"));
+        REQUIRE_FALSE(result.has_value());
+        CHECK_EQ(result.error().GetCode(),
+                 MandelbrotError::Code::MissingOption);
+        MESSAGE(result.error().GetMessage());
+    }
+}
+
+TEST_CASE("03 - PosterJob::StripView - strips match the whole poster") {
+    auto result = PosterJob::Load(JobPath("poster_valid.toml"));
+    REQUIRE(result.has_value());
+    const auto &job = result.value();
+
+    Engine engine(EngineSettings{.max_iter = job.GetMaxIter()});
+    IterationBuffer whole;
+    engine.RenderDeep(job.GetView(), whole);
+
+    // NOTE: Strips have their own reference orbit, only pixels on fine
+    // detail may differ
+    std::size_t close = 0;
+    IterationBuffer strip;
+    for (int index = 0; index < job.GetStripCount(); ++index) {
+        engine.RenderDeep(job.StripView(index), strip);
+        REQUIRE_EQ(strip.GetWidth(), job.GetWidth());
+        REQUIRE_EQ(strip.GetHeight(), job.StripRows(index));
+        for (int y = 0; y < strip.GetHeight(); ++y) {
+            for (int x = 0; x < strip.GetWidth(); ++x) {
+                if (std::fabs(strip.At(x, y) -
+                              whole.At(x, job.StripRow(index) + y)) < 0.01F) {
+                    ++close;
+                }
+            }
+        }
+    }
+    CHECK_GT(static_cast<double>(close),
+             0.99 * static_cast<double>(whole.GetSize()));
+}
+
+TEST_CASE("04 - PosterRenderer::Run - strips are appended to the image") {
+    const TempPoster temp("mandelbrot_test_poster1");
+    auto result = PosterJob::Load(temp.job_file);
+    REQUIRE(result.has_value());
+    const auto job = result.value();
+
+    PosterRenderer renderer(job, PosterSettings{.thread_count = 2,
+                                                .queue_capacity = 1});
+    const auto stats = renderer.Run();
+    REQUIRE(stats.has_value());
+    CHECK_EQ(stats->strips, job.GetStripCount());
+    CHECK_EQ(stats->resumed_strips, 0);
+    CHECK(stats->complete);
+    CHECK_FALSE(std::filesystem::exists(
+        PosterRenderer::ProgressPath(job.GetFile())));
+
+    // Header and RGB rows of the whole poster
+    const auto image = ReadFile(job.GetFile());
+    const auto header = PosterRenderer::PpmHeader(64, 50);
+    CHECK_EQ(header, "P6\n64 50\n255\n");
+    REQUIRE_EQ(image.size(), header.size() + (64U * 50U * 3U));
+    CHECK_EQ(image.substr(0, header.size()), header);
+}
+
+TEST_CASE("05 - PosterRenderer::Run - stopped runs continue") {
+    const TempPoster temp("mandelbrot_test_poster2");
+    auto result = PosterJob::Load(temp.job_file);
+    REQUIRE(result.has_value());
+    const auto job = result.value();
+
+    // Image of a single run
+    {
+        PosterRenderer renderer(job, PosterSettings{.thread_count = 2});
+        REQUIRE(renderer.Run().has_value());
+    }
+    const auto expected = ReadFile(job.GetFile());
+
+    // Two strips, then a stray partial strip written before a crash
+    {
+        PosterRenderer renderer(
+            job, PosterSettings{.thread_count = 2, .max_strips = 2});
+        const auto stats = renderer.Run();
+        REQUIRE(stats.has_value());
+        CHECK_EQ(stats->strips, 2);
+        CHECK_FALSE(stats->complete);
+        CHECK(std::filesystem::exists(
+            PosterRenderer::ProgressPath(job.GetFile())));
+    }
+    {
+        std::ofstream image(job.GetFile(), std::ios::binary | std::ios::app);
+        image << "partial strip";
+    }
+
+    // The next run keeps the two strips and drops the partial one
+    PosterRenderer renderer(job, PosterSettings{.thread_count = 2});
+    const auto stats = renderer.Run();
+    REQUIRE(stats.has_value());
+    CHECK_EQ(stats->resumed_strips, 2);
+    CHECK_EQ(stats->strips, job.GetStripCount() - 2);
+    CHECK(stats->complete);
+    CHECK(ReadFile(job.GetFile()) == expected);
+
+    // Progress of another job is ignored
+    {
+        PosterRenderer first(
+            job, PosterSettings{.thread_count = 2, .max_strips = 1});
+        REQUIRE(first.Run().has_value());
+    }
+    {
+        std::ofstream job_file(temp.job_file, std::ios::app);
+        job_file << "# changed\n";
+    }
+    auto changed = PosterJob::Load(temp.job_file);
+    REQUIRE(changed.has_value());
+    PosterRenderer restarted(changed.value(),
+                             PosterSettings{.thread_count = 2});
+    const auto restarted_stats = restarted.Run();
+    REQUIRE(restarted_stats.has_value());
+    CHECK_EQ(restarted_stats->resumed_strips, 0);
+    CHECK(ReadFile(job.GetFile()) == expected);
+}
+
+TEST_CASE("06 - PosterRenderer::Run - anti-aliased seams match one image") {
+    const TempPoster temp("mandelbrot_test_poster3");
+    auto result = PosterJob::Load(temp.job_file);
+    REQUIRE(result.has_value());
+    const auto job = result.value();
+    REQUIRE_GT(job.GetAntialias(), 1);
+
+    PosterRenderer renderer(job, PosterSettings{.thread_count = 2});
+    REQUIRE(renderer.Run().has_value());
+    const auto image = ReadFile(job.GetFile());
+    const auto header_size =
+        PosterRenderer::PpmHeader(job.GetWidth(), job.GetHeight()).size();
+
+    // The whole poster anti-aliased as a single image
+    const auto &palette_settings = job.GetPaletteSettings();
+    Engine engine(EngineSettings{.max_iter = job.GetMaxIter(),
+                                 .fractal = job.GetFractalSettings()});
+    IterationBuffer buffer;
+    std::vector<PackedColor> expected(
+        static_cast<std::size_t>(job.GetWidth() * job.GetHeight()));
+    engine.RenderAntialiased(job.GetView(), buffer,
+                             palette_settings.Generate(),
+                             palette_settings.density, palette_settings.offset,
+                             expected,
+                             AntialiasSettings{.grid = job.GetAntialias()});
+
+    // NOTE: Strips have their own reference orbit, only pixels on fine
+    // detail may differ. Rows next to a seam see the rows of the other strip
+    std::size_t matching = 0;
+    std::size_t seam_pixels = 0;
+    std::size_t seam_matching = 0;
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        const bool same =
+            std::memcmp(&image[header_size + (i * 3)], &expected[i], 3) == 0;
+        const int row = static_cast<int>(i) / job.GetWidth();
+        const int strip_row = row % job.GetStripHeight();
+        const bool seam =
+            (strip_row == 0 && row > 0) ||
+            (strip_row == job.GetStripHeight() - 1 &&
+             row < job.GetHeight() - 1);
+        matching += same ? 1U : 0U;
+        seam_pixels += seam ? 1U : 0U;
+        seam_matching += seam && same ? 1U : 0U;
+    }
+    CHECK_GE(matching, expected.size() * 99 / 100);
+    REQUIRE_GT(seam_pixels, 0U);
+    CHECK_GE(seam_matching, seam_pixels * 99 / 100);
+}
@@ -0,0 +1,312 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#include "engine.hpp"
+#include "iteration_buffer.hpp"
+#include "palette.hpp"
+#include "render_thread.hpp"
+#include "tile_cache.hpp"
+#include "tile_store.hpp"
+#include "triple_buffer.hpp"
+#include "viewport.hpp"
+
+namespace {
+// View with pixels 1/32 wide, so moved and zoomed views keep every
+// coordinate exact
+DeepViewport ExactView() {
+    DeepViewport view;
+    view.width = 128;
+    view.height = 96;
+    view.span_x = 4.0;
+    view.span_y = 3.0;
+    return view;
+}
+
+// First finished full quality frame of the generation, empty when none
+// arrives in time
+std::optional<RenderedFrame> WaitForFrame(RenderThread &render_thread,
+                                          std::uint64_t generation,
+                                          int max_iter) {
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (std::chrono::steady_clock::now() < deadline) {
+        const auto *frame = render_thread.AcquireFrame();
+        if (frame != nullptr && frame->generation == generation &&
+            frame->quality.scale == 1.0 && frame->quality.block_size == 1 &&
+            frame->quality.max_iter == max_iter &&
+            frame->pending_pixels == 0) {
+            return *frame;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return std::nullopt;
+}
+
+// Colors of a full render of the view
+std::vector<PackedColor> RenderColors(const RenderThreadSettings &settings,
+                                      const DeepViewport &view) {
+    Engine engine(settings.engine);
+    IterationBuffer buffer;
+    engine.RenderDeep(view, buffer);
+    std::vector<PackedColor> colors(buffer.GetSize());
+    engine.Colorize(buffer, settings.palette.Generate(),
+                    settings.palette.density, settings.palette.offset, colors);
+    return colors;
+}
+}  // namespace
+
+TEST_CASE("01 - TripleBuffer::Acquire - consumer gets the newest frame") {
+    TripleBuffer<int> buffer;
+    CHECK_FALSE(buffer.Acquire());
+
+    buffer.Back() = 1;
+    buffer.Publish();
+    buffer.Back() = 2;
+    buffer.Publish();
+    REQUIRE(buffer.Acquire());
+    CHECK_EQ(buffer.Front(), 2);
+    CHECK_FALSE(buffer.Acquire());
+
+    // Frames taken while the producer runs never go back in time
+    constexpr int frame_count = 100000;
+    TripleBuffer<int> shared;
+    std::jthread producer([&]() {
+        for (int frame = 1; frame <= frame_count; ++frame) {
+            shared.Back() = frame;
+            shared.Publish();
+        }
+    });
+    int last = 0;
+    bool ordered = true;
+    while (last < frame_count) {
+        if (shared.Acquire()) {
+            ordered = ordered && shared.Front() > last;
+            last = shared.Front();
+        }
+    }
+    CHECK(ordered);
+}
+
+TEST_CASE("02 - RenderThread::AcquireFrame - frames refine to full quality") {
+    const RenderThreadSettings settings{
+        .engine = EngineSettings{.max_iter = 200, .thread_count = 2},
+        .governor = GovernorSettings{.fps = 1000},
+        .palette = PaletteSettings{}};
+    DeepViewport view;
+    view.width = 140;
+    view.height = 100;
+
+    RenderThread render_thread(settings);
+    render_thread.SetView(view);
+
+    // Poll like the window thread does
+    std::vector<RenderedFrame> frames;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (const auto *frame = render_thread.AcquireFrame()) {
+            frames.push_back(*frame);
+            if (frame->quality.scale == 1.0 &&
+                frame->quality.block_size == 1 &&
+                frame->quality.max_iter == 200) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE_FALSE(frames.empty());
+    MESSAGE("Received " << frames.size() << " frames");
+    for (std::size_t i = 1; i < frames.size(); ++i) {
+        CHECK_GT(frames[i].sequence, frames[i - 1].sequence);
+    }
+
+    // The last frame is the full render of the view
+    const auto &frame = frames.back();
+    REQUIRE_EQ(frame.width, view.width);
+    REQUIRE_EQ(frame.height, view.height);
+    Engine engine(settings.engine);
+    IterationBuffer buffer;
+    engine.RenderDeep(view, buffer);
+    std::vector<PackedColor> expected(buffer.GetSize());
+    engine.Colorize(buffer, settings.palette.Generate(),
+                    settings.palette.density, settings.palette.offset,
+                    expected);
+    CHECK(frame.pixels == expected);
+}
+
+TEST_CASE("03 - RenderThread::SetView - new views cancel stale frames") {
+    const RenderThreadSettings settings{
+        .engine = EngineSettings{.max_iter = 500, .thread_count = 2},
+        .governor = GovernorSettings{.fps = 1000},
+        .palette = PaletteSettings{}};
+    DeepViewport view;
+    view.width = 140;
+    view.height = 100;
+
+    // Views replacing each other faster than frames render
+    RenderThread render_thread(settings);
+    std::uint64_t generation = 0;
+    for (int step = 0; step < 20; ++step) {
+        view = view.ZoomAt(70, 50, 1.1);
+        const auto next = render_thread.SetView(view);
+        CHECK_GT(next, generation);
+        generation = next;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    // Only the last view refines to full quality
+    const RenderedFrame *last = nullptr;
+    std::uint64_t last_generation = 0;
+    bool ordered = true;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (const auto *frame = render_thread.AcquireFrame()) {
+            ordered = ordered && frame->generation >= last_generation;
+            last_generation = frame->generation;
+            last = frame;
+            if (frame->generation == generation &&
+                frame->quality.scale == 1.0 &&
+                frame->quality.block_size == 1 &&
+                frame->quality.max_iter == 500) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(ordered);
+    REQUIRE(last != nullptr);
+    CHECK_EQ(last->generation, generation);
+    CHECK_EQ(last->quality.scale, 1.0);
+}
+
+TEST_CASE("04 - RenderThread::SetView - panned views reuse the last frame") {
+    // NOTE: A low frame rate gives new views full quality right away
+    const RenderThreadSettings settings{
+        .engine = EngineSettings{.max_iter = 200, .thread_count = 2},
+        .governor = GovernorSettings{.fps = 1},
+        .palette = PaletteSettings{}};
+    const auto view = ExactView();
+
+    RenderThread render_thread(settings);
+    const auto first = render_thread.SetView(view);
+    REQUIRE(WaitForFrame(render_thread, first, 200).has_value());
+
+    // Only the exposed strips are rendered
+    const auto moved = view.MovedBy(5, -3);
+    const auto frame =
+        WaitForFrame(render_thread, render_thread.SetView(moved), 200);
+    REQUIRE(frame.has_value());
+    CHECK_EQ(frame->reused_pixels, (128U - 5U) * (96U - 3U));
+    CHECK(frame->pixels == RenderColors(settings, moved));
+}
+
+TEST_CASE("05 - RenderThread::SetView - zoomed views reuse the last frame") {
+    const RenderThreadSettings settings{
+        .engine = EngineSettings{.max_iter = 200, .thread_count = 2},
+        .governor = GovernorSettings{.fps = 1},
+        .palette = PaletteSettings{}};
+    const auto view = ExactView();
+
+    RenderThread render_thread(settings);
+    const auto first = render_thread.SetView(view);
+    REQUIRE(WaitForFrame(render_thread, first, 200).has_value());
+
+    // Zooming by 2 keeps every other row and column, the other pixels start
+    // from a preview and are rendered afterwards
+    const auto zoomed = view.ZoomAt(64, 48, 2.0);
+    const auto frame =
+        WaitForFrame(render_thread, render_thread.SetView(zoomed), 200);
+    REQUIRE(frame.has_value());
+    CHECK_EQ(frame->reused_pixels, (128U * 96U) / 4U);
+    CHECK(frame->pixels == RenderColors(settings, zoomed));
+
+    // Zooming back out keeps the middle of the frame
+    const auto back = render_thread.SetView(zoomed.ZoomAt(64, 48, 0.5));
+    const auto zoomed_out = WaitForFrame(render_thread, back, 200);
+    REQUIRE(zoomed_out.has_value());
+    CHECK_EQ(zoomed_out->reused_pixels, (128U * 96U) / 4U);
+}
+
+TEST_CASE("06 - RenderThread::SetView - refined frames publish every pass") {
+    // NOTE: Without budget the governor starts every view at the lowest
+    // quality and refines it one step per frame
+    const RenderThreadSettings settings{
+        .engine = EngineSettings{.max_iter = 1000, .thread_count = 2},
+        .governor = GovernorSettings{.fps = 60, .budget_share = 1e-6},
+        .palette = PaletteSettings{}};
+    const auto view = ExactView();
+
+    RenderThread render_thread(settings);
+    const auto frame =
+        WaitForFrame(render_thread, render_thread.SetView(view), 1000);
+    REQUIRE(frame.has_value());
+    CHECK(frame->pixels == RenderColors(settings, view));
+
+    // The lowest quality twice, once more fitted to the measured cost, then
+    // 3 block sizes, 2 scales and 4 iteration limits. Refined block sizes
+    // publish the coarser passes before them, 1 + 2 + 3 + 3 frames, higher
+    // iteration limits continue the full resolution frame
+    CHECK_EQ(frame->sequence, 20U);
+}
+
+TEST_CASE("07 - RenderThread::SetView - aligned views use the tile cache") {
+    const RenderThreadSettings settings{
+        .engine = EngineSettings{.max_iter = 200, .thread_count = 2},
+        .governor = GovernorSettings{.fps = 1},
+        .palette = PaletteSettings{},
+        .tile_cache_bytes = 64 * TileCache::TILE_BYTES};
+    const auto view =
+        DeepViewport::FromViewport(SnapToPyramid(ExactView().ToViewport()));
+    REQUIRE(PlaceInPyramid(view.ToViewport()).has_value());
+
+    // A view without shared samples in between, then the first view again
+    // from the cached tiles
+    RenderThread render_thread(settings);
+    const auto other = view.MovedBy(1000, 0);
+    for (const auto &next : {view, other, view}) {
+        const auto frame =
+            WaitForFrame(render_thread, render_thread.SetView(next), 200);
+        REQUIRE(frame.has_value());
+        CHECK_EQ(frame->reused_pixels, 0);
+        CHECK(frame->pixels == RenderColors(settings, next));
+    }
+}
+
+TEST_CASE("08 - RenderThread::SetView - aligned views fill the tile store") {
+    const auto path =
+        std::filesystem::temp_directory_path() / "mandelbrot_test_thread.tiles";
+    std::filesystem::remove(path);
+    const RenderThreadSettings settings{
+        .engine = EngineSettings{.max_iter = 200, .thread_count = 2},
+        .governor = GovernorSettings{.fps = 1},
+        .palette = PaletteSettings{},
+        .tile_cache_bytes = 0,
+        .tile_store = path,
+        .tile_store_bytes = 64 * TileStore::TILE_BYTES};
+    const auto view =
+        DeepViewport::FromViewport(SnapToPyramid(ExactView().ToViewport()));
+
+    {
+        RenderThread render_thread(settings);
+        const auto frame =
+            WaitForFrame(render_thread, render_thread.SetView(view), 200);
+        REQUIRE(frame.has_value());
+        CHECK(frame->pixels == RenderColors(settings, view));
+    }
+
+    // 128 x 96 pixels at any offset touch 2 x 2 or more tiles
+    {
+        const auto store = TileStore::Open(path, 1);
+        REQUIRE(store.has_value());
+        CHECK_EQ(store->GetCapacity(), 64);
+        CHECK_GE(store->GetTileCount(), 4);
+    }
+    std::filesystem::remove(path);
+}
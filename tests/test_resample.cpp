@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "doctest.h"
+
+#include "engine.hpp"
+#include "iteration_buffer.hpp"
+#include "resample.hpp"
+#include "viewport.hpp"
+
+namespace {
+// View with pixels 1/32 wide, so zooming by 2 keeps every coordinate exact
+Viewport ExactViewport() {
+    Viewport view;
+    view.width = 128;
+    view.height = 96;
+    view.span_x = 4.0;
+    view.span_y = 3.0;
+    return view;
+}
+}  // namespace
+
+TEST_CASE("01 - ResampleFrame - zooming by 2 keeps a quarter of the pixels") {
+    const auto previous = ExactViewport();
+    const auto view = previous.ZoomAt(37, 58, 2.0);
+    CHECK_EQ(view.PixelX(37), previous.PixelX(37));
+    CHECK_EQ(view.PixelY(58), previous.PixelY(58));
+
+    Engine engine(EngineSettings{.max_iter = 200});
+    IterationBuffer previous_buffer;
+    IterationBuffer expected;
+    engine.Render(previous, previous_buffer);
+    engine.Render(view, expected);
+
+    IterationBuffer buffer;
+    PendingMask pending;
+    const auto copied =
+        ResampleFrame(previous, previous_buffer, view, buffer, pending);
+    CHECK_EQ(copied, buffer.GetSize() / 4);
+    CHECK_EQ(static_cast<std::size_t>(std::ranges::count(
+                 pending, static_cast<std::uint8_t>(0))),
+             copied);
+
+    // Copied pixels are final, the preview is close to the final frame
+    std::size_t close = 0;
+    for (std::size_t i = 0; i < buffer.GetSize(); ++i) {
+        if (pending[i] == 0) {
+            REQUIRE_EQ(buffer.Values()[i], expected.Values()[i]);
+        }
+        if (std::fabs(buffer.Values()[i] - expected.Values()[i]) <= 1.0F) {
+            ++close;
+        }
+    }
+    CHECK_GE(close, buffer.GetSize() * 3 / 4);
+
+    // Unrelated views keep nothing
+    auto moved = view;
+    moved.center_x += 0.3 * view.PixelWidth();
+    CHECK_EQ(ResampleFrame(previous, previous_buffer, moved, buffer, pending),
+             0);
+    CHECK(std::ranges::all_of(pending, [](auto flag) { return flag == 1; }));
+}
+
+TEST_CASE("02 - Engine::RenderPending - refines the preview to the frame") {
+    const auto previous = ExactViewport();
+    const auto view = previous.ZoomAt(64, 48, 2.0);
+
+    Engine engine(EngineSettings{.max_iter = 200, .tile_size = 32});
+    IterationBuffer previous_buffer;
+    IterationBuffer expected;
+    engine.Render(previous, previous_buffer);
+    engine.Render(view, expected);
+
+    IterationBuffer buffer;
+    PendingMask pending;
+    const auto copied =
+        ResampleFrame(previous, previous_buffer, view, buffer, pending);
+
+    // An empty budget still renders one pass of interleaved rows
+    const auto first = engine.RenderPending(view, buffer, pending,
+                                            std::chrono::nanoseconds{0});
+    CHECK_GT(first.pixels, 0);
+    CHECK_LT(first.pixels, buffer.GetSize() - copied);
+
+    const auto rest = engine.RenderPending(view, buffer, pending,
+                                           std::chrono::hours{1});
+    CHECK_EQ(first.pixels + rest.pixels, buffer.GetSize() - copied);
+    CHECK(std::ranges::all_of(pending, [](auto flag) { return flag == 0; }));
+    CHECK(std::ranges::equal(buffer.Values(), expected.Values()));
+}
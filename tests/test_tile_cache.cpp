@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "doctest.h"
+
+#include "engine.hpp"
+#include "iteration_buffer.hpp"
+#include "tile_cache.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Key of a tile of the default fractal at level 0
+TileKey Key(std::int64_t tile_x) {
+    return {.level = 0,
+            .tile_x = tile_x,
+            .tile_y = 0,
+            .max_iter = 50,
+            .escape = 4.0,
+            .fractal = {},
+            .interior_check = true};
+}
+}  // namespace
+
+TEST_CASE("01 - TileCache::Insert - least recently used tiles are evicted") {
+    TileCache cache(3 * TileCache::TILE_BYTES);
+    const auto tile = std::make_shared<const IterationBuffer>(
+        PYRAMID_TILE_SIZE, PYRAMID_TILE_SIZE);
+    cache.Insert(Key(0), tile);
+    cache.Insert(Key(1), tile);
+    cache.Insert(Key(2), tile);
+    CHECK_EQ(cache.GetTileCount(), 3);
+
+    // Tile 0 is used again, so tile 1 is the least recently used one
+    CHECK(cache.Find(Key(0)) != nullptr);
+    cache.Insert(Key(3), tile);
+    CHECK_EQ(cache.GetTileCount(), 3);
+    CHECK_LE(cache.GetMemoryUsage(), cache.GetMemoryBudget());
+    CHECK(cache.Find(Key(1)) == nullptr);
+    CHECK(cache.Find(Key(0)) != nullptr);
+    CHECK(cache.Find(Key(3)) != nullptr);
+
+    // Other settings are other tiles
+    auto other = Key(0);
+    other.max_iter = 100;
+    CHECK(cache.Find(other) == nullptr);
+    other = Key(0);
+    other.fractal.formula = Formula::Julia;
+    CHECK(cache.Find(other) == nullptr);
+    other = Key(0);
+    other.interior_check = false;
+    CHECK(cache.Find(other) == nullptr);
+
+    CHECK_EQ(cache.GetStats().hits, 3);
+    CHECK_EQ(cache.GetStats().misses, 4);
+    CHECK_EQ(cache.GetStats().evictions, 1);
+}
+
+TEST_CASE("02 - PlaceInPyramid - views snap onto the grid") {
+    Viewport view;
+    view.width = 200;
+    view.height = 150;
+    CHECK_FALSE(PlaceInPyramid(view).has_value());
+
+    const auto snapped = SnapToPyramid(view);
+    const auto placement = PlaceInPyramid(snapped);
+    REQUIRE(placement.has_value());
+    CHECK_EQ(placement->level, 6);
+    CHECK_EQ(snapped.width, view.width);
+    CHECK_LT(std::fabs(snapped.center_x - view.center_x),
+             snapped.PixelWidth());
+    CHECK_EQ(snapped.PixelX(0),
+             static_cast<double>(placement->first_x) / 64.0);
+
+    // Zooming by 2 around a pixel moves one level down
+    const auto zoomed = PlaceInPyramid(snapped.ZoomAt(37, 41, 2.0));
+    REQUIRE(zoomed.has_value());
+    CHECK_EQ(zoomed->level, 7);
+    CHECK_EQ(zoomed->first_x + 37, 2 * (placement->first_x + 37));
+    CHECK_EQ(zoomed->first_y + 41, 2 * (placement->first_y + 41));
+}
+
+TEST_CASE("03 - Engine::RenderCached - cached views match a full render") {
+    Viewport view;
+    view.width = 200;
+    view.height = 150;
+    view = SnapToPyramid(view);
+
+    Engine engine(EngineSettings{.max_iter = 200});
+    TileCache cache(64 * TileCache::TILE_BYTES);
+    IterationBuffer expected;
+    IterationBuffer buffer;
+    engine.Render(view, expected);
+
+    // 200 x 150 pixels at any offset touch 4 x 3 or more tiles
+    const auto cold = engine.RenderCached(view, buffer, cache);
+    const auto misses = cache.GetStats().misses;
+    CHECK_GE(misses, 12);
+    CHECK_EQ(cache.GetStats().hits, 0);
+    CHECK_EQ(cold.pixels, misses * PYRAMID_TILE_SIZE * PYRAMID_TILE_SIZE);
+    CHECK(std::ranges::equal(buffer.Values(), expected.Values()));
+
+    // The same view again is assembled from the cache
+    std::ranges::fill(buffer.Values(), 0.0F);
+    const auto warm = engine.RenderCached(view, buffer, cache);
+    CHECK_EQ(warm.pixels, 0);
+    CHECK_EQ(warm.iterations, 0);
+    CHECK_EQ(cache.GetStats().hits, misses);
+    CHECK(std::ranges::equal(buffer.Values(), expected.Values()));
+
+    // A panned view only renders the new tiles
+    view.center_x += 100 * view.PixelWidth();
+    engine.Render(view, expected);
+    const auto panned = engine.RenderCached(view, buffer, cache);
+    CHECK_LT(panned.pixels, cold.pixels);
+    CHECK(std::ranges::equal(buffer.Values(), expected.Values()));
+
+    // Options the formula ignores share the tiles
+    Engine julia_constant(EngineSettings{
+        .max_iter = 200, .fractal = FractalSettings{.julia_x = 0.3}});
+    const auto shared = julia_constant.RenderCached(view, buffer, cache);
+    CHECK_EQ(shared.pixels, 0);
+    CHECK(std::ranges::equal(buffer.Values(), expected.Values()));
+}
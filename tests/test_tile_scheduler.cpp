@@ -0,0 +1,58 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "doctest.h"
+
+#include "tile_scheduler.hpp"
+
+TEST_CASE("01 - TileScheduler::Run - every task runs exactly once") {
+    TileScheduler scheduler(4);
+    REQUIRE_EQ(scheduler.GetThreadCount(), 4);
+
+    // Run several times, the threads are reused between runs
+    for (std::size_t task_count : {0U, 1U, 3U, 1000U}) {
+        std::vector<std::atomic<int>> runs(task_count);
+        const auto stats =
+            scheduler.Run(task_count, [&](std::size_t task, std::size_t) {
+                runs[task].fetch_add(1);
+            });
+
+        for (const auto &count : runs) {
+            CHECK_EQ(count.load(), 1);
+        }
+
+        REQUIRE_EQ(stats.workers.size(), 4);
+        std::size_t tasks = 0;
+        for (const auto &worker : stats.workers) {
+            tasks += worker.tasks;
+        }
+        CHECK_EQ(tasks, task_count);
+    }
+}
+
+TEST_CASE("02 - TileScheduler::Run - idle workers steal uneven work") {
+    TileScheduler scheduler(4);
+
+    // All slow tasks are in the block of worker 0
+    constexpr std::size_t task_count = 64;
+    const auto stats =
+        scheduler.Run(task_count, [](std::size_t task, std::size_t) {
+            if (task < task_count / 4) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+        });
+
+    std::uint64_t steals = 0;
+    for (const auto &worker : stats.workers) {
+        steals += worker.steals;
+        CHECK_LE(worker.busy, stats.wall);
+        CHECK_LE(worker.busy + worker.idle, stats.wall);
+    }
+    CHECK_GT(steals, 0);
+    CHECK_GE(stats.Efficiency(), 0.0);
+    CHECK_LE(stats.Efficiency(), 1.0);
+}
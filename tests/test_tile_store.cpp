@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <vector>
+
+#include "doctest.h"
+
+#include "engine.hpp"
+#include "iteration_buffer.hpp"
+#include "mandelbrot_error.hpp"
+#include "tile_cache.hpp"
+#include "tile_store.hpp"
+#include "viewport.hpp"
+
+namespace {
+// Store file removed when the test ends
+struct TempStore {
+    std::filesystem::path path;
+
+    explicit TempStore(const char *name)
+        : path(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove(path);
+    }
+    TempStore(const TempStore &) = delete;
+    TempStore &operator=(const TempStore &) = delete;
+    TempStore(TempStore &&) = delete;
+    TempStore &operator=(TempStore &&) = delete;
+    ~TempStore() { std::filesystem::remove(path); }
+};
+
+// Key of a tile of the default fractal at level 0
+TileKey Key(std::int64_t tile_x) {
+    return {.level = 0,
+            .tile_x = tile_x,
+            .tile_y = -3,
+            .max_iter = 50,
+            .escape = 4.0,
+            .fractal = {},
+            .interior_check = true};
+}
+
+// Tile values counting up from the first one
+std::vector<float> TileValues(float first) {
+    std::vector<float> values(PYRAMID_TILE_SIZE * PYRAMID_TILE_SIZE);
+    std::iota(values.begin(), values.end(), first);
+    return values;
+}
+}  // namespace
+
+TEST_CASE("01 - TileStore::Open - tiles survive reopening") {
+    const TempStore temp("mandelbrot_test_store1.tiles");
+    {
+        auto store = TileStore::Open(temp.path, 16);
+        REQUIRE(store.has_value());
+        CHECK_EQ(store->GetCapacity(), 16);
+        store->Insert(Key(0), TileValues(0.0F));
+        store->Insert(Key(1), TileValues(1.0F));
+        store->Insert(Key(1), TileValues(2.0F));
+        CHECK_EQ(store->GetTileCount(), 2);
+        store->Flush();
+    }
+
+    // NOTE: The capacity of an existing store is kept
+    auto store = TileStore::Open(temp.path, 4);
+    REQUIRE(store.has_value());
+    CHECK_EQ(store->GetCapacity(), 16);
+    CHECK_EQ(store->GetTileCount(), 2);
+
+    const auto first = store->Find(Key(0));
+    const auto second = store->Find(Key(1));
+    REQUIRE(first.has_value());
+    REQUIRE(second.has_value());
+    CHECK(std::ranges::equal(*first, TileValues(0.0F)));
+    CHECK(std::ranges::equal(*second, TileValues(2.0F)));
+    CHECK_FALSE(store->Find(Key(2)).has_value());
+    CHECK_EQ(store->GetStats().hits, 2);
+    CHECK_EQ(store->GetStats().misses, 1);
+}
+
+TEST_CASE("02 - TileStore::Find - damaged tiles and files are rejected") {
+    const TempStore temp("mandelbrot_test_store2.tiles");
+    {
+        auto store = TileStore::Open(temp.path, 2);
+        REQUIRE(store.has_value());
+        store->Insert(Key(0), TileValues(0.0F));
+        store->Insert(Key(1), TileValues(0.0F));
+    }
+
+    // Flip a byte of the last tile
+    const auto size = std::filesystem::file_size(temp.path);
+    {
+        std::fstream file(temp.path, std::ios::in | std::ios::out |
+                                         std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(size - 1));
+        file.put('\x7f');
+    }
+    {
+        auto store = TileStore::Open(temp.path, 2);
+        REQUIRE(store.has_value());
+        const bool first = store->Find(Key(0)).has_value();
+        const bool second = store->Find(Key(1)).has_value();
+        CHECK_NE(first, second);
+        CHECK_EQ(store->GetStats().corrupted, 1);
+    }
+
+    // Damage the magic
+    {
+        std::fstream file(temp.path, std::ios::in | std::ios::out |
+                                         std::ios::binary);
+        file.put('X');
+    }
+    const auto store = TileStore::Open(temp.path, 2);
+    REQUIRE_FALSE(store.has_value());
+    CHECK_EQ(store.error().GetCode(), MandelbrotError::Code::StoreError);
+}
+
+TEST_CASE("03 - Engine::RenderCached - warm start from the store") {
+    const TempStore temp("mandelbrot_test_store3.tiles");
+    Viewport view;
+    view.width = 160;
+    view.height = 120;
+    view = SnapToPyramid(view);
+
+    IterationBuffer expected;
+    {
+        auto store = TileStore::Open(temp.path, 64);
+        REQUIRE(store.has_value());
+        Engine engine(EngineSettings{.max_iter = 200});
+        TileCache cache(0);
+        const auto stats = engine.RenderCached(view, expected, cache, &*store);
+        CHECK_GT(stats.pixels, 0);
+        CHECK_EQ(store->GetTileCount(), cache.GetStats().misses);
+    }
+
+    // A new engine and an empty cache render nothing
+    auto store = TileStore::Open(temp.path, 64);
+    REQUIRE(store.has_value());
+    Engine engine(EngineSettings{.max_iter = 200});
+    TileCache cache(0);
+    IterationBuffer buffer;
+    const auto stats = engine.RenderCached(view, buffer, cache, &*store);
+    CHECK_EQ(stats.pixels, 0);
+    CHECK_EQ(store->GetStats().misses, 0);
+    CHECK(std::ranges::equal(buffer.Values(), expected.Values()));
+}
+
+TEST_CASE("04 - TileStore::Insert - full stores replace tiles") {
+    const TempStore temp("mandelbrot_test_store4.tiles");
+    auto store = TileStore::Open(temp.path, 2);
+    REQUIRE(store.has_value());
+    store->Insert(Key(0), TileValues(0.0F));
+    store->Insert(Key(1), TileValues(1.0F));
+    CHECK_EQ(store->GetStats().evictions, 0);
+
+    // The new tile replaces one of the others
+    store->Insert(Key(2), TileValues(2.0F));
+    CHECK_EQ(store->GetTileCount(), 2);
+    CHECK_EQ(store->GetStats().evictions, 1);
+    const auto added = store->Find(Key(2));
+    REQUIRE(added.has_value());
+    CHECK(std::ranges::equal(*added, TileValues(2.0F)));
+    const bool first = store->Find(Key(0)).has_value();
+    const bool second = store->Find(Key(1)).has_value();
+    CHECK_NE(first, second);
+}